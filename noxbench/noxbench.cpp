@@ -0,0 +1,769 @@
+/*
+ * Headless simulation benchmark. Builds a planet and its starting region from a fixed seed, stocks the region
+ * with extra settlers, wildlife and items, then runs the systems for a number of major ticks with the game's RNG
+ * reseeded, and reports per-system timing percentiles as JSON. Optionally times a number of vegetation days on
+ * their own afterwards: bare surface is planted with the region's commonest plant first, and the same days are
+ * grown again by the full-region sweep the time wheel replaced, from the same starting state, for comparison.
+ *
+ * Usage: noxbench <game def path> [--seed n] [--ticks n] [--settlers n] [--wildlife n] [--items n] [--days n] [--out file]
+ *        noxbench <game def path> --replay <journal> [--out file]
+ *        noxbench <game def path> --check gravity [--seed n]
+ *        noxbench <game def path> --fov <viewpoints> [--seed n] [--out file]
+ *        noxbench <game def path> --worldgen <runs> [--seed n] [--settlers n] [--out file]
+ *
+ * The game def path is the folder holding world_defs/ and rex/, as given to nf::set_game_def_path. The world is
+ * written to the usual save location, like a new game.
+ *
+ * With --replay, a session recorded with nf::start_recording is played back instead, from the save in the usual
+ * location (which has to be the one the recording started from), and the report says whether the world hashes
+ * recorded along the way came out the same.
+ *
+ * --check runs a behaviour check on the freshly built world instead of the benchmark, and exits non-zero if it
+ * fails. "gravity" mines out the only column under an overhang and expects the overhang to fall.
+ *
+ * --fov times bengine::fov_3d against the ray-per-perimeter viewshed it replaced, at radius 8, 16 and 24, from the
+ * same viewpoints in a synthetic map generated from the seed. No world is built for it.
+ *
+ * --worldgen times build_planet on its own, a number of times with scalar noise on the calling thread and then the
+ * same number with batched noise on the worker pool, and checks that both built the same planet.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "../src/libnox.h"
+#include "../src/libnox-replay.hpp"
+#include "../src/noxconsts.h"
+#include "../src/noxtypes.h"
+#include "../src/planet/planet_builder.hpp"
+#include "../src/planet/region/region.hpp"
+#include "../src/global_assets/rng.hpp"
+#include "../src/global_assets/game_planet.hpp"
+#include "../src/global_assets/farming_designations.hpp"
+#include "../src/utils/thread_pool.hpp"
+#include "../src/bengine/fov.hpp"
+#include "../src/bengine/geometry.hpp"
+#include "../src/global_assets/game_pause.hpp"
+#include "../src/raws/raws.hpp"
+#include "../src/raws/materials.hpp"
+#include "../src/raws/plants.hpp"
+#include "../src/raws/defs/plant_t.hpp"
+#include "../src/planet/region/region_chunking.hpp"
+#include "../src/systems/run_systems.hpp"
+#include "../src/systems/ai/wildlife_population.hpp"
+#include "../src/systems/physics/vegetation_system.hpp"
+#include "../src/systems/physics/gravity_system.hpp"
+
+namespace {
+
+	struct options_t {
+		std::string game_def_path;
+		int seed = 12345;
+		int ticks = 1000;
+		int settlers = 10;
+		int wildlife = 50;
+		int items = 200;
+		int days = 0;
+		std::string replay;
+		std::string check;
+		int fov_viewpoints = 0;
+		int worldgen_runs = 0;
+		std::string out = "-";
+	};
+
+	// Every call to run_systems with this long a frame is a major tick
+	constexpr double MS_PER_CALL = 34.0;
+
+	using clock_type = std::chrono::steady_clock;
+
+	double ms_since(const clock_type::time_point &start) {
+		return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+	}
+
+	bool parse_options(int argc, char * argv[], options_t &options) {
+		if (argc < 2) return false;
+		options.game_def_path = argv[1];
+		for (int i = 2; i < argc; ++i) {
+			const std::string arg(argv[i]);
+			if (i + 1 >= argc) return false;
+			const std::string value(argv[++i]);
+			if (arg == "--seed") options.seed = std::atoi(value.c_str());
+			else if (arg == "--ticks") options.ticks = std::max(1, std::atoi(value.c_str()));
+			else if (arg == "--settlers") options.settlers = std::max(1, std::atoi(value.c_str()));
+			else if (arg == "--wildlife") options.wildlife = std::max(0, std::atoi(value.c_str()));
+			else if (arg == "--items") options.items = std::max(0, std::atoi(value.c_str()));
+			else if (arg == "--days") options.days = std::max(0, std::atoi(value.c_str()));
+			else if (arg == "--replay") options.replay = value;
+			else if (arg == "--check") options.check = value;
+			else if (arg == "--worldgen") options.worldgen_runs = std::max(0, std::atoi(value.c_str()));
+			else if (arg == "--fov") options.fov_viewpoints = std::max(0, std::atoi(value.c_str()));
+			else if (arg == "--out") options.out = value;
+			else return false;
+		}
+		return true;
+	}
+
+	/* A random dry surface tile away from the map edge, using the game's RNG so placement follows the seed. */
+	bool random_surface_tile(int &x, int &y, int &z) {
+		using namespace nf;
+		for (int tries = 0; tries < 100; ++tries) {
+			x = rng.roll_dice(1, REGION_WIDTH - 4) + 1;
+			y = rng.roll_dice(1, REGION_HEIGHT - 4) + 1;
+			z = region::ground_z(x, y);
+			if (z > 0 && z < REGION_DEPTH - 1 && region::water_level(mapidx(x, y, z)) == 0) return true;
+		}
+		return false;
+	}
+
+	/*
+	 * Builds a pillar with a ledge off its top in open air and lets the full support solve see it. Then mines the
+	 * pillar's base out the way channelling does, leaving the local solver to work out that nothing holds the rest up.
+	 */
+	bool check_overhang_collapse() {
+		using namespace nf;
+		constexpr int LEDGE = 3;
+		constexpr int HEIGHT = 4;
+
+		const auto is_open = [](const int x, const int y, const int z) {
+			return region::tile_type(mapidx(x, y, z)) == tile_type::OPEN_SPACE;
+		};
+
+		// A site with nothing solid anywhere near the pillar or the ledge
+		int x = 0, y = 0, z = 0;
+		auto found = false;
+		for (int tries = 0; tries < 1000 && !found; ++tries) {
+			if (!random_surface_tile(x, y, z)) continue;
+			if (x + LEDGE + 1 >= REGION_WIDTH - 1 || y < 2 || y > REGION_HEIGHT - 3 || z + HEIGHT >= REGION_DEPTH - 1) continue;
+			found = true;
+			for (int cz = z; cz <= z + HEIGHT && found; ++cz) {
+				for (int cy = y - 1; cy <= y + 1 && found; ++cy) {
+					for (int cx = x - 1; cx <= x + LEDGE + 1 && found; ++cx) {
+						if (!is_open(cx, cy, cz)) found = false;
+					}
+				}
+			}
+		}
+		if (!found) {
+			std::cerr << "No open site for the overhang\n";
+			return false;
+		}
+
+		const auto wood = get_material_by_tag("wood");
+		const auto top = z + HEIGHT - 1;
+		for (int cz = z; cz <= top; ++cz) region::make_wall(mapidx(x, y, cz), wood);
+		for (int cx = x + 1; cx <= x + LEDGE; ++cx) region::make_wall(mapidx(cx, y, top), wood);
+		region::recalc_box(x, y, z, x + LEDGE, y, top);
+
+		systems::gravity::tile_was_removed();
+		systems::gravity::run(MS_PER_CALL);
+		for (int cx = x; cx <= x + LEDGE; ++cx) {
+			if (is_open(cx, y, top)) {
+				std::cerr << "The overhang fell while the pillar was still standing\n";
+				return false;
+			}
+		}
+
+		const auto base = mapidx(x, y, z);
+		region::make_open_space(base);
+		region::recalc_box(x, y, z, x, y, z);
+		systems::gravity::tile_was_removed(base);
+		systems::gravity::run(MS_PER_CALL);
+
+		auto collapsed = true;
+		for (int cz = z + 1; cz <= top; ++cz) if (!is_open(x, y, cz)) collapsed = false;
+		for (int cx = x + 1; cx <= x + LEDGE; ++cx) if (!is_open(cx, y, top)) collapsed = false;
+		if (!collapsed) std::cerr << "The overhang is still standing with nothing under it\n";
+		return collapsed;
+	}
+
+	/*
+	 * FOV comparison. The map is a cube of rock pillars and scattered boulders, so rays are blocked often enough
+	 * for opacity to matter.
+	 */
+	constexpr int FOV_MAP = 96;
+
+	struct fov_map_t {
+		std::vector<uint8_t> opaque;
+
+		explicit fov_map_t(const int seed) : opaque(FOV_MAP * FOV_MAP * FOV_MAP, 0) {
+			bengine::random_number_generator map_rng(seed);
+			for (int y = 0; y < FOV_MAP; ++y) {
+				for (int x = 0; x < FOV_MAP; ++x) {
+					const auto pillar = map_rng.roll_dice(1, 100) <= 4;
+					for (int z = 0; z < FOV_MAP; ++z) {
+						if (pillar || map_rng.roll_dice(1, 100) <= 3) opaque[idx(x, y, z)] = 1;
+					}
+				}
+			}
+		}
+
+		static inline int idx(const int x, const int y, const int z) noexcept {
+			return (z * FOV_MAP * FOV_MAP) + (y * FOV_MAP) + x;
+		}
+
+		inline bool in_bounds(const int x, const int y, const int z) const noexcept {
+			return x > 0 && x < FOV_MAP - 1 && y > 0 && y < FOV_MAP - 1 && z > 0 && z < FOV_MAP - 1;
+		}
+
+		inline bool is_opaque(const int x, const int y, const int z) const noexcept {
+			return opaque[idx(x, y, z)] != 0;
+		}
+	};
+
+	// The viewshed as it was before fov_3d: a float-stepped ray to every cell on the faces of a (2r)^3 cube
+	void perimeter_fov(const fov_map_t &map, const int px, const int py, const int pz, const int radius, std::unordered_set<int> &visible) {
+		visible.clear();
+		visible.insert(fov_map_t::idx(px, py, pz));
+		const float dist_square = static_cast<float>(radius * radius);
+
+		const auto view_to = [&](const int x, const int y, const int z) {
+			auto blocked = false;
+			bengine::line_func_3d(px, py, pz, px + x, py + y, pz + z, [&](const int at_x, const int at_y, const int at_z) {
+				if (!map.in_bounds(at_x, at_y, at_z)) return;
+				if (bengine::distance3d_squared(px, py, pz, at_x, at_y, at_z) < dist_square) {
+					if (!blocked) visible.insert(fov_map_t::idx(at_x, at_y, at_z));
+					if (map.is_opaque(at_x, at_y, at_z)) blocked = true;
+				}
+			});
+		};
+
+		for (int z = -radius; z < radius; ++z) {
+			for (int i = -radius; i < radius; ++i) {
+				view_to(i, radius, z);
+				view_to(i, -radius, z);
+				view_to(radius, i, z);
+				view_to(-radius, i, z);
+			}
+		}
+	}
+
+	struct fov_result_t {
+		int radius = 0;
+		double perimeter_ms = 0.0;	// Mean per viewshed
+		double fan_ms = 0.0;
+		double perimeter_tiles = 0.0;	// Mean tiles seen, as a sanity check that both see about the same
+		double fan_tiles = 0.0;
+	};
+
+	std::vector<fov_result_t> compare_fov(const int seed, const int n_viewpoints) {
+		const fov_map_t map(seed);
+
+		// Open viewpoints, far enough from the edge for the largest radius to matter
+		bengine::random_number_generator point_rng(seed + 1);
+		std::vector<std::array<int, 3>> viewpoints;
+		while (static_cast<int>(viewpoints.size()) < n_viewpoints) {
+			const auto x = point_rng.roll_dice(1, FOV_MAP - 2);
+			const auto y = point_rng.roll_dice(1, FOV_MAP - 2);
+			const auto z = point_rng.roll_dice(1, FOV_MAP - 2);
+			if (!map.is_opaque(x, y, z)) viewpoints.push_back({ x, y, z });
+		}
+
+		std::vector<fov_result_t> results;
+		std::unordered_set<int> old_visible;
+		bengine::fov_bitset_t new_visible;
+		const auto in_bounds = [&map](const int x, const int y, const int z) { return map.in_bounds(x, y, z); };
+		const auto is_opaque = [&map](const int x, const int y, const int z) { return map.is_opaque(x, y, z); };
+
+		for (const auto radius : { 8, 16, 24 }) {
+			fov_result_t result;
+			result.radius = radius;
+			bengine::fov_octant_table(radius); // Built once per radius in the game too; not part of the timing
+
+			auto start = clock_type::now();
+			for (const auto &p : viewpoints) {
+				perimeter_fov(map, p[0], p[1], p[2], radius, old_visible);
+				result.perimeter_tiles += static_cast<double>(old_visible.size());
+			}
+			result.perimeter_ms = ms_since(start) / static_cast<double>(viewpoints.size());
+
+			start = clock_type::now();
+			for (const auto &p : viewpoints) {
+				bengine::fov_3d(p[0], p[1], p[2], radius, false, new_visible, in_bounds, is_opaque);
+				result.fan_tiles += static_cast<double>(new_visible.count);
+			}
+			result.fan_ms = ms_since(start) / static_cast<double>(viewpoints.size());
+
+			result.perimeter_tiles /= static_cast<double>(viewpoints.size());
+			result.fan_tiles /= static_cast<double>(viewpoints.size());
+			results.emplace_back(result);
+		}
+		return results;
+	}
+
+	/*
+	 * Vegetation comparison. Carpets every dry, bare surface tile with the region's commonest plant (part way through
+	 * its first stage, so transitions are spread out) and returns how many were planted.
+	 */
+	int plant_grassland(bengine::random_number_generator &dice) {
+		using namespace nf;
+		std::map<std::size_t, int> species;
+		for (int y = 0; y < REGION_HEIGHT; ++y) {
+			for (int x = 0; x < REGION_WIDTH; ++x) {
+				const auto type = region::veg_type(mapidx(x, y, region::ground_z(x, y)));
+				if (type > 0) ++species[type];
+			}
+		}
+		const auto commonest = std::max_element(species.begin(), species.end(), [](const std::pair<const std::size_t, int> &a, const std::pair<const std::size_t, int> &b) {
+			return a.second < b.second;
+		});
+		const auto grass = commonest == species.end() ? get_plant_idx("grass") : commonest->first;
+		const auto def = get_plant_def(grass);
+		if (grass == 0 || !def || def->lifecycle.empty()) return 0;
+
+		auto planted = 0;
+		for (int y = 1; y < REGION_HEIGHT - 1; ++y) {
+			for (int x = 1; x < REGION_WIDTH - 1; ++x) {
+				const auto idx = mapidx(x, y, region::ground_z(x, y));
+				if (region::water_level(idx) > 0 || region::veg_type(idx) > 0) continue;
+				region::set_veg_type(idx, static_cast<uint8_t>(grass));
+				region::set_veg_hp(idx, 10);
+				region::set_veg_lifecycle(idx, 0);
+				region::set_veg_ticker(idx, static_cast<uint16_t>(dice.roll_dice(1, std::max(1, def->lifecycle[0]))));
+				++planted;
+			}
+		}
+		return planted;
+	}
+
+	/* Share of map columns whose surface tile has a plant on it. */
+	double surface_coverage() {
+		using namespace nf;
+		auto covered = 0;
+		for (int y = 0; y < REGION_HEIGHT; ++y) {
+			for (int x = 0; x < REGION_WIDTH; ++x) {
+				if (region::veg_type(mapidx(x, y, region::ground_z(x, y))) > 0) ++covered;
+			}
+		}
+		return static_cast<double>(covered) / static_cast<double>(REGION_WIDTH * REGION_HEIGHT);
+	}
+
+	struct vegetation_state_t {
+		std::vector<uint8_t> type;
+		std::vector<uint16_t> ticker;
+		std::vector<uint8_t> lifecycle;
+	};
+
+	vegetation_state_t save_vegetation() {
+		vegetation_state_t state;
+		state.type.resize(nf::REGION_TILES_COUNT);
+		state.ticker.resize(nf::REGION_TILES_COUNT);
+		state.lifecycle.resize(nf::REGION_TILES_COUNT);
+		for (int idx = 0; idx < nf::REGION_TILES_COUNT; ++idx) {
+			state.type[idx] = static_cast<uint8_t>(region::veg_type(idx));
+			state.ticker[idx] = region::veg_ticker(idx);
+			state.lifecycle[idx] = region::veg_lifecycle(idx);
+		}
+		return state;
+	}
+
+	void restore_vegetation(const vegetation_state_t &state) {
+		for (int idx = 0; idx < nf::REGION_TILES_COUNT; ++idx) {
+			if (region::veg_type(idx) != state.type[idx]) region::set_veg_type(idx, state.type[idx]);
+			if (region::veg_ticker(idx) != state.ticker[idx]) region::set_veg_ticker(idx, state.ticker[idx]);
+			if (region::veg_lifecycle(idx) != state.lifecycle[idx]) region::set_veg_lifecycle(idx, state.lifecycle[idx]);
+		}
+	}
+
+	uint64_t vegetation_hash() {
+		uint64_t hash = 14695981039346656037ULL;
+		const auto mix = [&hash](const uint64_t value) { hash = (hash ^ value) * 1099511628211ULL; };
+		for (int idx = 0; idx < nf::REGION_TILES_COUNT; ++idx) {
+			mix(region::veg_type(idx));
+			mix(region::veg_ticker(idx));
+			mix(region::veg_lifecycle(idx));
+		}
+		return hash;
+	}
+
+	/* One day of vegetation growth as it was done before the time wheel: every tile in the region, every day. */
+	void sweep_vegetation_day() {
+		using namespace nf;
+		using namespace tile_flags;
+		region::update_outdoor_calculation();
+		for (int z = 0; z < REGION_DEPTH - 1; ++z) {
+			for (int y = 0; y < REGION_HEIGHT - 1; ++y) {
+				for (int x = 0; x < REGION_WIDTH - 1; ++x) {
+					const int idx = mapidx(x, y, z);
+
+					auto farm = farm_designations->farms.find(idx);
+
+					int tick_increase = 1;
+					if (farm != farm_designations->farms.end()) {
+						if (farm->second.fertilized) tick_increase = 2;
+						++farm->second.days_since_watered;
+						++farm->second.days_since_weeded;
+					}
+
+					if (region::veg_type(idx) == 0) continue;
+					uint16_t current_tick = region::veg_ticker(idx) + tick_increase;
+					uint8_t current_cycle = region::veg_lifecycle(idx);
+					auto plant = get_plant_def(region::veg_type(idx));
+					if (!plant) continue;
+
+					if (plant->requires_light && !region::flag(idx, ABOVE_GROUND)) {
+						if (region::veg_ticker(idx) > 0) {
+							current_tick = region::veg_ticker(idx) - 1;
+						}
+						else {
+							region::set_veg_type(idx, 0);
+							continue;
+						}
+					}
+					if (plant->lifecycle.empty()) continue;
+
+					int return_val = plant->lifecycle[4];
+					if (return_val > 3 || return_val < 0) return_val = 0;
+
+					if (current_tick > plant->lifecycle[current_cycle]) {
+						++current_cycle;
+						current_tick = 0;
+						if (current_cycle > 3) current_cycle = return_val;
+
+						if (farm != farm_designations->farms.end() && plant->provides[region::veg_lifecycle(idx)] != "none") {
+							farm_designations->harvest.push_back(std::make_pair(false, position_t{ x, y, z }));
+						}
+
+						region::calc_render(idx);
+						region::mark_chunk_dirty_by_tileidx(idx);
+					}
+
+					if (farm != farm_designations->farms.end()) {
+						if (current_cycle > 0 && farm->second.days_since_watered > 4 && rng.roll_dice(1, 50) <= farm->second.days_since_watered) {
+							--current_cycle;
+							region::calc_render(idx);
+							region::mark_chunk_dirty_by_tileidx(idx);
+						}
+						if (current_cycle > 0 && farm->second.days_since_weeded > 4 && rng.roll_dice(1, 50) <= farm->second.days_since_weeded) {
+							--current_cycle;
+							region::calc_render(idx);
+							region::mark_chunk_dirty_by_tileidx(idx);
+						}
+					}
+
+					region::set_veg_ticker(idx, current_tick);
+					region::set_veg_lifecycle(idx, current_cycle);
+				}
+			}
+		}
+	}
+
+	/* FNV-1a over the landblocks, so the two worldgen noise paths can be shown to build the same planet. */
+	uint64_t planet_hash() {
+		uint64_t hash = 14695981039346656037ULL;
+		for (const auto &block : planet.landblocks) {
+			for (const auto byte : { block.height, block.variance, block.type, static_cast<uint8_t>(block.temperature_c), static_cast<uint8_t>(block.rainfall) }) {
+				hash = (hash ^ byte) * 1099511628211ULL;
+			}
+		}
+		return hash;
+	}
+
+	struct summary_t {
+		std::size_t count = 0;
+		double total = 0.0;
+		double mean = 0.0;
+		double p50 = 0.0;
+		double p90 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	// Nearest-rank percentiles
+	summary_t summarize(std::vector<double> samples) {
+		summary_t result;
+		if (samples.empty()) return result;
+		std::sort(samples.begin(), samples.end());
+		auto rank = [&samples](const double p) {
+			const auto n = static_cast<std::size_t>(p * static_cast<double>(samples.size()) + 0.999999);
+			return samples[std::min(samples.size(), std::max<std::size_t>(n, 1)) - 1];
+		};
+		result.count = samples.size();
+		for (const auto &s : samples) result.total += s;
+		result.mean = result.total / static_cast<double>(samples.size());
+		result.p50 = rank(0.50);
+		result.p90 = rank(0.90);
+		result.p99 = rank(0.99);
+		result.max = samples.back();
+		return result;
+	}
+
+	void write_summary(std::ostream &out, const summary_t &s) {
+		out << "\"count\": " << s.count << ", \"total_ms\": " << s.total << ", \"mean_ms\": " << s.mean
+			<< ", \"p50_ms\": " << s.p50 << ", \"p90_ms\": " << s.p90 << ", \"p99_ms\": " << s.p99 << ", \"max_ms\": " << s.max;
+	}
+}
+
+int main(int argc, char * argv[]) {
+	options_t options;
+	if (!parse_options(argc, argv, options)) {
+		std::cerr << "Usage: noxbench <game def path> [--seed n] [--ticks n] [--settlers n] [--wildlife n] [--items n] [--days n] [--out file]\n";
+		std::cerr << "       noxbench <game def path> --replay <journal> [--out file]\n";
+		std::cerr << "       noxbench <game def path> --check gravity [--seed n]\n";
+		std::cerr << "       noxbench <game def path> --fov <viewpoints> [--seed n] [--out file]\n";
+		std::cerr << "       noxbench <game def path> --worldgen <runs> [--seed n] [--settlers n] [--out file]\n";
+		return 1;
+	}
+
+	if (options.fov_viewpoints > 0) {
+		std::cerr << "Comparing viewsheds from " << options.fov_viewpoints << " viewpoints\n";
+		const auto results = compare_fov(options.seed, options.fov_viewpoints);
+
+		std::ofstream out_file;
+		if (options.out != "-") out_file.open(options.out);
+		std::ostream &out = options.out != "-" ? out_file : std::cout;
+		out << std::fixed << std::setprecision(4);
+		out << "{\n  \"seed\": " << options.seed << ",\n  \"viewpoints\": " << options.fov_viewpoints << ",\n  \"fov\": [\n";
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			const auto &r = results[i];
+			out << "    { \"radius\": " << r.radius << ", \"perimeter_ms\": " << r.perimeter_ms << ", \"fan_ms\": " << r.fan_ms
+				<< ", \"speedup\": " << (r.fan_ms > 0.0 ? r.perimeter_ms / r.fan_ms : 0.0)
+				<< ", \"perimeter_tiles\": " << r.perimeter_tiles << ", \"fan_tiles\": " << r.fan_tiles << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		out << "  ]\n}\n";
+		return 0;
+	}
+
+	// World setup
+	const auto setup_start = clock_type::now();
+	std::cerr << "Loading raws\n";
+	nf::set_game_def_path(options.game_def_path.c_str());
+	nf::setup_raws();
+
+	if (options.worldgen_runs > 0) {
+		struct noise_mode_t {
+			const char * name;
+			bool batched;
+			std::vector<double> samples;
+			uint64_t hash;
+		};
+		std::vector<noise_mode_t> modes{ { "scalar", false, {}, 0 }, { "batched", true, {}, 0 } };
+		for (auto &mode : modes) {
+			std::cerr << "Building the world " << options.worldgen_runs << " times with " << mode.name << " noise\n";
+			worldgen_batched_noise = mode.batched;
+			for (int run = 0; run < options.worldgen_runs; ++run) {
+				setup_build_planet();
+				const auto build_start = clock_type::now();
+				build_planet(options.seed, 3, 3, options.settlers, false, false);
+				mode.samples.emplace_back(ms_since(build_start));
+			}
+			mode.hash = planet_hash();
+		}
+		worldgen_batched_noise = true;
+
+		const auto scalar = summarize(modes[0].samples);
+		const auto batched = summarize(modes[1].samples);
+		const auto identical = modes[0].hash == modes[1].hash;
+
+		std::ofstream out_file;
+		if (options.out != "-") out_file.open(options.out);
+		std::ostream &out = options.out != "-" ? out_file : std::cout;
+		out << std::fixed << std::setprecision(4);
+		out << "{\n  \"seed\": " << options.seed << ",\n  \"runs\": " << options.worldgen_runs << ",\n  \"threads\": " << (worker_pool().size() + 1) << ",\n";
+		out << "  \"build_planet\": [\n";
+		for (std::size_t i = 0; i < modes.size(); ++i) {
+			out << "    { \"noise\": \"" << modes[i].name << "\", ";
+			write_summary(out, summarize(modes[i].samples));
+			out << ", \"planet_hash\": \"" << std::hex << modes[i].hash << std::dec << "\" }" << (i + 1 < modes.size() ? "," : "") << "\n";
+		}
+		out << "  ],\n  \"speedup\": " << (batched.mean > 0.0 ? scalar.mean / batched.mean : 0.0) << ",\n";
+		out << "  \"identical\": " << (identical ? "true" : "false") << "\n}\n";
+
+		// Batching is only allowed to change how long it takes
+		return identical ? 0 : 2;
+	}
+
+	int spawned_wildlife = 0;
+	int spawned_items = 0;
+	if (options.replay.empty()) {
+		std::cerr << "Building the world from seed " << options.seed << "\n";
+		setup_build_planet();
+		build_planet(options.seed, 3, 3, options.settlers, false, false);
+		nf::load_game();
+
+		// From here on, everything the simulation rolls follows the seed
+		rng = bengine::random_number_generator(options.seed);
+
+		std::cerr << "Adding " << options.wildlife << " critters and " << options.items << " items\n";
+		for (int i = 0; i < options.wildlife; ++i) {
+			int x, y, z;
+			if (!random_surface_tile(x, y, z)) continue;
+			systems::wildlife_population::spawn_critter_at(x, y, z, static_cast<uint8_t>(i % 4));
+			++spawned_wildlife;
+		}
+		const auto wood = get_material_by_tag("wood");
+		for (int i = 0; i < options.items; ++i) {
+			int x, y, z;
+			if (!random_surface_tile(x, y, z)) continue;
+			spawn_item_on_ground(x, y, z, "wood_log", wood, 3, 100, 0, "Benchmark");
+			++spawned_items;
+		}
+	}
+	else {
+		std::cerr << "Loading the game and " << options.replay << "\n";
+		if (!replay::open(options.replay)) {
+			std::cerr << "Can't replay " << options.replay << "\n";
+			return 1;
+		}
+		if (!replay::result().start_matched) std::cerr << "The save isn't the one this session was recorded from\n";
+	}
+	const auto setup_ms = ms_since(setup_start);
+
+	if (options.check == "gravity") {
+		const auto passed = check_overhang_collapse();
+		std::cerr << "gravity: " << (passed ? "pass" : "FAIL") << "\n";
+		return passed ? 0 : 3;
+	}
+	if (!options.check.empty()) {
+		std::cerr << "Unknown check " << options.check << "\n";
+		return 1;
+	}
+
+	// The simulation itself
+	std::vector<double> tick_samples;
+	std::vector<std::string> system_order;
+	std::map<std::string, std::vector<double>> system_samples;
+	auto collect_timings = [&system_order, &system_samples]() {
+		for (const auto &timing : systems::last_tick_timings()) {
+			auto &samples = system_samples[timing.name];
+			if (samples.empty()) system_order.emplace_back(timing.name);
+			samples.emplace_back(timing.ms);
+		}
+	};
+
+	const auto run_start = clock_type::now();
+	if (options.replay.empty()) {
+		std::cerr << "Running " << options.ticks << " ticks\n";
+		pause_mode = RUNNING;
+		tick_samples.reserve(options.ticks);
+		for (int tick = 0; tick < options.ticks; ++tick) {
+			const auto tick_start = clock_type::now();
+			systems::run_systems(MS_PER_CALL);
+			tick_samples.emplace_back(ms_since(tick_start));
+			collect_timings();
+		}
+	}
+	else {
+		std::cerr << "Replaying\n";
+		for (;;) {
+			// Checkpoint hashing isn't part of the tick
+			const auto before = replay::result();
+			if (!replay::step()) break;
+			if (replay::result().ticks == before.ticks) continue;
+			tick_samples.emplace_back(replay::result().run_ms - before.run_ms);
+			collect_timings();
+		}
+		options.ticks = replay::result().ticks;
+	}
+	const auto run_ms = ms_since(run_start);
+
+	// Vegetation growth runs once a game day; time a batch of days directly, then the same days with the old sweep
+	std::vector<double> day_samples;
+	std::vector<double> sweep_samples;
+	auto planted = 0;
+	auto coverage = 0.0;
+	auto days_identical = true;
+	if (options.days > 0) {
+		bengine::random_number_generator dice(options.seed);
+		planted = plant_grassland(dice);
+		coverage = surface_coverage();
+		const auto start_state = save_vegetation();
+		const auto farms = farm_designations->farms;
+		const auto harvest = farm_designations->harvest;
+
+		// Let the system pick up the new plants before the clock starts
+		day_elapsed = false;
+		systems::vegetation::run(MS_PER_CALL);
+
+		std::cerr << "Growing vegetation for " << options.days << " days (" << planted << " plants added)\n";
+		rng = bengine::random_number_generator(options.seed);
+		day_elapsed = true;
+		for (int day = 0; day < options.days; ++day) {
+			const auto day_start = clock_type::now();
+			systems::vegetation::run(MS_PER_CALL);
+			day_samples.emplace_back(ms_since(day_start));
+		}
+		systems::vegetation::sync_tickers();
+		const auto wheel_hash = vegetation_hash();
+
+		std::cerr << "Growing the same days with the full-region sweep\n";
+		restore_vegetation(start_state);
+		farm_designations->farms = farms;
+		farm_designations->harvest = harvest;
+		rng = bengine::random_number_generator(options.seed);
+		for (int day = 0; day < options.days; ++day) {
+			const auto day_start = clock_type::now();
+			sweep_vegetation_day();
+			sweep_samples.emplace_back(ms_since(day_start));
+		}
+		day_elapsed = false;
+		days_identical = vegetation_hash() == wheel_hash;
+	}
+
+	// Report
+	std::ofstream out_file;
+	if (options.out != "-") out_file.open(options.out);
+	std::ostream &out = options.out != "-" ? out_file : std::cout;
+	out << std::fixed << std::setprecision(4);
+	out << "{\n";
+	out << "  \"seed\": " << options.seed << ",\n";
+	out << "  \"ticks\": " << options.ticks << ",\n";
+	out << "  \"settlers\": " << options.settlers << ",\n";
+	out << "  \"wildlife\": " << spawned_wildlife << ",\n";
+	out << "  \"items\": " << spawned_items << ",\n";
+	out << "  \"setup_ms\": " << setup_ms << ",\n";
+	out << "  \"run_ms\": " << run_ms << ",\n";
+	out << "  \"ticks_per_second\": " << (run_ms > 0.0 ? options.ticks * 1000.0 / run_ms : 0.0) << ",\n";
+	out << "  \"tick\": { ";
+	write_summary(out, summarize(tick_samples));
+	out << " },\n";
+	out << "  \"systems\": [\n";
+	for (std::size_t i = 0; i < system_order.size(); ++i) {
+		out << "    { \"name\": \"" << system_order[i] << "\", ";
+		write_summary(out, summarize(system_samples[system_order[i]]));
+		out << " }" << (i + 1 < system_order.size() ? "," : "") << "\n";
+	}
+	out << "  ],\n";
+
+	// The profiler also sees path searches, chunk meshing and the saving and loading done during setup
+	size_t n_profiled = 0;
+	nf::profile_entry_t * profiled = nullptr;
+	nf::get_profile_stats(n_profiled, profiled);
+	out << "  \"profile\": [\n";
+	for (size_t i = 0; i < n_profiled; ++i) {
+		const auto &p = profiled[i];
+		out << "    { \"name\": \"" << p.name << "\", \"calls\": " << p.calls << ", \"mean_ms\": " << p.mean_ms << ", \"p50_ms\": " << p.p50_ms
+			<< ", \"p95_ms\": " << p.p95_ms << ", \"p99_ms\": " << p.p99_ms << ", \"max_ms\": " << p.max_ms << " }" << (i + 1 < n_profiled ? "," : "") << "\n";
+	}
+	out << "  ],\n";
+	out << "  \"vegetation_day\": { ";
+	write_summary(out, summarize(day_samples));
+	out << " },\n";
+	out << "  \"vegetation_sweep_day\": { ";
+	write_summary(out, summarize(sweep_samples));
+	out << " },\n";
+	const auto wheel_day = summarize(day_samples);
+	const auto sweep_day = summarize(sweep_samples);
+	out << "  \"vegetation\": { \"planted\": " << planted << ", \"surface_coverage\": " << coverage
+		<< ", \"speedup\": " << (wheel_day.mean > 0.0 ? sweep_day.mean / wheel_day.mean : 0.0)
+		<< ", \"identical\": " << (days_identical ? "true" : "false") << " }";
+
+	auto diverged = false;
+	if (!options.replay.empty()) {
+		const auto &replayed = replay::result();
+		diverged = !replayed.start_matched || replayed.mismatches > 0;
+		out << ",\n  \"replay\": { \"journal\": \"" << options.replay << "\", \"start_matched\": " << (replayed.start_matched ? "true" : "false")
+			<< ", \"calls\": " << replayed.calls << ", \"checkpoints\": " << replayed.checkpoints << ", \"mismatches\": " << replayed.mismatches
+			<< ", \"first_mismatch_tick\": " << replayed.first_mismatch_tick << " }";
+		replay::close();
+	}
+	out << "\n}\n";
+
+	// A replay that went somewhere else, or a sweep that grew different plants, fails, so scripts can catch changed outcomes
+	return (diverged || !days_identical) ? 2 : 0;
+}
@@ -31,6 +31,11 @@
 #include <assert.h>
 #include <random>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FN_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 const float GRAD_X[] =
 {
 	1, -1, 1, -1,
@@ -862,6 +867,129 @@ float FastNoise::SingleGradientFractalFBM(float x, float y)
 	return sum * m_fractalBounding;
 }
 
+void FastNoise::GetNoiseSet(const float* x, const float* y, float* out, int count)
+{
+	if (m_noiseType == GradientFractal && m_fractalType == FBM)
+	{
+		SingleGradientFractalFBMSet(x, y, out, count);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+		out[i] = GetNoise(x[i], y[i]);
+}
+
+void FastNoise::GetNoiseRow(const float* x, float y, float* out, int count)
+{
+	const int BATCH = 64;
+	float ys[BATCH];
+	for (int i = 0; i < BATCH; i++)
+		ys[i] = y;
+
+	for (int i = 0; i < count; i += BATCH)
+	{
+		const int n = (count - i < BATCH) ? count - i : BATCH;
+		GetNoiseSet(x + i, ys, out + i, n);
+	}
+}
+
+void FastNoise::SingleGradientFractalFBMSet(const float* x, const float* y, float* out, int count)
+{
+	int i = 0;
+
+#ifdef FN_USE_SSE2
+	// Four points per pass. The permutation lookups are done per lane; the arithmetic is vectorized and
+	// performed in the same order as SingleGradient, so results match the scalar path exactly.
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 frequency = _mm_set1_ps(m_frequency);
+	const __m128 lacunarity = _mm_set1_ps(m_lacunarity);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 px = _mm_mul_ps(_mm_loadu_ps(x + i), frequency);
+		__m128 py = _mm_mul_ps(_mm_loadu_ps(y + i), frequency);
+		__m128 sum = zero;
+		float amp = 1.0f;
+
+		for (unsigned int octave = 0; octave < m_octaves; octave++)
+		{
+			if (octave > 0)
+			{
+				px = _mm_mul_ps(px, lacunarity);
+				py = _mm_mul_ps(py, lacunarity);
+				amp *= m_gain;
+			}
+			const unsigned char offset = m_perm[octave];
+
+			// FastFloor: truncate, then subtract one for negative inputs
+			const __m128i x0 = _mm_add_epi32(_mm_cvttps_epi32(px), _mm_castps_si128(_mm_cmplt_ps(px, zero)));
+			const __m128i y0 = _mm_add_epi32(_mm_cvttps_epi32(py), _mm_castps_si128(_mm_cmplt_ps(py, zero)));
+
+			const __m128 xd0 = _mm_sub_ps(px, _mm_cvtepi32_ps(x0));
+			const __m128 yd0 = _mm_sub_ps(py, _mm_cvtepi32_ps(y0));
+			const __m128 xd1 = _mm_sub_ps(xd0, one);
+			const __m128 yd1 = _mm_sub_ps(yd0, one);
+
+			__m128 xs, ys;
+			switch (m_interp)
+			{
+			case Linear:
+				xs = xd0;
+				ys = yd0;
+				break;
+			case Hermite:
+				xs = _mm_mul_ps(_mm_mul_ps(xd0, xd0), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), xd0)));
+				ys = _mm_mul_ps(_mm_mul_ps(yd0, yd0), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), yd0)));
+				break;
+			default:
+				xs = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(xd0, xd0), xd0), _mm_add_ps(_mm_mul_ps(xd0, _mm_sub_ps(_mm_mul_ps(xd0, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f)));
+				ys = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(yd0, yd0), yd0), _mm_add_ps(_mm_mul_ps(yd0, _mm_sub_ps(_mm_mul_ps(yd0, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f)));
+				break;
+			}
+
+			alignas(16) int ix0[4], iy0[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(ix0), x0);
+			_mm_store_si128(reinterpret_cast<__m128i*>(iy0), y0);
+
+			alignas(16) float gx[4][4], gy[4][4];
+			for (int lane = 0; lane < 4; lane++)
+			{
+				// Equivalent to the Index2D_12(x, y, offset) calls made by GradCoord2D, sharing the inner lookups
+				const int inner0 = m_perm[offset + static_cast<unsigned char>(ix0[lane])];
+				const int inner1 = m_perm[offset + static_cast<unsigned char>(ix0[lane] + 1)];
+				const int outer0 = iy0[lane] & 0xff;
+				const int outer1 = (iy0[lane] + 1) & 0xff;
+				const unsigned char lut00 = m_perm12[outer0 + inner0];
+				const unsigned char lut10 = m_perm12[outer0 + inner1];
+				const unsigned char lut01 = m_perm12[outer1 + inner0];
+				const unsigned char lut11 = m_perm12[outer1 + inner1];
+				gx[0][lane] = GRAD_X[lut00]; gy[0][lane] = GRAD_Y[lut00];
+				gx[1][lane] = GRAD_X[lut10]; gy[1][lane] = GRAD_Y[lut10];
+				gx[2][lane] = GRAD_X[lut01]; gy[2][lane] = GRAD_Y[lut01];
+				gx[3][lane] = GRAD_X[lut11]; gy[3][lane] = GRAD_Y[lut11];
+			}
+
+			const __m128 g00 = _mm_add_ps(_mm_mul_ps(xd0, _mm_load_ps(gx[0])), _mm_mul_ps(yd0, _mm_load_ps(gy[0])));
+			const __m128 g10 = _mm_add_ps(_mm_mul_ps(xd1, _mm_load_ps(gx[1])), _mm_mul_ps(yd0, _mm_load_ps(gy[1])));
+			const __m128 g01 = _mm_add_ps(_mm_mul_ps(xd0, _mm_load_ps(gx[2])), _mm_mul_ps(yd1, _mm_load_ps(gy[2])));
+			const __m128 g11 = _mm_add_ps(_mm_mul_ps(xd1, _mm_load_ps(gx[3])), _mm_mul_ps(yd1, _mm_load_ps(gy[3])));
+
+			const __m128 xf0 = _mm_add_ps(g00, _mm_mul_ps(xs, _mm_sub_ps(g10, g00)));
+			const __m128 xf1 = _mm_add_ps(g01, _mm_mul_ps(xs, _mm_sub_ps(g11, g01)));
+			const __m128 noise = _mm_add_ps(xf0, _mm_mul_ps(ys, _mm_sub_ps(xf1, xf0)));
+
+			sum = (octave == 0) ? noise : _mm_add_ps(sum, _mm_mul_ps(noise, _mm_set1_ps(amp)));
+		}
+
+		_mm_storeu_ps(out + i, _mm_mul_ps(sum, _mm_set1_ps(m_fractalBounding)));
+	}
+#endif
+
+	for (; i < count; i++)
+		out[i] = SingleGradientFractalFBM(x[i] * m_frequency, y[i] * m_frequency);
+}
+
 float FastNoise::SingleGradientFractalBillow(float x, float y)
 {
 	float sum = FastAbs(SingleGradient(m_perm[0], x, y)) * 2.0f - 1.0f;
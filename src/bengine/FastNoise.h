@@ -75,6 +75,12 @@ public:
 
 	float GetNoise(float x, float y);
 
+	// Batched 2D sampling: out[i] = GetNoise(x[i], y[i]), with identical results.
+	// GradientFractal FBM is evaluated four points at a time with SSE2 when it is available.
+	void GetNoiseSet(const float* x, const float* y, float* out, int count);
+	// As GetNoiseSet, for a row of points that share the same y.
+	void GetNoiseRow(const float* x, float y, float* out, int count);
+
 	void PositionWarp(float& x, float& y);
 	void PositionWarpFractal(float& x, float& y);
 
@@ -147,6 +153,7 @@ protected:
 	float SingleGradientFractalBillow(float x, float y);
 	float SingleGradientFractalRigidMulti(float x, float y);
 	float SingleGradient(unsigned char offset, float x, float y);
+	void SingleGradientFractalFBMSet(const float* x, const float* y, float* out, int count);
 
 	float SingleSimplexFractalFBM(float x, float y);
 	float SingleSimplexFractalBillow(float x, float y);
@@ -0,0 +1,58 @@
+#include "fov.hpp"
+#include <memory>
+#include <mutex>
+#include <algorithm>
+
+namespace bengine {
+
+	static std::mutex fov_table_lock;
+	static std::vector<std::unique_ptr<std::vector<fov_cell_t>>> fov_tables;
+
+	// Step back one cell along the line from the origin, rounding to the nearest tile
+	static inline int ray_parent(const int c, const int length) noexcept {
+		return ((2 * c * (length - 1)) + length) / (2 * length);
+	}
+
+	static std::unique_ptr<std::vector<fov_cell_t>> build_octant_table(const int radius) {
+		struct staging_t {
+			int x, y, z, length;
+		};
+		std::vector<staging_t> cells;
+		const int radius_squared = radius * radius;
+		for (int z = 0; z <= radius; ++z) {
+			for (int y = 0; y <= radius; ++y) {
+				for (int x = 0; x <= radius; ++x) {
+					if ((x*x) + (y*y) + (z*z) < radius_squared || (x == 0 && y == 0 && z == 0)) {
+						cells.emplace_back(staging_t{ x, y, z, std::max(x, std::max(y, z)) });
+					}
+				}
+			}
+		}
+		// Parents are exactly one step shorter (Chebyshev), so sorting by length keeps them ahead of children
+		std::stable_sort(cells.begin(), cells.end(), [](const staging_t &a, const staging_t &b) { return a.length < b.length; });
+
+		const int width = radius + 1;
+		std::vector<int32_t> position(static_cast<std::size_t>(width) * width * width, -1);
+		auto result = std::make_unique<std::vector<fov_cell_t>>();
+		result->reserve(cells.size());
+		for (const auto &c : cells) {
+			int32_t parent = -1;
+			if (c.length > 0) {
+				const auto px = ray_parent(c.x, c.length);
+				const auto py = ray_parent(c.y, c.length);
+				const auto pz = ray_parent(c.z, c.length);
+				parent = position[(((pz * width) + py) * width) + px];
+			}
+			position[(((c.z * width) + c.y) * width) + c.x] = static_cast<int32_t>(result->size());
+			result->emplace_back(fov_cell_t{ static_cast<int16_t>(c.x), static_cast<int16_t>(c.y), static_cast<int16_t>(c.z), parent });
+		}
+		return result;
+	}
+
+	const std::vector<fov_cell_t> &fov_octant_table(const int radius) {
+		std::lock_guard<std::mutex> lock(fov_table_lock);
+		if (radius >= static_cast<int>(fov_tables.size())) fov_tables.resize(radius + 1);
+		if (!fov_tables[radius]) fov_tables[radius] = build_octant_table(radius);
+		return *fov_tables[radius];
+	}
+}
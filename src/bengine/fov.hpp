@@ -0,0 +1,159 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace bengine {
+
+	inline int lowest_set_bit(const uint64_t word) noexcept {
+#ifdef _MSC_VER
+		unsigned long result;
+		_BitScanForward64(&result, word);
+		return static_cast<int>(result);
+#else
+		return __builtin_ctzll(word);
+#endif
+	}
+
+	/*
+	 * Compact tile set, one bit per tile of the (2r+1)^3 box centred on an origin (a viewer, a blast).
+	 */
+	struct fov_bitset_t {
+		int origin_x = 0;
+		int origin_y = 0;
+		int origin_z = 0;
+		int radius = -1;
+		int width = 0;
+		std::size_t count = 0;
+		std::vector<uint64_t> bits;
+
+		void reset(const int x, const int y, const int z, const int r) {
+			origin_x = x;
+			origin_y = y;
+			origin_z = z;
+			radius = r;
+			width = (r * 2) + 1;
+			count = 0;
+			bits.assign(((static_cast<std::size_t>(width) * width * width) + 63) / 64, 0);
+		}
+
+		void clear() noexcept {
+			radius = -1;
+			width = 0;
+			count = 0;
+			bits.clear();
+		}
+
+		bool empty() const noexcept { return count == 0; }
+
+		inline int offset_index(const int dx, const int dy, const int dz) const noexcept {
+			return (((dz + radius) * width) + (dy + radius)) * width + (dx + radius);
+		}
+
+		inline bool test_offset(const int dx, const int dy, const int dz) const noexcept {
+			const auto i = offset_index(dx, dy, dz);
+			return (bits[i >> 6] & (1ULL << (i & 63))) != 0;
+		}
+
+		inline void set_offset(const int dx, const int dy, const int dz) noexcept {
+			const auto i = offset_index(dx, dy, dz);
+			auto &word = bits[i >> 6];
+			const auto mask = 1ULL << (i & 63);
+			if ((word & mask) == 0) {
+				word |= mask;
+				++count;
+			}
+		}
+
+		/*
+		 * Is the world tile x/y/z in the set? Tiles outside of the box are never visible.
+		 */
+		inline bool test(const int x, const int y, const int z) const noexcept {
+			const auto dx = x - origin_x;
+			const auto dy = y - origin_y;
+			const auto dz = z - origin_z;
+			if (radius < 0 || dx < -radius || dx > radius || dy < -radius || dy > radius || dz < -radius || dz > radius) return false;
+			return test_offset(dx, dy, dz);
+		}
+
+		/*
+		 * Calls func(x, y, z) with world coordinates for every tile in the set.
+		 */
+		template <typename F>
+		void each(F &&func) const {
+			for (std::size_t w = 0; w < bits.size(); ++w) {
+				auto word = bits[w];
+				while (word) {
+					const auto i = static_cast<int>((w << 6) + lowest_set_bit(word));
+					word &= word - 1;
+					const auto dx = i % width;
+					const auto dy = (i / width) % width;
+					const auto dz = i / (width * width);
+					func(origin_x + dx - radius, origin_y + dy - radius, origin_z + dz - radius);
+				}
+			}
+		}
+	};
+
+	/*
+	 * One cell of a precomputed ray fan. Offsets are in the positive octant; parent indexes the previous
+	 * cell on the ray from the origin (always earlier in the table).
+	 */
+	struct fov_cell_t {
+		int16_t x, y, z;
+		int32_t parent;
+	};
+
+	/*
+	 * Returns the (cached) positive-octant ray fan for a radius, ordered so that parents precede children.
+	 * It covers every cell whose squared distance from the origin is less than radius squared.
+	 */
+	const std::vector<fov_cell_t> &fov_octant_table(const int radius);
+
+	/*
+	 * 3D field of view by ray fan: every cell within radius is visited exactly once, and is visible if the
+	 * cell before it on the ray from the origin is visible and lets light through. Opaque cells are themselves
+	 * visible, but hide what is behind them. in_bounds(x,y,z) and is_opaque(x,y,z) are callbacks in world space;
+	 * out-of-bounds cells are neither visible nor transparent. A penetrating view ignores opacity.
+	 */
+	template <typename B, typename O>
+	void fov_3d(const int x, const int y, const int z, const int radius, const bool penetrating, fov_bitset_t &visible, B &&in_bounds, O &&is_opaque) {
+		static thread_local fov_bitset_t transparent;
+
+		visible.reset(x, y, z, radius);
+		transparent.reset(x, y, z, radius);
+
+		// Always see where we are standing
+		visible.set_offset(0, 0, 0);
+		transparent.set_offset(0, 0, 0);
+
+		const auto &table = fov_octant_table(radius);
+		for (int octant = 0; octant < 8; ++octant) {
+			const int sx = (octant & 1) ? -1 : 1;
+			const int sy = (octant & 2) ? -1 : 1;
+			const int sz = (octant & 4) ? -1 : 1;
+
+			for (std::size_t i = 1; i < table.size(); ++i) {
+				const auto &cell = table[i];
+
+				// Cells on an axis plane are shared with the positive octant, which has already handled them
+				if ((sx < 0 && cell.x == 0) || (sy < 0 && cell.y == 0) || (sz < 0 && cell.z == 0)) continue;
+
+				const auto &parent = table[cell.parent];
+				if (!transparent.test_offset(parent.x * sx, parent.y * sy, parent.z * sz)) continue;
+
+				const int dx = cell.x * sx;
+				const int dy = cell.y * sy;
+				const int dz = cell.z * sz;
+				if (!in_bounds(x + dx, y + dy, z + dz)) continue;
+
+				visible.set_offset(dx, dy, dz);
+				if (penetrating || !is_opaque(x + dx, y + dy, z + dz)) transparent.set_offset(dx, dy, dz);
+			}
+		}
+	}
+}
@@ -1,29 +1,25 @@
 #include "octree.hpp"
-#include <algorithm>
 
 void octree_t::add_node(const octree_location_t loc) {
-    const auto idx = mapidx(loc.x, loc.y, loc.z);
-    contents[idx].emplace_back(loc.id);
-    ++total_nodes;
+    store.insert(loc.id, loc.x, loc.y, loc.z);
+    total_nodes = store.size();
 }
 
 void octree_t::remove_node(const octree_location_t &loc) {
-    const auto idx = mapidx(loc.x, loc.y, loc.z);
-    contents[idx].erase(
-        std::remove_if(
-                contents[idx].begin(),
-                contents[idx].end(),
-                [&loc] (const std::size_t &test) { return test == loc.id; }
-        ),
-        contents[idx].end());
+    store.remove(loc.id, loc.x, loc.y, loc.z);
+    total_nodes = store.size();
+}
+
+void octree_t::move_node(const octree_location_t &from, const octree_location_t &to) {
+    store.move(to.id, from.x, from.y, from.z, to.x, to.y, to.z);
+    total_nodes = store.size();
 }
 
 std::vector<int> octree_t::find_by_loc(const octree_location_t &loc) {
     std::vector<int> result;
-    const auto idx = mapidx(loc.x, loc.y, loc.z);
-    for (const auto &loc : contents[idx]) {
-        result.push_back(loc);
-    }
+    store.each_at(loc.x, loc.y, loc.z, [&result] (const int &id) {
+        result.push_back(id);
+    });
     return result;
 }
 
@@ -31,15 +27,8 @@ std::vector<int> octree_t::find_by_region(const int &left, const int &right, con
                                         const int &ztop, const int &zbottom)
 {
     std::vector<int> result;
-    for (auto z=zbottom; z<ztop; ++z) {
-        for (auto y=top; y<bottom; ++y) {
-            for (auto x=left; x<right; ++x) {
-                const auto idx = mapidx(x,y,z);
-                for (const auto &loc : contents[idx]) {
-                    result.emplace_back(loc);
-                }
-            }
-        }
-    }
+    find_by_region(left, right, top, bottom, ztop, zbottom, [&result] (const int &id) {
+        result.emplace_back(id);
+    });
     return result;
 }
@@ -2,28 +2,65 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include "../planet/region/region.hpp"
+#include "spatial_store.hpp"
 
 struct octree_location_t {
     int x, y, z;
     int id;
 };
 
-// Not really an octree anymore - trying to speed it up
+// Size (in tiles) of the coarse cells used for radius queries
+constexpr int OCTREE_CELL_SIZE = 16;
+
+// Not really an octree anymore - a thin wrapper around a spatial_store_t, keeping the old interface
 struct octree_t {
-    octree_t() {
-        contents.resize(nf::REGION_TILES_COUNT);
-    }
+    octree_t() : store(nf::REGION_WIDTH, nf::REGION_HEIGHT, nf::REGION_DEPTH, OCTREE_CELL_SIZE) {}
 
-    std::vector<std::vector<int>> contents;
+    bengine::spatial_store_t store;
     std::size_t total_nodes = 0;
 
     void add_node(const octree_location_t loc);
 
     void remove_node(const octree_location_t &loc);
 
+    /* Equivalent to remove_node(from) followed by add_node(to), without releasing the entry. */
+    void move_node(const octree_location_t &from, const octree_location_t &to);
+
     std::vector<int> find_by_loc(const octree_location_t &loc);
 
+    /* Ids come back coarse cell by coarse cell (insertion order within each), not in tile order. */
     std::vector<int> find_by_region(const int &left, const int &right, const int &top, const int &bottom,
                                             const int &ztop, const int &zbottom);
+
+    std::size_t memory_usage() const noexcept { return store.memory_usage(); }
+
+    /*
+     * Allocation-free versions of the finders: func(id) is called for each entity found.
+     */
+    template <typename F>
+    void find_by_loc(const octree_location_t &loc, F &&func) const {
+        store.each_at(loc.x, loc.y, loc.z, func);
+    }
+
+    template <typename F>
+    void find_by_region(const int &left, const int &right, const int &top, const int &bottom,
+                        const int &ztop, const int &zbottom, F &&func) const
+    {
+        store.each_in_box(left, top, zbottom, right - 1, bottom - 1, ztop - 1, [&func] (const bengine::spatial_entry_t &e) {
+            func(e.id);
+        });
+    }
+
+    /*
+     * Calls func(location) for every entity within the cube of the given radius around x/y/z, using the
+     * coarse cells rather than walking every tile.
+     */
+    template <typename F>
+    void find_by_radius(const int &x, const int &y, const int &z, const int &radius, F &&func) const {
+        store.each_in_box(x - radius, y - radius, z - radius, x + radius, y + radius, z + radius, [&func] (const bengine::spatial_entry_t &e) {
+            func(octree_location_t{ e.x, e.y, e.z, e.id });
+        });
+    }
 };
@@ -4,18 +4,22 @@
 
 namespace bengine {
 
+    // Seeded generators all use the same stream, so a seed means the same sequence in every run
+    constexpr uint64_t SEEDED_STREAM = 0xda3e39cb94b95bdbULL;
+
     random_number_generator::random_number_generator() {
         pcg32_srandom_r(&rng, time(NULL), (intptr_t)&rng);
     }
 
     random_number_generator::random_number_generator(const int seed) {
-        pcg32_srandom_r(&rng, seed, (intptr_t)&rng);
+        initial_seed = seed;
+        pcg32_srandom_r(&rng, seed, SEEDED_STREAM);
     }
 
     random_number_generator::random_number_generator(const std::string seed) {
         std::hash<std::string> hash_func;
         initial_seed = static_cast<int>(hash_func(seed));
-        pcg32_srandom_r(&rng, initial_seed, (intptr_t)&rng);
+        pcg32_srandom_r(&rng, initial_seed, SEEDED_STREAM);
     }
 
     int random_number_generator::roll_dice(const int &n, const int &d) {
@@ -0,0 +1,133 @@
+#include "spatial_store.hpp"
+
+namespace bengine {
+
+	spatial_store_t::spatial_store_t(const int width, const int height, const int depth, const int cell_size)
+		: width(width), height(height), depth(depth), cell_size(cell_size)
+	{
+		cells_wide = (width + cell_size - 1) / cell_size;
+		cells_high = (height + cell_size - 1) / cell_size;
+		cells_deep = (depth + cell_size - 1) / cell_size;
+		cell_heads.assign(static_cast<std::size_t>(cells_wide) * cells_high * cells_deep, -1);
+	}
+
+	void spatial_store_t::link(int &head, const int s, const int list) {
+		auto &slot = slots[s];
+		if (head < 0) {
+			head = s;
+			slot.next[list] = s;
+			slot.prev[list] = s;
+			return;
+		}
+		// Circular list: the head's prev is the tail, so appending keeps insertion order
+		const auto tail = slots[head].prev[list];
+		slot.prev[list] = tail;
+		slot.next[list] = head;
+		slots[tail].next[list] = s;
+		slots[head].prev[list] = s;
+	}
+
+	void spatial_store_t::unlink(int &head, const int s, const int list) {
+		auto &slot = slots[s];
+		if (slot.next[list] == s) {
+			head = -1;
+			return;
+		}
+		slots[slot.prev[list]].next[list] = slot.next[list];
+		slots[slot.next[list]].prev[list] = slot.prev[list];
+		if (head == s) head = slot.next[list];
+	}
+
+	int spatial_store_t::find_slot(const int id, const int x, const int y, const int z) const {
+		const auto by_id = slot_by_id.find(id);
+		if (by_id != slot_by_id.end()) {
+			const auto &e = slots[by_id->second].entry;
+			if (e.x == x && e.y == y && e.z == z) return by_id->second;
+		}
+
+		// The id has entries on several tiles; fall back to walking this tile
+		const auto finder = tile_heads.find(tile_key(x, y, z));
+		if (finder == tile_heads.end()) return -1;
+		auto s = finder->second;
+		do {
+			if (slots[s].entry.id == id) return s;
+			s = slots[s].next[TILE_LIST];
+		} while (s != finder->second);
+		return -1;
+	}
+
+	void spatial_store_t::insert(const int id, const int x, const int y, const int z) {
+		int s;
+		if (!free_slots.empty()) {
+			s = free_slots.back();
+			free_slots.pop_back();
+		}
+		else {
+			s = static_cast<int>(slots.size());
+			slots.emplace_back();
+		}
+		slots[s].entry = spatial_entry_t{ id, x, y, z };
+
+		const auto tile = tile_heads.emplace(tile_key(x, y, z), -1).first;
+		link(tile->second, s, TILE_LIST);
+		link(cell_heads[cell_key(x, y, z)], s, CELL_LIST);
+		slot_by_id[id] = s;
+		++count;
+	}
+
+	void spatial_store_t::release(const int s) {
+		const auto &e = slots[s].entry;
+		const auto tile = tile_heads.find(tile_key(e.x, e.y, e.z));
+		unlink(tile->second, s, TILE_LIST);
+		if (tile->second < 0) tile_heads.erase(tile);
+		unlink(cell_heads[cell_key(e.x, e.y, e.z)], s, CELL_LIST);
+	}
+
+	bool spatial_store_t::remove(const int id, const int x, const int y, const int z) {
+		// An id added to the same tile more than once has a slot for each, and they all go
+		auto removed = false;
+		for (auto s = find_slot(id, x, y, z); s >= 0; s = find_slot(id, x, y, z)) {
+			release(s);
+			const auto by_id = slot_by_id.find(id);
+			if (by_id != slot_by_id.end() && by_id->second == s) slot_by_id.erase(by_id);
+			free_slots.emplace_back(s);
+			--count;
+			removed = true;
+		}
+		return removed;
+	}
+
+	void spatial_store_t::move(const int id, const int from_x, const int from_y, const int from_z, const int to_x, const int to_y, const int to_z) {
+		const auto s = find_slot(id, from_x, from_y, from_z);
+		if (s < 0) {
+			insert(id, to_x, to_y, to_z);
+			return;
+		}
+
+		release(s);
+		slots[s].entry = spatial_entry_t{ id, to_x, to_y, to_z };
+		const auto tile = tile_heads.emplace(tile_key(to_x, to_y, to_z), -1).first;
+		link(tile->second, s, TILE_LIST);
+		link(cell_heads[cell_key(to_x, to_y, to_z)], s, CELL_LIST);
+		slot_by_id[id] = s;
+	}
+
+	void spatial_store_t::clear() {
+		slots.clear();
+		free_slots.clear();
+		tile_heads.clear();
+		slot_by_id.clear();
+		std::fill(cell_heads.begin(), cell_heads.end(), -1);
+		count = 0;
+	}
+
+	std::size_t spatial_store_t::memory_usage() const noexcept {
+		// Hash nodes are roughly a key/value pair plus a next pointer and cached hash; buckets are one pointer each
+		constexpr std::size_t hash_node = sizeof(std::pair<const int, int>) + (sizeof(void *) * 2);
+		return (slots.capacity() * sizeof(slot_t))
+			+ (free_slots.capacity() * sizeof(int))
+			+ (cell_heads.capacity() * sizeof(int))
+			+ (tile_heads.size() * hash_node) + (tile_heads.bucket_count() * sizeof(void *))
+			+ (slot_by_id.size() * hash_node) + (slot_by_id.bucket_count() * sizeof(void *));
+	}
+}
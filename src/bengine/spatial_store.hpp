@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <algorithm>
+
+namespace bengine {
+
+	/*
+	 * One entry in a spatial_store_t: an entity id at a tile.
+	 */
+	struct spatial_entry_t {
+		int id;
+		int x, y, z;
+	};
+
+	/*
+	 * Compact spatial index of entities by tile. Entries live in one flat slot array (with a free list), and are
+	 * threaded onto two intrusive doubly-linked lists: one per occupied tile (heads in a hash of occupied tiles
+	 * only) and one per coarse cell (a small flat array), for area queries. Insert, remove and move are O(1);
+	 * iterating a tile or a box walks the lists in place without allocating. An entity may be in more than one
+	 * tile (multi-tile buildings); lists keep insertion order.
+	 *
+	 * Callbacks passed to the each_ functions must not insert or remove entries.
+	 */
+	class spatial_store_t {
+	public:
+		spatial_store_t(const int width, const int height, const int depth, const int cell_size);
+
+		void insert(const int id, const int x, const int y, const int z);
+
+		/* Removes every entry for id on tile x/y/z; returns false if there were none. */
+		bool remove(const int id, const int x, const int y, const int z);
+
+		/* Moves id from one tile to another, re-using its slot; inserts it if it wasn't at the origin. */
+		void move(const int id, const int from_x, const int from_y, const int from_z, const int to_x, const int to_y, const int to_z);
+
+		void clear();
+
+		std::size_t size() const noexcept { return count; }
+
+		/* Approximate heap footprint in bytes, including the hash of occupied tiles. */
+		std::size_t memory_usage() const noexcept;
+
+		/* Calls func(id) for every entity at x/y/z. */
+		template <typename F>
+		void each_at(const int x, const int y, const int z, F &&func) const {
+			const auto finder = tile_heads.find(tile_key(x, y, z));
+			if (finder == tile_heads.end()) return;
+			const auto head = finder->second;
+			auto s = head;
+			do {
+				const auto &slot = slots[s];
+				func(slot.entry.id);
+				s = slot.next[TILE_LIST];
+			} while (s != head);
+		}
+
+		/* Calls func(const spatial_entry_t &) for every entity in the inclusive box: cell by cell, in insertion order within a cell. */
+		template <typename F>
+		void each_in_box(int min_x, int min_y, int min_z, int max_x, int max_y, int max_z, F &&func) const {
+			min_x = std::max(0, min_x);
+			min_y = std::max(0, min_y);
+			min_z = std::max(0, min_z);
+			max_x = std::min(width - 1, max_x);
+			max_y = std::min(height - 1, max_y);
+			max_z = std::min(depth - 1, max_z);
+			if (min_x > max_x || min_y > max_y || min_z > max_z) return;
+
+			for (auto cz = min_z / cell_size; cz <= max_z / cell_size; ++cz) {
+				for (auto cy = min_y / cell_size; cy <= max_y / cell_size; ++cy) {
+					for (auto cx = min_x / cell_size; cx <= max_x / cell_size; ++cx) {
+						const auto head = cell_heads[(((cz * cells_high) + cy) * cells_wide) + cx];
+						if (head < 0) continue;
+						auto s = head;
+						do {
+							const auto &slot = slots[s];
+							const auto &e = slot.entry;
+							if (e.x >= min_x && e.x <= max_x && e.y >= min_y && e.y <= max_y && e.z >= min_z && e.z <= max_z) {
+								func(e);
+							}
+							s = slot.next[CELL_LIST];
+						} while (s != head);
+					}
+				}
+			}
+		}
+
+	private:
+		static constexpr int TILE_LIST = 0;
+		static constexpr int CELL_LIST = 1;
+
+		struct slot_t {
+			spatial_entry_t entry;
+			int next[2];
+			int prev[2];
+		};
+
+		inline int tile_key(const int x, const int y, const int z) const noexcept {
+			return (((z * height) + y) * width) + x;
+		}
+
+		inline int cell_key(const int x, const int y, const int z) const noexcept {
+			return ((((z / cell_size) * cells_high) + (y / cell_size)) * cells_wide) + (x / cell_size);
+		}
+
+		void link(int &head, const int s, const int list);
+		void unlink(int &head, const int s, const int list);
+		int find_slot(const int id, const int x, const int y, const int z) const;
+		void release(const int s);
+
+		int width, height, depth, cell_size;
+		int cells_wide, cells_high, cells_deep;
+		std::size_t count = 0;
+
+		std::vector<slot_t> slots;
+		std::vector<int> free_slots;
+		std::vector<int> cell_heads;
+		std::unordered_map<int, int> tile_heads;
+		std::unordered_map<int, int> slot_by_id; // Most recent slot for each id
+	};
+}
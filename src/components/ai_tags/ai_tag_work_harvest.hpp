@@ -8,6 +8,7 @@ struct ai_tag_work_harvest {
 
     harvest_steps step = FIND_HOE;
 	std::size_t tool_id = 0;
+	int target_tile = 0;
 	std::shared_ptr<navigation_path_t> current_path; // Not serialized
 
 };
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <unordered_set>
+#include "../bengine/fov.hpp"
 
 struct explosion_t {
 	explosion_t() = default;
@@ -14,5 +14,5 @@ struct explosion_t {
     uint16_t fuse_timer = 254;
     uint8_t damage_dice = 1;
     uint16_t damage_dice_type = 6;
-    std::unordered_set<int> tiles_hit;    
+    bengine::fov_bitset_t tiles_hit; // Tiles already blasted, in a box around the explosion
 };
@@ -5,4 +5,7 @@ struct initiative_t {
     explicit initiative_t(const int init_mod) noexcept : initiative_modifier(init_mod) {}
     int initiative = 0;
     int initiative_modifier = 0;
+
+    // Non-persistent: how many times over the last roll was stretched by the AI level of detail
+    int lod_cadence = 1;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include "position.hpp"
 #include "../components/helpers/reaction_task_t.hpp"
 #include "../components/helpers/building_designation_t.hpp"
@@ -32,6 +33,18 @@ enum job_minor_t {
     JM_FIND_TIDY, JM_GO_TO_TIDY, JM_COLLECT_TIDY, JM_FIND_STOCKPILE, JM_GO_TO_STOCKPILE, JM_STORE_ITEM // Tidying/stockpiling
 };
 
+/*
+ * Which job types a settler currently has the tag for, one bit per type in the order the jobs board registered
+ * them. The board keeps this up to date as it hands out and cancels work, so "is this settler busy?" is a single
+ * load rather than a component lookup per job type. It's rebuilt from the tags whenever the board's generation
+ * has moved on (job types registering, or a freshly loaded settler), so it never needs saving.
+ */
+struct job_state_t {
+	uint64_t work = 0;
+	uint64_t leisure = 0;
+	uint32_t generation = 0;
+};
+
 struct settler_ai_t {
 
 	std::array<bool, NUMBER_OF_JOB_CATEGORIES> permitted_work;
@@ -53,6 +66,7 @@ struct settler_ai_t {
 	// Non-persistent
 	std::shared_ptr<navigation_path_t> current_path;
 	std::size_t targeted_hostile = 0;
+	job_state_t job_state;
 
 	settler_ai_t() {
 		std::fill(permitted_work.begin(), permitted_work.end(), true);
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <unordered_set>
+#include "../bengine/fov.hpp"
 
 struct viewshed_t {
 	viewshed_t() = default;
@@ -13,5 +14,5 @@ struct viewshed_t {
 	std::unordered_set<std::size_t> visible_entities;
 
 	// Non-persistent
-	std::unordered_set<int> visible_cache;
+	bengine::fov_bitset_t visible_cache;
 };
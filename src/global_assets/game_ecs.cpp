@@ -5,6 +5,7 @@
 #include <cereal/archives/portable_binary.hpp>
 #include "../components/all_components.hpp"
 #include "../bengine/ecs.hpp"
+#include "../utils/profiler.hpp"
 
 template<class Archive>
 void serialize(Archive & archive, mining_designations_t &m)
@@ -175,7 +176,7 @@ template<class Archive>
 void serialize(Archive & archive, ai_tag_work_harvest &f)
 {
 	// Nothing to save
-	archive(f.step, f.tool_id);
+	archive(f.step, f.tool_id, f.target_tile);
 }
 
 
@@ -376,7 +377,7 @@ void serialize(Archive & archive, designated_lumberjack_t &tag)
 template<class Archive>
 void serialize(Archive & archive, explosion_t &e)
 {
-	archive(e.blast_radius, e.blast_timer, e.fuse_timer, e.damage_dice, e.damage_dice_type, e.tiles_hit); // serialize things by passing them to the archive
+	archive(e.blast_radius, e.blast_timer, e.fuse_timer, e.damage_dice, e.damage_dice_type, e.tiles_hit.origin_x, e.tiles_hit.origin_y, e.tiles_hit.origin_z, e.tiles_hit.radius, e.tiles_hit.width, e.tiles_hit.count, e.tiles_hit.bits); // serialize things by passing them to the archive
 }
 
 template<class Archive>
@@ -793,12 +794,19 @@ namespace bengine {
 
 	void ecs_save(std::unique_ptr<std::ofstream> &lbfile) noexcept
 	{
-		cereal::PortableBinaryOutputArchive oarchive(*lbfile);
+		profiler::scope_t profile("save.ecs");
+		ecs_save(*lbfile);
+	}
+
+	void ecs_save(std::ostream &out) noexcept
+	{
+		cereal::PortableBinaryOutputArchive oarchive(out);
 		oarchive(impl::ecs);
 	}
 
 	void ecs_load(std::unique_ptr<std::ifstream> &lbfile) noexcept
 	{
+		profiler::scope_t profile("load.ecs");
 		impl::ecs.delete_all_entities();
 		cereal::PortableBinaryInputArchive iarchive(*lbfile);
 		iarchive(impl::ecs);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../bengine/ecs.hpp"
+#include <iosfwd>
 #include <memory>
 
 namespace bengine {
@@ -66,5 +67,8 @@ namespace bengine {
 	}
 
 	void ecs_save(std::unique_ptr<std::ofstream> &lbfile) noexcept;
+
+	/* Writes the same bytes as a save to any stream; saves of the same state are identical. */
+	void ecs_save(std::ostream &out) noexcept;
 	void ecs_load(std::unique_ptr<std::ifstream> &lbfile) noexcept;
 }
\ No newline at end of file
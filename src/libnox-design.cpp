@@ -1,4 +1,5 @@
 #include "libnox.h"
+#include "libnox-replay.hpp"
 #include "libnox-render.hpp"
 #include "global_assets/game_ecs.hpp"
 #include "planet/region/region.hpp"
@@ -37,6 +38,7 @@ namespace nf {
 	}
 
 	void guardmode_set() {
+		replay::record("guardmode_set");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		if (region::flag(idx, tile_flags::CAN_STAND_HERE)) {
 			bool found = false;
@@ -48,6 +50,7 @@ namespace nf {
 	}
 
 	void guardmode_clear() {
+		replay::record("guardmode_clear");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		if (region::flag(idx, tile_flags::CAN_STAND_HERE)) {
 			designations->guard_points.erase(std::remove_if(
@@ -60,26 +63,19 @@ namespace nf {
 	}
 
 	void lumberjack_set() {
+		replay::record("lumberjack_set");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		const auto tree_id = region::tree_id(idx);
 		if (tree_id > 0) {
-			int lowest_z = camera_position->region_z;
-			const int stop_z = lowest_z - 10;
-
-			position_t tree_pos{ mouse_x, mouse_y, lowest_z };
-			while (lowest_z > stop_z) {
-				for (int y = -10; y<10; ++y) {
-					for (int x = -10; x<10; ++x) {
-						const int tree_idx = mapidx(mouse_x + x, mouse_y + y, lowest_z);
-						if (region::tree_id(tree_idx) == tree_id) {
-							tree_pos.x = mouse_x + x;
-							tree_pos.y = mouse_y + y;
-							tree_pos.z = lowest_z;
-							// TODO: Emit Particles
-						}
-					}
+			// Target the base of the tree: its lowest tile.
+			position_t tree_pos{ mouse_x, mouse_y, mouse_z };
+			for (const auto &tree_idx : region::tree_tiles(tree_id)) {
+				const auto &[x, y, z] = idxmap(tree_idx);
+				if (z < tree_pos.z) {
+					tree_pos.x = x;
+					tree_pos.y = y;
+					tree_pos.z = z;
 				}
-				--lowest_z;
 			}
 
 			designations->chopping[(int)tree_id] = tree_pos;
@@ -87,6 +83,7 @@ namespace nf {
 	}
 
 	void lumberjack_clear() {
+		replay::record("lumberjack_clear");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		const auto tree_id = region::tree_id(idx);
 		if (tree_id > 0) {
@@ -109,6 +106,7 @@ namespace nf {
 	}
 
 	void set_selected_building(int list_index) {
+		replay::record("set_selected_building", list_index);
 		selected_building = list_index;
 
 		auto available_buildings = inventory::get_available_buildings();
@@ -122,6 +120,7 @@ namespace nf {
 	}
 
 	void place_selected_building() {
+		replay::record("place_selected_building");
 		auto can_build = true;
 		const auto tag = buildings::build_mode_building.tag;
 		const auto building_def = get_building_def(tag);
@@ -156,6 +155,7 @@ namespace nf {
 	}
 
 	void plantable_seeds(size_t &size, plantable_seed_t *& seed_ptr) {
+		replay::record_query("plantable_seeds");
 		impl::available_seeds.clear();
 
 		std::map<std::string, std::pair<int, std::string>> available_seeds;
@@ -188,10 +188,12 @@ namespace nf {
 	}
 
 	void set_selected_seed(int list_index) {
+		replay::record("set_selected_seed", list_index);
 		selected_seed = list_index;
 	}
 
 	void plant_set() {
+		replay::record("plant_set");
 		if (!impl::available_seeds.empty() && selected_seed < impl::available_seeds.size()) {
 			const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 			const auto farm = farm_designations->farms.find(idx);
@@ -215,6 +217,7 @@ namespace nf {
 	}
 
 	void plant_clear() {
+		replay::record("plant_clear");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		farm_designations->farms.erase(idx);
 	}
@@ -222,6 +225,7 @@ namespace nf {
 	static int mine_mode = 0;
 
 	void set_mining_mode(int mode) {
+		replay::record("set_mining_mode", mode);
 		mine_mode = mode;
 	}
 
@@ -230,12 +234,14 @@ namespace nf {
 	}
 
 	void mine_set() {
+		replay::record("mine_set");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		mining_designations->mining_targets[idx] = mine_mode;
 		systems::mining_system::mining_map_changed();
 	}
 
 	void mine_clear() {
+		replay::record("mine_clear");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		mining_designations->mining_targets.erase(idx);
 		systems::mining_system::mining_map_changed();
@@ -244,6 +250,7 @@ namespace nf {
 	static int architecture_mode = 0;
 
 	void set_architecture_mode(int mode) {
+		replay::record("set_architecture_mode", mode);
 		architecture_mode = mode;
 	}
 
@@ -252,12 +259,14 @@ namespace nf {
 	}
 
 	void architecture_set() {
+		replay::record("architecture_set");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		architecture_designations->architecture[idx] = architecture_mode;
 		systems::architecture_system::architecture_map_changed();
 	}
 
 	void architecture_clear() {
+		replay::record("architecture_clear");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		architecture_designations->architecture.erase(idx);
 		systems::architecture_system::architecture_map_changed();
@@ -272,6 +281,7 @@ namespace nf {
 	}
 
 	void workflow_menu(size_t &queue_size, queued_work_t *& queued_work_ptr, size_t &available_size, available_work_t *& available_work_ptr, size_t &standing_order_size, active_standing_order_t *& standing_order_ptr) {		
+		replay::record_query("workflow_menu");
 		// Clear everything
 		impl::workflow_queue.clear();
 		impl::workflow_available.clear();
@@ -366,6 +376,7 @@ namespace nf {
 	}
 
 	void workflow_remove_from_queue(int index) {
+		replay::record("workflow_remove_from_queue", index);
 		if (impl::workflow_queue.size() - 1 < index) return;
 
 		std::vector<std::string> to_remove;
@@ -396,6 +407,7 @@ namespace nf {
 	}
 
 	void workflow_enqueue(int index) {
+		replay::record("workflow_enqueue", index);
 		if (impl::workflow_available.size() - 1 < index) return;
 		std::string reaction_tag = impl::workflow_available[index].reaction_def;
 		auto found = false;
@@ -412,6 +424,7 @@ namespace nf {
 	}
 
 	void workflow_add_so(int index) {
+		replay::record("workflow_add_so", index);
 		if (impl::workflow_available.size() - 1 < index) return;
 
 		auto wf = impl::workflow_available[index];
@@ -420,6 +433,7 @@ namespace nf {
 	}
 
 	void workflow_remove_so(int index) {
+		replay::record("workflow_remove_so", index);
 		if (impl::worfklow_standing_orders.size() - 1 < index) return;
 
 		auto wf = impl::worfklow_standing_orders[index];
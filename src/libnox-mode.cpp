@@ -1,4 +1,5 @@
 #include "libnox.h"
+#include "libnox-replay.hpp"
 #include "global_assets/game_pause.hpp"
 #include "global_assets/game_mode.hpp"
 
@@ -8,6 +9,7 @@ namespace nf {
 	}
 
 	void set_pause_mode(int mode) {
+		replay::record("set_pause_mode", mode);
 		switch (mode) {
 		case 0: pause_mode = RUNNING; break;
 		case 1: pause_mode = PAUSED; break;
@@ -22,6 +24,7 @@ namespace nf {
 	}
 
 	void set_game_mode(int major, int minor) {
+		replay::record("set_game_mode", major, minor);
 		game_master_mode = (game_master_mode_t)major;
 		game_design_mode = (game_design_mode_t)minor;
 	}
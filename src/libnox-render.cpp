@@ -1,9 +1,11 @@
 #include "libnox.h"
+#include "libnox-replay.hpp"
 #include "libnox-render.hpp"
 #include "global_assets/game_camera.hpp"
 #include "noxconsts.h"
 #include "planet/region/renderables.hpp"
 #include "planet/region/lighting.hpp"
+#include "planet/region/view_culling.hpp"
 #include "planet/region/region.hpp"
 #include "global_assets/game_ecs.hpp"
 #include "global_assets/game_mode.hpp"
@@ -12,6 +14,7 @@
 #include "global_assets/game_mining.hpp"
 #include "global_assets/architecture_designations.hpp"
 #include "nox_impl_helpers.hpp"
+#include "systems/physics/visibility_system.hpp"
 #include <vector>
 
 namespace nf {
@@ -21,6 +24,8 @@ namespace nf {
 		static std::vector<dynamic_lightsource_t> dyn_lights;
 		static std::vector<water_t> water;
 		static std::vector<cube_t> cursors;
+		static std::vector<int> chunks_in_view;
+		static std::vector<int> visibility_changed;
 	}
 
 	int mouse_x = 0;
@@ -39,16 +44,19 @@ namespace nf {
 	}
 
 	void camera_zoom_in() {
+		replay::record("camera_zoom_in");
 		--camera->zoom_level;
 		if (camera->zoom_level < 1) camera->zoom_level = 1;
 	}
 
 	void camera_zoom_out() {
+		replay::record("camera_zoom_out");
 		++camera->zoom_level;
 		if (camera->zoom_level > 150) camera->zoom_level = 150;
 	}
 
 	void camera_move(const int &x, const int &y, const int &z) {
+		replay::record("camera_move", x, y, z);
 		camera_position->region_x += x;
 		camera_position->region_y += y;
 		camera_position->region_z += z;
@@ -62,6 +70,7 @@ namespace nf {
 	}
 
 	void toggle_camera_mode() {
+		replay::record("toggle_camera_mode");
 		switch (camera->camera_mode) {
 		case game_camera_mode_t::DIAGONAL_LOOK_NW: {
 			camera->camera_mode = game_camera_mode_t::DIAGONAL_LOOK_NE;
@@ -86,9 +95,24 @@ namespace nf {
 	}
 
 	void toggle_camera_perspective() {
+		replay::record("toggle_camera_perspective");
 		camera->perspective = !camera->perspective;
 	}
 
+	void set_view_box(const view_box_t &box) {
+		render::set_view_box(box);
+	}
+
+	void clear_view_box() {
+		render::clear_view_box();
+	}
+
+	void visible_chunks(size_t &size, int *& chunk_ptr) {
+		impl::chunks_in_view.clear();
+		render::get_visible_chunks(impl::chunks_in_view);
+		ArrayToUnrealPtr<int>(size, chunk_ptr, impl::chunks_in_view);
+	}
+
 	void voxel_render_list(size_t &size, dynamic_model_t *& model_ptr) {
 		impl::dyn_models.clear();
 		render::build_voxel_list(selected_building, mouse_x, mouse_y, mouse_z);
@@ -102,6 +126,12 @@ namespace nf {
 		ArrayToUnrealPtr<dynamic_lightsource_t>(size, light_ptr, impl::dyn_lights);
 	}
 
+	void visibility_changes(size_t &size, int *& idx_ptr) {
+		impl::visibility_changed.clear();
+		systems::visibility::get_visibility_changes(impl::visibility_changed);
+		ArrayToUnrealPtr<int>(size, idx_ptr, impl::visibility_changed);
+	}
+
 	void water_cubes(size_t &size, water_t *& water_ptr) {
 		impl::water.clear();
 		std::vector<uint32_t> * w = region::get_water_level();
@@ -120,6 +150,7 @@ namespace nf {
 	}
 
 	void zoom_settler(int id) {
+		replay::record("zoom_settler", id);
 		auto settler = bengine::entity(id);
 		if (settler) {
 			auto pos = settler->component<position_t>();
@@ -132,6 +163,7 @@ namespace nf {
 	}
 
 	void follow_settler(int id) {
+		replay::record("follow_settler", id);
 		auto settler = bengine::entity(id);
 		if (settler) {
 			auto pos = settler->component<position_t>();
@@ -153,30 +185,27 @@ namespace nf {
 		if (game_master_mode == DESIGN) {
 			if (game_design_mode == GUARDPOINTS) {
 				for (const auto &gp : designations->guard_points) {
+					if (!render::in_view(gp.second.x, gp.second.y, gp.second.z)) continue;
 					impl::cursors.emplace_back(cube_t{ gp.second.x, gp.second.y, gp.second.z, 1, 1, 1, 3 });
 				}
 			}
 			else if (game_design_mode == CHOPPING) {
-				for (size_t i = 0; i < REGION_TILES_COUNT; ++i) {
-					auto tree_id = region::tree_id(i);
-					if (tree_id > 0) {
-						auto[x, y, z] = idxmap(i);
-						if (designations->chopping.find(tree_id) != designations->chopping.end()) {
-							impl::cursors.emplace_back(cube_t{ x, y, z, 1, 1, 1, 2 });
-							//std::cout << "Highlighting tree at " << x << ", " << y << ", " << z << "\n";
-						}
-						//else {
-						//	add_cube_geometry(data, n_elements_cursor_elements, x, y, z, 1, 1, 2);
-						//}
+				for (const auto &tree : designations->chopping) {
+					for (const auto &idx : region::tree_tiles(tree.first)) {
+						const auto &[x, y, z] = idxmap(idx);
+						if (!render::in_view(x, y, z)) continue;
+						impl::cursors.emplace_back(cube_t{ x, y, z, 1, 1, 1, 2 });
 					}
 				}
 			}
 			else if (game_design_mode == HARVEST) {
-				for (const auto &idx : farm_designations->harvest) {					
+				for (const auto &idx : farm_designations->harvest) {
+					if (!render::in_view(idx.second.x, idx.second.y, idx.second.z)) continue;
 					impl::cursors.emplace_back(cube_t{ idx.second.x, idx.second.y, idx.second.z, 1, 1, 1, 4 });
 				}
 				for (const auto &f : farm_designations->farms) {
 					auto[x, y, z] = idxmap(f.first);
+					if (!render::in_view(x, y, z)) continue;
 					impl::cursors.emplace_back(cube_t{ x, y, z, 1, 1, 1, 4 });
 				}
 			}
@@ -192,7 +221,7 @@ namespace nf {
 					case MINE_STAIRS_DOWN: glyph = 9; break;
 					case MINE_STAIRS_UPDOWN: glyph = 10; break;
 					}
-					if (camera_position->region_z == z) impl::cursors.emplace_back(cube_t{ x, y, z, 1, 1, 1, glyph });
+					if (camera_position->region_z == z && render::in_view(x, y, z)) impl::cursors.emplace_back(cube_t{ x, y, z, 1, 1, 1, glyph });
 				}
 			}
 			else if (game_design_mode == ARCHITECTURE) {
@@ -210,7 +239,7 @@ namespace nf {
 					case 6: glyph = 13; break; // Bridge
 					}
 
-					if (camera_position->region_z == z) impl::cursors.emplace_back(cube_t{ x, y, z, 1, 1, 1, glyph });
+					if (camera_position->region_z == z && render::in_view(x, y, z)) impl::cursors.emplace_back(cube_t{ x, y, z, 1, 1, 1, glyph });
 				}
 			}
 		}
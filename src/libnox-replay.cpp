@@ -0,0 +1,367 @@
+#include "libnox.h"
+#include "libnox-replay.hpp"
+#include "libnox-render.hpp"
+#include "global_assets/game_ecs.hpp"
+#include "global_assets/game_building.hpp"
+#include "global_assets/rng.hpp"
+#include "planet/region/region.hpp"
+#include "systems/helpers/path_service.hpp"
+#include "systems/physics/vegetation_system.hpp"
+#include "systems/scheduler/ai_lod.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+
+namespace replay {
+
+	using namespace nf;
+
+	const std::string JOURNAL_HEADER = "nox-journal 1";
+
+	namespace impl {
+		bool recording = false;
+	}
+
+	// Recording
+	static std::unique_ptr<std::ofstream> journal;
+	static int ticks = 0;
+	static int checkpoint_every = 0;
+	static std::string last_query;
+
+	// Replaying
+	struct entry_t {
+		int tick = 0;
+		std::string call;
+		std::vector<double> args;
+		uint64_t hash = 0; // For checkpoints
+	};
+
+	static bool replaying = false;
+	static std::vector<entry_t> entries;
+	static std::size_t next_entry = 0;
+	static std::deque<int> batch_sizes;
+	static replay_result_t replayed{};
+
+	/*
+	 * World hash: 64-bit FNV-1a, a word at a time.
+	 */
+	constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+	constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+	static inline void mix(uint64_t &hash, const uint64_t value) noexcept {
+		hash ^= value;
+		hash *= FNV_PRIME;
+	}
+
+	uint64_t world_hash() {
+		// Growing plants only write their tickers back when something looks at them
+		systems::vegetation::sync_tickers();
+
+		uint64_t hash = FNV_OFFSET;
+		for (int idx = 0; idx < REGION_TILES_COUNT; ++idx) {
+			mix(hash, region::tile_type(idx));
+			mix(hash, region::material(idx));
+			mix(hash, region::tile_hit_points(idx));
+			mix(hash, region::water_level(idx));
+			mix(hash, region::veg_type(idx));
+			mix(hash, region::veg_ticker(idx));
+			mix(hash, region::veg_lifecycle(idx));
+			mix(hash, region::veg_hp(idx));
+			mix(hash, region::get_building_id(idx));
+			mix(hash, static_cast<uint64_t>(region::tree_id(idx)));
+			mix(hash, region::stockpile_id(idx));
+			mix(hash, region::bridge_id(idx));
+		}
+
+		std::ostringstream ecs;
+		bengine::ecs_save(ecs);
+		for (const auto &c : ecs.str()) mix(hash, static_cast<uint8_t>(c));
+		return hash;
+	}
+
+	/*
+	 * The calls a journal can hold, by name.
+	 */
+	using args_t = std::vector<double>;
+	using call_t = std::function<void(const args_t &)>;
+
+	static inline int arg(const args_t &args, const std::size_t i) noexcept {
+		return i < args.size() ? static_cast<int>(args[i]) : 0;
+	}
+
+	static const std::map<std::string, call_t> &calls() {
+		static const std::map<std::string, call_t> table{
+			{ "on_tick", [](const args_t &a) { on_tick(a.empty() ? 0.0 : a[0]); } },
+			{ "set_pause_mode", [](const args_t &a) { set_pause_mode(arg(a, 0)); } },
+			{ "set_game_mode", [](const args_t &a) { set_game_mode(arg(a, 0), arg(a, 1)); } },
+			{ "set_ai_lod", [](const args_t &a) { set_ai_lod(arg(a, 0), arg(a, 1)); } },
+			{ "camera_zoom_in", [](const args_t &) { camera_zoom_in(); } },
+			{ "camera_zoom_out", [](const args_t &) { camera_zoom_out(); } },
+			{ "camera_move", [](const args_t &a) { camera_move(arg(a, 0), arg(a, 1), arg(a, 2)); } },
+			{ "toggle_camera_mode", [](const args_t &) { toggle_camera_mode(); } },
+			{ "toggle_camera_perspective", [](const args_t &) { toggle_camera_perspective(); } },
+			{ "zoom_settler", [](const args_t &a) { zoom_settler(arg(a, 0)); } },
+			{ "follow_settler", [](const args_t &a) { follow_settler(arg(a, 0)); } },
+			{ "set_world_pos_from_mouse", [](const args_t &a) { set_world_pos_from_mouse(arg(a, 0), arg(a, 1), arg(a, 2)); } },
+			{ "make_miner", [](const args_t &a) { make_miner(arg(a, 0)); } },
+			{ "make_farmer", [](const args_t &a) { make_farmer(arg(a, 0)); } },
+			{ "make_lumberjack", [](const args_t &a) { make_lumberjack(arg(a, 0)); } },
+			{ "make_hunter", [](const args_t &a) { make_hunter(arg(a, 0)); } },
+			{ "fire_miner", [](const args_t &a) { fire_miner(arg(a, 0)); } },
+			{ "fire_farmer", [](const args_t &a) { fire_farmer(arg(a, 0)); } },
+			{ "fire_lumberjack", [](const args_t &a) { fire_lumberjack(arg(a, 0)); } },
+			{ "fire_hunter", [](const args_t &a) { fire_hunter(arg(a, 0)); } },
+			{ "guardmode_set", [](const args_t &) { guardmode_set(); } },
+			{ "guardmode_clear", [](const args_t &) { guardmode_clear(); } },
+			{ "lumberjack_set", [](const args_t &) { lumberjack_set(); } },
+			{ "lumberjack_clear", [](const args_t &) { lumberjack_clear(); } },
+			{ "set_selected_building", [](const args_t &a) { set_selected_building(arg(a, 0)); } },
+			{ "place_selected_building", [](const args_t &) { place_selected_building(); } },
+			{ "harvest_set", [](const args_t &) { harvest_set(); } },
+			{ "harvest_clear", [](const args_t &) { harvest_clear(); } },
+			{ "plantable_seeds", [](const args_t &) { size_t size; plantable_seed_t * ptr; plantable_seeds(size, ptr); } },
+			{ "set_selected_seed", [](const args_t &a) { set_selected_seed(arg(a, 0)); } },
+			{ "plant_set", [](const args_t &) { plant_set(); } },
+			{ "plant_clear", [](const args_t &) { plant_clear(); } },
+			{ "set_mining_mode", [](const args_t &a) { set_mining_mode(arg(a, 0)); } },
+			{ "mine_set", [](const args_t &) { mine_set(); } },
+			{ "mine_clear", [](const args_t &) { mine_clear(); } },
+			{ "set_architecture_mode", [](const args_t &a) { set_architecture_mode(arg(a, 0)); } },
+			{ "architecture_set", [](const args_t &) { architecture_set(); } },
+			{ "architecture_clear", [](const args_t &) { architecture_clear(); } },
+			{ "workflow_menu", [](const args_t &) {
+				size_t queue_size, available_size, standing_order_size;
+				queued_work_t * queue_ptr;
+				available_work_t * available_ptr;
+				active_standing_order_t * standing_order_ptr;
+				workflow_menu(queue_size, queue_ptr, available_size, available_ptr, standing_order_size, standing_order_ptr);
+			} },
+			{ "workflow_remove_from_queue", [](const args_t &a) { workflow_remove_from_queue(arg(a, 0)); } },
+			{ "workflow_enqueue", [](const args_t &a) { workflow_enqueue(arg(a, 0)); } },
+			{ "workflow_add_so", [](const args_t &a) { workflow_add_so(arg(a, 0)); } },
+			{ "workflow_remove_so", [](const args_t &a) { workflow_remove_so(arg(a, 0)); } }
+		};
+		return table;
+	}
+
+	/*
+	 * Recording
+	 */
+	void impl::write(const char * call, const std::vector<double> &args) {
+		*journal << ticks << ' ' << call;
+		for (const auto &a : args) *journal << ' ' << a;
+		*journal << '\n';
+		last_query.clear();
+	}
+
+	void impl::write_query(const char * call) {
+		if (last_query == call) return;
+		write(call, {});
+		last_query = call;
+	}
+
+	void tick_finished(const uint64_t paths_searched) {
+		if (!impl::recording) return;
+		++ticks;
+
+		// At most one batch is delivered a tick, and it always gets at least one search in
+		if (paths_searched > 0) *journal << ticks << " paths " << paths_searched << '\n';
+
+		if (checkpoint_every > 0 && ticks % checkpoint_every == 0) {
+			*journal << ticks << " hash " << std::hex << world_hash() << std::dec << '\n';
+			journal->flush();
+		}
+	}
+
+	bool start_recording(const std::string &path, const int seed, const int checkpoint_ticks) {
+		if (impl::recording || replaying) return false;
+		auto file = std::make_unique<std::ofstream>(path, std::ios::out | std::ios::trunc);
+		if (!file->good()) return false;
+
+		journal = std::move(file);
+		ticks = 0;
+		checkpoint_every = std::max(0, checkpoint_ticks);
+		last_query.clear();
+
+		*journal << JOURNAL_HEADER << '\n';
+		*journal << "seed " << seed << '\n';
+		// A replay starts straight after load_game, with nothing queued; a batch still being searched would be
+		// delivered on the first recorded tick and throw the journaled batch sizes out of step
+		path_service::reset();
+		*journal << "start " << std::hex << world_hash() << std::dec << '\n';
+		*journal << std::setprecision(17); // Tick durations have to come back exactly
+		rng = bengine::random_number_generator(seed);
+		impl::recording = true;
+
+		// Settings that aren't part of the save
+		int major, minor, radius, cadence;
+		get_game_mode(major, minor);
+		systems::ai_lod::get_settings(radius, cadence);
+		record("set_pause_mode", get_pause_mode());
+		record("set_game_mode", major, minor);
+		record("set_ai_lod", radius, cadence);
+		record("set_world_pos_from_mouse", mouse_x, mouse_y, mouse_z);
+		record("set_mining_mode", get_mining_mode());
+		record("set_architecture_mode", get_architecture_mode());
+		if (buildings::has_build_mode_building) record("set_selected_building", selected_building);
+
+		// Lists later calls pick from by index; refreshed (and so journaled) here so they match what the replay will see
+		for (const auto &query : { "plantable_seeds", "workflow_menu" }) calls().at(query)({});
+		record("set_selected_seed", selected_seed);
+
+		return true;
+	}
+
+	void stop_recording() {
+		if (!impl::recording) return;
+		*journal << "end " << ticks << '\n';
+		journal->close();
+		journal.reset();
+		impl::recording = false;
+	}
+
+	/*
+	 * Replaying
+	 */
+	bool open(const std::string &path) {
+		close();
+		replayed = replay_result_t{};
+		replayed.first_mismatch_tick = -1;
+		if (impl::recording) return false;
+
+		std::ifstream in(path);
+		std::string line;
+		if (!in.good() || !std::getline(in, line) || line != JOURNAL_HEADER) return false;
+
+		int seed = 0;
+		uint64_t start_hash = 0;
+		while (std::getline(in, line)) {
+			std::istringstream fields(line);
+			std::string first;
+			if (!(fields >> first)) continue;
+
+			if (first == "seed") {
+				fields >> seed;
+			}
+			else if (first == "start") {
+				fields >> std::hex >> start_hash;
+			}
+			else if (first == "end") {
+				break;
+			}
+			else {
+				entry_t entry;
+				entry.tick = std::stoi(first);
+				fields >> entry.call;
+				if (entry.call == "paths") {
+					int n;
+					fields >> n;
+					batch_sizes.emplace_back(n);
+					continue;
+				}
+				if (entry.call == "hash") {
+					fields >> std::hex >> entry.hash;
+				}
+				else {
+					// A journal from a newer build can't be replayed faithfully
+					if (calls().find(entry.call) == calls().end()) {
+						close();
+						return false;
+					}
+					double a;
+					while (fields >> a) entry.args.emplace_back(a);
+				}
+				entries.emplace_back(std::move(entry));
+			}
+		}
+
+		load_game();
+		replayed.start_matched = world_hash() == start_hash;
+		rng = bengine::random_number_generator(seed);
+		path_service::set_batch_limits([]() {
+			if (batch_sizes.empty()) return -1;
+			const auto n = batch_sizes.front();
+			batch_sizes.pop_front();
+			return n;
+		});
+
+		replaying = true;
+		replayed.loaded = true;
+		return true;
+	}
+
+	bool step() {
+		if (!replaying || next_entry >= entries.size()) return false;
+
+		auto ticked = false;
+		while (next_entry < entries.size()) {
+			const auto &entry = entries[next_entry];
+			if (entry.call == "hash") {
+				++replayed.checkpoints;
+				if (world_hash() != entry.hash) {
+					++replayed.mismatches;
+					if (replayed.first_mismatch_tick < 0) replayed.first_mismatch_tick = entry.tick;
+				}
+				++next_entry;
+				continue;
+			}
+			if (ticked) break;
+
+			const auto start = std::chrono::steady_clock::now();
+			calls().at(entry.call)(entry.args);
+			replayed.run_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			++replayed.calls;
+			if (entry.call == "on_tick") {
+				++replayed.ticks;
+				ticked = true;
+			}
+			++next_entry;
+		}
+		return true;
+	}
+
+	void close() {
+		if (replaying) path_service::set_batch_limits(nullptr);
+		replaying = false;
+		entries.clear();
+		next_entry = 0;
+		batch_sizes.clear();
+	}
+
+	const replay_result_t &result() {
+		return replayed;
+	}
+}
+
+namespace nf {
+
+	void start_recording(const char * journal_path, const int seed, const int checkpoint_ticks) {
+		replay::start_recording(journal_path, seed, checkpoint_ticks);
+	}
+
+	void stop_recording() {
+		replay::stop_recording();
+	}
+
+	bool is_recording() {
+		return replay::is_recording();
+	}
+
+	void replay_session(const char * journal_path, replay_result_t &result) {
+		if (replay::open(journal_path)) {
+			while (replay::step()) {}
+		}
+		result = replay::result();
+		replay::close();
+	}
+
+	unsigned long long world_hash() {
+		return replay::world_hash();
+	}
+}
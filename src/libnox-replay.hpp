@@ -0,0 +1,59 @@
+#pragma once
+
+#include "noxtypes.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Session journals. While recording, every nf:: call that changes the simulation (or something it reads, such as
+ * the camera) is written down with the number of ticks run before it, together with the RNG seed and how many
+ * requests each path batch got through before its time budget ran out. Replaying loads the save the recording
+ * started from and makes the same calls in the same order, with path batches cut to the recorded sizes, so the
+ * world ends up in the same state however long anything takes. World hashes written at checkpoints show whether
+ * (and when) a replay went somewhere else.
+ *
+ * The journal is plain text, one entry per line: "<tick> <call> <args...>".
+ */
+namespace replay {
+
+	namespace impl {
+		extern bool recording;
+		void write(const char * call, const std::vector<double> &args);
+		void write_query(const char * call);
+	}
+
+	inline bool is_recording() {
+		return impl::recording;
+	}
+
+	/* Journals a call and its (numeric) arguments; does nothing unless recording. */
+	template <typename ... ARGS>
+	inline void record(const char * call, const ARGS & ... args) {
+		if (impl::recording) impl::write(call, { static_cast<double>(args)... });
+	}
+
+	/* As record, for queries that fill lists later calls index into. Asking again before anything else happens is left out. */
+	inline void record_query(const char * call) {
+		if (impl::recording) impl::write_query(call);
+	}
+
+	/* Call at the end of each tick, with the number of path requests searched during it. */
+	void tick_finished(const uint64_t paths_searched);
+
+	bool start_recording(const std::string &path, const int seed, const int checkpoint_ticks);
+	void stop_recording();
+
+	/* Loads the journal and the game it starts from. */
+	bool open(const std::string &path);
+
+	/* Replays up to and including the next tick, and checks its hash if it has one. False once the journal is done. */
+	bool step();
+
+	void close();
+
+	const nf::replay_result_t &result();
+
+	/* Brings vegetation tickers up to date, then hashes the region's tiles and the serialized ECS. */
+	uint64_t world_hash();
+}
@@ -18,7 +18,14 @@
 #include "global_assets/game_mining.hpp"
 #include "global_assets/game_pause.hpp"
 #include "planet/region/region.hpp"
+#include "planet/region/view_culling.hpp"
 #include "raws/materials.hpp"
+#include "systems/helpers/path_service.hpp"
+#include "systems/physics/gravity_system.hpp"
+#include "systems/physics/trigger_system.hpp"
+#include "systems/physics/vegetation_system.hpp"
+#include "systems/physics/visibility_system.hpp"
+#include "systems/scheduler/ai_lod.hpp"
 #include <string>
 
 
@@ -89,7 +96,15 @@ namespace nf {
 		region::load_current_region(region_x, region_y);
 		region::tile_recalc_all();
 		region::update_outdoor_calculation();
-
+		render::invalidate_entity_buckets();
+
+		// Nothing the systems worked out for a previous game applies to this one
+		systems::visibility::reset();
+		systems::gravity::reset();
+		systems::vegetation::reset();
+		systems::triggers::reset();
+		systems::ai_lod::reset();
+		path_service::reset();
 	}
 
 	bool is_world_loadable() {
@@ -1,4 +1,5 @@
 #include "libnox.h"
+#include "libnox-replay.hpp"
 #include "global_assets/game_ecs.hpp"
 #include "planet/region/region.hpp"
 #include "libnox-render.hpp"
@@ -12,6 +13,7 @@
 #include "global_assets/game_designations.hpp"
 #include "global_assets/game_calendar.hpp"
 #include "nox_impl_helpers.hpp"
+#include "systems/ai/settler/jobs_board.hpp"
 #include <vector>
 #include <string>
 
@@ -309,6 +311,8 @@ namespace nf {
 			newsettler.is_lumberjack = e.component<designated_lumberjack_t>() != nullptr;
 			newsettler.is_miner = e.component<designated_miner_t>() != nullptr;
 			newsettler.is_hunter = e.component<designated_hunter_t>() != nullptr;
+			newsettler.is_working = jobs_board::is_working(e, s);
+			newsettler.is_on_leisure = jobs_board::is_working_on_leisure(e, s);
 			newsettler.id = e.id;
 
 			impl::jobs_list.emplace_back(newsettler);
@@ -318,6 +322,7 @@ namespace nf {
 	}
 
 	void make_miner(int id) {
+		replay::record("make_miner", id);
 		bengine::entity_t * settler = bengine::entity(id);
 		if (settler) {
 			settler->assign(designated_miner_t{});
@@ -330,6 +335,7 @@ namespace nf {
 	}
 
 	void make_farmer(int id) {
+		replay::record("make_farmer", id);
 		bengine::entity_t * settler = bengine::entity(id);
 		if (settler) {
 			settler->assign(designated_farmer_t{});
@@ -342,6 +348,7 @@ namespace nf {
 	}
 
 	void make_lumberjack(int id) {
+		replay::record("make_lumberjack", id);
 		bengine::entity_t * settler = bengine::entity(id);
 		if (settler) {
 			settler->assign(designated_lumberjack_t{});
@@ -354,6 +361,7 @@ namespace nf {
 	}
 
 	void make_hunter(int id) {
+		replay::record("make_hunter", id);
 		bengine::entity_t * settler = bengine::entity(id);
 		if (settler) {
 			settler->assign(designated_hunter_t{});
@@ -366,6 +374,7 @@ namespace nf {
 	}
 
 	void fire_miner(int id) {
+		replay::record("fire_miner", id);
 		bengine::delete_component<designated_miner_t>(id);
 		bengine::entity_t * settler = bengine::entity(id);
 		if (settler) {
@@ -377,6 +386,7 @@ namespace nf {
 	}
 
 	void fire_lumberjack(int id) {
+		replay::record("fire_lumberjack", id);
 		bengine::delete_component<designated_lumberjack_t>(id);
 		bengine::entity_t * settler = bengine::entity(id);
 		if (settler) {
@@ -388,6 +398,7 @@ namespace nf {
 	}
 
 	void fire_farmer(int id) {
+		replay::record("fire_farmer", id);
 		bengine::delete_component<designated_farmer_t>(id);
 		bengine::entity_t * settler = bengine::entity(id);
 		if (settler) {
@@ -399,6 +410,7 @@ namespace nf {
 	}
 
 	void fire_hunter(int id) {
+		replay::record("fire_hunter", id);
 		bengine::delete_component<designated_hunter_t>(id);
 		bengine::entity_t * settler = bengine::entity(id);
 		if (settler) {
@@ -449,6 +461,7 @@ namespace nf {
 	}
 
 	void harvest_set() {
+		replay::record("harvest_set");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		bool found = false;
 		for (const auto &g : farm_designations->harvest) {
@@ -460,6 +473,7 @@ namespace nf {
 	}
 
 	void harvest_clear() {
+		replay::record("harvest_clear");
 		const auto idx = mapidx(mouse_x, mouse_y, mouse_z);
 		farm_designations->harvest.erase(std::remove_if(
 			farm_designations->harvest.begin(),
@@ -1,4 +1,5 @@
 #include "libnox.h"
+#include "libnox-replay.hpp"
 #include "planet/planet.hpp"
 #include "global_assets/game_planet.hpp"
 #include "raws/raws.hpp"
@@ -19,6 +20,7 @@
 #include "planet/region/region_chunking.hpp"
 #include "planet/region/renderables.hpp"
 #include "planet/region/lighting.hpp"
+#include "planet/region/view_culling.hpp"
 #include "systems/run_systems.hpp"
 #include "raws/string_table.hpp"
 #include "raws/materials.hpp"
@@ -30,6 +32,11 @@
 #include "raws/buildings.hpp"
 #include "raws/defs/building_def_t.hpp"
 #include "systems/helpers/inventory_assistant.hpp"
+#include "systems/helpers/path_service.hpp"
+#include "systems/helpers/path_cache.hpp"
+#include "systems/scheduler/ai_lod.hpp"
+#include "utils/profiler.hpp"
+#include "nox_impl_helpers.hpp"
 #include "libnox-render.hpp"
 #include <array>
 
@@ -38,10 +45,82 @@ namespace nf {
 	bool water_dirty = true;
 
 	void on_tick(const double duration_ms) {
+		replay::record("on_tick", duration_ms);
+		const auto searched = path_service::get_stats().total_completed;
 		systems::run_systems(duration_ms * 1000.0);
+		render::invalidate_entity_buckets();
+		replay::tick_finished(path_service::get_stats().total_completed - searched);
 	}		
 
+	void set_pathfinding_budget(const double budget_ms) {
+		path_service::set_time_budget(budget_ms);
+	}
+
+	void get_pathfinding_stats(pathfinding_stats_t &stats) {
+		const auto service = path_service::get_stats();
+		stats.queue_depth = service.queue_depth;
+		stats.in_flight = service.in_flight;
+		stats.completed_last_tick = service.completed_last_tick;
+		stats.deferred_last_tick = service.deferred_last_tick;
+		stats.mean_search_us = service.mean_search_us;
+		stats.max_search_us = service.max_search_us;
+		stats.total_completed = service.total_completed;
+
+		const auto cache = path_cache::get_stats();
+		stats.cache_hits = cache.hits;
+		stats.cache_misses = cache.misses;
+		stats.cache_invalidated = cache.invalidated;
+		stats.cache_entries = cache.entries;
+		const auto lookups = cache.hits + cache.misses;
+		stats.cache_hit_rate = lookups > 0 ? static_cast<double>(cache.hits) / static_cast<double>(lookups) : 0.0;
+	}
+
+	void set_ai_lod(const int full_fidelity_radius, const int cadence) {
+		replay::record("set_ai_lod", full_fidelity_radius, cadence);
+		systems::ai_lod::set_full_fidelity_radius(full_fidelity_radius);
+		systems::ai_lod::set_cadence(cadence);
+	}
+
+	void get_ai_lod_stats(ai_lod_stats_t &stats) {
+		const auto lod = systems::ai_lod::get_stats();
+		stats.watchers = lod.watchers;
+		stats.full_turns = lod.full_turns;
+		stats.reduced_turns = lod.reduced_turns;
+		stats.woken = lod.woken;
+	}
+
+	namespace impl {
+		std::vector<profile_entry_t> profile_list;
+	}
+
+	void get_profile_stats(size_t &size, profile_entry_t *& entry_ptr) {
+		static std::vector<profiler::profile_stats_t> stats;
+		profiler::get_stats(stats);
+
+		impl::profile_list.clear();
+		for (const auto &s : stats) {
+			profile_entry_t entry;
+			strncpy_s(entry.name, s.name.c_str(), 63);
+			entry.calls = s.calls;
+			entry.last_ms = s.last_ms;
+			entry.mean_ms = s.mean_ms;
+			entry.p50_ms = s.p50_ms;
+			entry.p95_ms = s.p95_ms;
+			entry.p99_ms = s.p99_ms;
+			entry.max_ms = s.max_ms;
+			for (std::size_t i = 0; i < profiler::HISTOGRAM_BUCKETS; ++i) entry.histogram[i] = s.histogram[i];
+			impl::profile_list.emplace_back(entry);
+		}
+
+		ArrayToUnrealPtr<profile_entry_t>(size, entry_ptr, impl::profile_list);
+	}
+
+	void reset_profile_stats() {
+		profiler::reset();
+	}
+
 	void set_world_pos_from_mouse(int x, int y, int z) {
+		replay::record("set_world_pos_from_mouse", x, y, z);
 		mouse_x = x;
 		mouse_y = y;
 		mouse_z = z;
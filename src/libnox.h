@@ -116,6 +116,22 @@ namespace nf {
 	*/
 	void toggle_camera_perspective();
 
+	/*
+	* Tells the library which part of the world the host camera can see, in world coordinates (inclusive).
+	* Render queries (voxel models, lights, cursors, visible chunks) only return what falls inside it.
+	*/
+	void set_view_box(const view_box_t &box);
+
+	/*
+	* Removes the host view box; queries revert to the whole map, ten levels down from the camera.
+	*/
+	void clear_view_box();
+
+	/*
+	* Gets the list of chunk indices that intersect the current view box.
+	*/
+	void visible_chunks(size_t &size, int *& chunk_ptr);
+
 	/*
 	* Gets a list of voxel models to render.
 	*/
@@ -126,6 +142,11 @@ namespace nf {
 	*/
 	void lightsource_list(size_t &size, dynamic_lightsource_t *& light_ptr);
 
+	/*
+	* Gets the list of tile indices whose visibility changed since the last call.
+	*/
+	void visibility_changes(size_t &size, int *& idx_ptr);
+
 	/*
 	* Gets the current info for the HUD.
 	*/
@@ -151,6 +172,62 @@ namespace nf {
 	*/
 	void on_tick(const double duration_ms);
 
+	/*
+	* Sets how long (in milliseconds) the background path workers may spend on queued searches each tick.
+	*/
+	void set_pathfinding_budget(const double budget_ms);
+
+	/*
+	* Gets the path request queue depth, search timings and path cache hit rates.
+	*/
+	void get_pathfinding_stats(pathfinding_stats_t &stats);
+
+	/*
+	* Creatures further than full_fidelity_radius tiles from every settler and the camera wait cadence times as
+	* long between turns. A cadence of 1 turns this off.
+	*/
+	void set_ai_lod(const int full_fidelity_radius, const int cadence);
+
+	/*
+	* Gets how many turns were taken at full and at reduced fidelity last tick.
+	*/
+	void get_ai_lod_stats(ai_lod_stats_t &stats);
+
+	/*
+	* Gets timings for each system, path searches, chunk meshing, saving and loading; one entry per name.
+	*/
+	void get_profile_stats(size_t &size, profile_entry_t *& entry_ptr);
+
+	/*
+	* Forgets all profiler samples.
+	*/
+	void reset_profile_stats();
+
+	/*
+	* Starts journaling every call that changes the simulation to journal_path, with the tick it came in. Call it
+	* straight after load_game: the game's RNG is reseeded from seed, and a replay starts from the same save.
+	* Every checkpoint_ticks ticks the world hash is written down as well (0 for none).
+	*/
+	void start_recording(const char * journal_path, const int seed, const int checkpoint_ticks);
+
+	/*
+	* Finishes the journal.
+	*/
+	void stop_recording();
+
+	bool is_recording();
+
+	/*
+	* Loads the game the journal was recorded from and makes the same calls, as fast as possible, checking the
+	* world hash wherever the recording wrote one down.
+	*/
+	void replay_session(const char * journal_path, replay_result_t &result);
+
+	/*
+	* A hash of the region and every entity; equal states give equal hashes.
+	*/
+	unsigned long long world_hash();
+
 	/*
 	* Does water need re-rendering?
 	*/
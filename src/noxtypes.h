@@ -51,6 +51,55 @@ namespace nf {
 		int cash;
 	};
 
+	struct view_box_t {
+		int min_x, min_y, min_z, max_x, max_y, max_z;
+	};
+
+	struct pathfinding_stats_t {
+		int queue_depth;
+		int in_flight;
+		int completed_last_tick;
+		int deferred_last_tick;
+		double mean_search_us;
+		double max_search_us;
+		unsigned long long total_completed;
+		unsigned long long cache_hits;
+		unsigned long long cache_misses;
+		unsigned long long cache_invalidated;
+		unsigned long long cache_entries;
+		double cache_hit_rate; // Hits over lookups since start-up, 0..1
+	};
+
+	struct ai_lod_stats_t {
+		int watchers;		// Settlers, plus the camera
+		int full_turns;		// Turns taken at full fidelity last tick
+		int reduced_turns;	// Turns taken at the reduced cadence last tick
+		int woken;			// Reduced turns cut short last tick because something came near
+	};
+
+	struct profile_entry_t {
+		char name[64];					// A system, or pathfinding.*, chunks.*, save.*, load.*
+		unsigned long long calls;		// Since start-up, or the last reset
+		double last_ms;
+		double mean_ms;					// The rest are over the last 256 samples
+		double p50_ms;
+		double p95_ms;
+		double p99_ms;
+		double max_ms;
+		unsigned int histogram[16];		// Bucket 0 is under 1us, bucket n under 2^n us, the last everything slower
+	};
+
+	struct replay_result_t {
+		bool loaded;					// False if the journal couldn't be read, or holds calls this build doesn't know
+		bool start_matched;				// The save's world hash matched the one the recording started from
+		int ticks;
+		int calls;						// Including ticks
+		int checkpoints;				// World hashes compared
+		int mismatches;
+		int first_mismatch_tick;		// -1 if every checkpoint matched
+		double run_ms;
+	};
+
 	struct water_t {
 		float x, y, z, depth;
 	};
@@ -76,6 +125,8 @@ namespace nf {
 		bool is_lumberjack;
 		bool is_farmer;
 		bool is_hunter;
+		bool is_working;		// Has a work tag from the jobs board
+		bool is_on_leisure;		// Has a leisure tag from the jobs board
 		int id;
 	};
 
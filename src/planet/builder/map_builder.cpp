@@ -4,6 +4,10 @@
 #include <sstream>
 #include <fmt/format.h>
 #include "../../noxtypes.h"
+#include "../../utils/thread_pool.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
 
 using namespace nf;
 
@@ -32,22 +36,48 @@ FastNoise planet_noise_map(planet_t &planet, const int &perlin_seed) noexcept {
 	constexpr auto temperature_range = max_temperature - min_temperature;
 	constexpr auto half_planet_height = WORLD_HEIGHT / 2.0F;
 
-	// Determine height of the region block as an average of the containing tiles
-	#pragma omp parallel for
-	for (auto y=0; y<WORLD_HEIGHT; ++y) {
+	constexpr auto samples_per_block = REGION_WIDTH / REGION_FRACTION_TO_CONSIDER;
+	constexpr auto samples_per_row = WORLD_WIDTH * samples_per_block;
+
+	// Noise x coordinates are the same for every row, so work them out once
+	std::vector<float> row_x(samples_per_row);
+	for (auto x=0; x<WORLD_WIDTH; ++x) {
+		for (auto x1=0; x1<samples_per_block; ++x1) {
+			row_x[(x * samples_per_block) + x1] = noise_x(x, x1*REGION_FRACTION_TO_CONSIDER);
+		}
+	}
+
+	// Determine height of the region block as an average of the containing tiles. Workers only count the rows
+	// they finish; the calling thread (which takes rows too) is the one that reports progress.
+	std::atomic<int> rows_done{ 0 };
+	const auto caller = std::this_thread::get_id();
+	const auto build_row = [&](const int y) {
 		const auto distance_from_equator = std::abs((WORLD_HEIGHT/2)-y);
 		const auto temp_range_pct = 1.0F - (static_cast<float>(distance_from_equator) / half_planet_height);
 		const auto base_temp_by_latitude = ((temp_range_pct * temperature_range) + min_temperature);
-		//std::cout << y << "/" << distance_from_equator << "/" << temp_range_pct << "/" << base_temp_by_latitude << "\n";			
+		//std::cout << y << "/" << distance_from_equator << "/" << temp_range_pct << "/" << base_temp_by_latitude << "\n";
+
+		// Sample a whole world row of noise at a time
+		std::vector<float> samples(samples_per_block * samples_per_row);
+		for (auto y1=0; y1<samples_per_block; ++y1) {
+			const auto ny = noise_y(y, y1*REGION_FRACTION_TO_CONSIDER);
+			auto * out = &samples[y1 * samples_per_row];
+			if (worldgen_batched_noise) {
+				noise.GetNoiseRow(row_x.data(), ny, out, samples_per_row);
+			} else {
+				for (auto i=0; i<samples_per_row; ++i) out[i] = noise.GetNoise(row_x[i], ny);
+			}
+		}
+
 		for (auto x=0; x<WORLD_WIDTH; ++x) {
 			auto total_height = 0L;
 
 			uint8_t max = 0;
 			auto min = std::numeric_limits<uint8_t>::max();
 			auto n_tiles = 0;
-			for (auto y1=0; y1<REGION_HEIGHT/REGION_FRACTION_TO_CONSIDER; ++y1) {
-				for (auto x1=0; x1<REGION_WIDTH/REGION_FRACTION_TO_CONSIDER; ++x1) {
-					const auto nh = noise.GetNoise ( noise_x(x,x1*REGION_FRACTION_TO_CONSIDER), noise_y(y,y1*REGION_FRACTION_TO_CONSIDER) );
+			for (auto y1=0; y1<samples_per_block; ++y1) {
+				for (auto x1=0; x1<samples_per_block; ++x1) {
+					const auto nh = samples[(y1 * samples_per_row) + (x * samples_per_block) + x1];
 					//std::cout << nh << "\n";
 					const auto n = noise_to_planet_height(nh);
 					if (n < min) min = n;
@@ -65,12 +95,20 @@ FastNoise planet_noise_map(planet_t &planet, const int &perlin_seed) noexcept {
             if (planet.landblocks[planet.idx(x,y)].temperature_c > 55) planet.landblocks[planet.idx(x,y)].temperature_c = 55;
 
 		}
-		fmt::MemoryWriter ss;
-		const auto percent = static_cast<double>(y) / static_cast<double>(WORLD_HEIGHT);
-		ss << "Dividing heavens from the earth: " << (percent*100) << "%";
-		set_worldgen_status(ss.str());
-		planet_display_update_altitude(planet);
+		const auto done = ++rows_done;
+		if (std::this_thread::get_id() == caller) {
+			fmt::MemoryWriter ss;
+			ss << "Dividing heavens from the earth: " << (static_cast<double>(done) / static_cast<double>(WORLD_HEIGHT) * 100) << "%";
+			set_worldgen_status(ss.str());
+		}
+	};
+
+	if (worldgen_batched_noise) {
+		worker_pool().parallel_for(0, WORLD_HEIGHT, build_row);
+	} else {
+		for (auto y=0; y<WORLD_HEIGHT; ++y) build_row(y);
 	}
+	planet_display_update_altitude(planet);
 
 	return noise;
 }
@@ -132,8 +170,8 @@ void planet_base_type_allocation(planet_t &planet) noexcept {
 				block.rainfall = 10;
 			}
 		}
-		planet_display_update_altitude(planet);
 	}
+	planet_display_update_altitude(planet);
 }
 
 void planet_mark_coastlines(planet_t &planet) noexcept {
@@ -59,26 +59,11 @@ void build_debris_trail(const int crash_x, const int crash_y) noexcept {
 				const auto target_tree = tree_id(idx);
 
 				auto number_of_logs = 0;
-				auto tree_idx = 0;
-				auto lowest_z = 1000;
-
-				for (auto Z = 0; Z < REGION_DEPTH; ++Z) {
-					for (auto Y = 0; Y < REGION_HEIGHT; ++Y) {
-						for (auto X = 0; X < REGION_WIDTH; ++X) {
-							const auto tidx = mapidx(X, Y, Z);
-							if (tree_id(tidx) == target_tree) {
-								if (Z < lowest_z) {
-									lowest_z = Z;
-									tree_idx = tidx;
-								}
-
-								set_tile_type(tidx, tile_type::OPEN_SPACE);
-								set_tree_id(tidx, 0);
-								++number_of_logs;
-							}
-						}
-					}
+				for (const auto &tidx : tree_tiles(target_tree)) {
+					set_tile_type(tidx, tile_type::OPEN_SPACE);
+					++number_of_logs;
 				}
+				delete_tree(target_tree);
 
 				set_tile_type(idx, tile_type::FLOOR);
 				// Spawn wooden logs
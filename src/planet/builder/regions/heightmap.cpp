@@ -4,6 +4,7 @@
 #include "../../region/region.hpp"
 #include "../../../bengine/geometry.hpp"
 #include "../../../noxtypes.h"
+#include "../../../utils/thread_pool.hpp"
 
 using namespace region;
 using namespace nf;
@@ -16,15 +17,30 @@ std::vector<uint8_t> create_empty_heightmap() noexcept {
 }
 
 void build_heightmap_from_noise(std::pair<int,int> &target, FastNoise &noise, std::vector<uint8_t> &heightmap, planet_t &planet) noexcept {
-    for (auto y=0; y<REGION_HEIGHT; ++y) {
+    std::vector<float> row_x(REGION_WIDTH);
+    for (auto x=0; x<REGION_WIDTH; ++x) {
+        row_x[x] = noise_x(target.first, x);
+    }
+
+    const auto build_row = [&target, &noise, &heightmap, &planet, &row_x] (const int y) {
+        float samples[REGION_WIDTH];
+        const auto ny = noise_y(target.second, y);
+        if (worldgen_batched_noise) {
+            noise.GetNoiseRow(row_x.data(), ny, samples, REGION_WIDTH);
+        } else {
+            for (auto x=0; x<REGION_WIDTH; ++x) samples[x] = noise.GetNoise(row_x[x], ny);
+        }
         for (auto x=0; x<REGION_WIDTH; ++x) {
-            const auto nx = noise_x(target.first, x);
-            const auto ny = noise_y(target.second, y);
-            const auto nh = noise.GetNoise ( nx, ny );
-            const auto altitude = noise_to_planet_height(nh);
+            const auto altitude = noise_to_planet_height(samples[x]);
             const auto cell_idx = (y * REGION_WIDTH) + x;
             heightmap[cell_idx] = altitude - planet.water_height + 5;
         }
+    };
+
+    if (worldgen_batched_noise) {
+        worker_pool().parallel_for(0, REGION_HEIGHT, build_row);
+    } else {
+        for (auto y=0; y<REGION_HEIGHT; ++y) build_row(y);
     }
 }
 
@@ -12,11 +12,13 @@
 
 #include "planet.hpp"
 #include "../bengine/filesystem.hpp"
+#include "../utils/profiler.hpp"
 #include <iostream>
 
 const std::string planet_filename = get_save_path() + std::string("/planet.dat");
 
 void save_planet(const planet_t &planet) {
+	profiler::scope_t profile("save.planet");
 	std::fstream lbfile(planet_filename, std::ios::out | std::ios::binary);
 
     cereal::BinaryOutputArchive oarchive(lbfile);
@@ -24,6 +26,7 @@ void save_planet(const planet_t &planet) {
 }
 
 planet_t load_planet() {
+	profiler::scope_t profile("load.planet");
 	planet_t lplanet;
 
 	std::fstream lbfile(planet_filename, std::ios::in | std::ios::binary);
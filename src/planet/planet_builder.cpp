@@ -14,6 +14,7 @@ using namespace nf;
 
 std::atomic<bool> planet_build_done;
 std::mutex planet_builder_lock;
+bool worldgen_batched_noise = true;
 std::unique_ptr<std::vector<worldgen_display_t>> planet_builder_display;
 std::string planet_builder_status;
 
@@ -15,6 +15,10 @@ void build_planet(const int &seed, const int &water_divisor, const int &plains_d
     const bool &strict_beamdown, const bool &ascii_mode) noexcept;
 bool is_planet_build_complete() noexcept;
 extern std::mutex planet_builder_lock;
+
+/* Worldgen samples noise a row at a time through FastNoise's batch API, spread over the worker pool. Clearing
+ * this goes back to one GetNoise call per sample on the calling thread - same results, for comparing timings. */
+extern bool worldgen_batched_noise;
 extern std::unique_ptr<std::vector<worldgen_display_t>> planet_builder_display;
 extern std::string planet_builder_status;
 
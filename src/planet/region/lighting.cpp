@@ -1,6 +1,7 @@
 #include "lighting.hpp"
 #include "../../global_assets/game_ecs.hpp"
 #include "../../global_assets/game_designations.hpp"
+#include "view_culling.hpp"
 
 namespace render {
 	void get_light_list(std::vector<nf::dynamic_lightsource_t> &lights) {
@@ -22,6 +23,9 @@ namespace render {
 		}
 
 		each<lightsource_t, position_t>([&lights, &alert_color](entity_t &e, lightsource_t &l, position_t &pos) {
+			// Lights just outside the view box can still illuminate it
+			if (!in_view(pos.x, pos.y, pos.z, l.radius)) return;
+
 			if (l.alert_status) {
 				lights.emplace_back(nf::dynamic_lightsource_t{ (float)pos.x, (float)pos.y, (float)pos.z, alert_color.r, alert_color.g, alert_color.b, (float)l.radius, e.id });
 			}
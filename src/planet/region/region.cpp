@@ -8,6 +8,9 @@
 #include "../../bengine/bitset.hpp"
 //#include "../../systems/physics/fluid_system.hpp"
 #include "region_chunking.hpp"
+#include "../../utils/profiler.hpp"
+#include <unordered_map>
+#include <algorithm>
 
 using namespace tile_flags;
 
@@ -15,6 +18,12 @@ namespace region {
 
 	using namespace nf;
 
+	/* Maps an object ID # (tree, bridge, building, stockpile) to the tiles that carry it. */
+	using tile_index_t = std::unordered_map<uint32_t, std::vector<int>>;
+
+	/* Source of walkability version numbers; never reset, so a freshly loaded region can't match stale versions. */
+	static uint32_t walkability_epoch = 0;
+
 	struct region_t {
 		region_t() {
 			tile_type.resize(REGION_TILES_COUNT);
@@ -32,6 +41,9 @@ namespace region {
 			bridge_id.resize(REGION_TILES_COUNT);
 			//veg_render_cache_ascii.resize(REGION_TILES_COUNT);
 			building_id.resize(REGION_TILES_COUNT);
+			roof_height.resize(REGION_WIDTH * REGION_HEIGHT, -1);
+			column_dirty.resize(REGION_WIDTH * REGION_HEIGHT, 0);
+			walkability_version.assign(CHUNKS_TOTAL, ++walkability_epoch);
 		}
 
 		int region_x=0, region_y=0, biome_idx=0;
@@ -52,12 +64,51 @@ namespace region {
 		std::vector<uint32_t> water_level;
 		//std::vector<render::ascii::glyph_t> veg_render_cache_ascii;
 
+		// Reverse lookups for the ID layers above; not serialized, rebuilt on load.
+		tile_index_t building_tiles;
+		tile_index_t tree_tiles;
+		tile_index_t bridge_tiles;
+		tile_index_t stockpile_tiles;
+
+		void rebuild_tile_indices();
+
+		// Outdoor tracking: the z of the highest roof in each x/y column (0 if it has none); -1 means the
+		// column's ABOVE_GROUND flags are unknown. Columns whose roof may have moved wait in dirty_columns.
+		std::vector<int16_t> roof_height;
+		std::vector<uint8_t> column_dirty;
+		std::vector<int> dirty_columns;
+
+		// Per-chunk counters, bumped whenever a tile's standability or exits change. Not serialized.
+		std::vector<uint32_t> walkability_version;
+
+		inline void bump_walkability(const int &x, const int &y, const int &z) {
+			walkability_version[chunk_idx(x / CHUNK_SIZE, y / CHUNK_SIZE, z / CHUNK_SIZE)] = ++walkability_epoch;
+		}
+
+		void change_type(const int &idx, const uint8_t type);
+
+		void mark_column_dirty(const int &column);
+
+		void update_column(const int &column);
+
+		void update_dirty_columns();
+
+		// Tiles whose vegetation was written since the vegetation system last asked; veg_reset means "all of them".
+		std::vector<int> veg_changes;
+		bool veg_reset = true;
+
+		void clear_vegetation(const int &idx);
+
 		void tile_recalc_all();
 
 		void tile_calculate(const int &x, const int &y, const int &z);
 
+		void tile_standability(const int &x, const int &y, const int &z);
+
 		void tile_pathing(const int &x, const int &y, const int &z);
 
+		void recalc_box(int min_x, int min_y, int min_z, int max_x, int max_y, int max_z);
+
 		void calc_render(const int &idx);
 
 		int next_tree_id = 1;
@@ -67,11 +118,71 @@ namespace region {
 
 	std::unique_ptr<region_t> current_region;
 
+	static const std::vector<int> no_tiles;
+
+	static std::vector<std::function<void(int, int, int, int, int, int)>> recalc_listeners;
+	static std::vector<std::function<void(int, int, int, int)>> outdoor_listeners;
+	static std::vector<std::function<void()>> save_listeners;
+
+	static void index_remove(tile_index_t &index, const uint32_t id, const int idx) {
+		if (id == 0) return;
+		auto finder = index.find(id);
+		if (finder == index.end()) return;
+		auto &tiles = finder->second;
+		for (std::size_t i = 0; i < tiles.size(); ++i) {
+			if (tiles[i] == idx) {
+				tiles[i] = tiles.back();
+				tiles.pop_back();
+				break;
+			}
+		}
+		if (tiles.empty()) index.erase(finder);
+	}
+
+	static void index_set(tile_index_t &index, std::vector<uint32_t> &layer, const int idx, const uint32_t id) {
+		const auto old_id = layer[idx];
+		if (old_id == id) return;
+		index_remove(index, old_id, idx);
+		layer[idx] = id;
+		if (id > 0) index[id].emplace_back(idx);
+	}
+
+	static void index_delete(tile_index_t &index, std::vector<uint32_t> &layer, const uint32_t id) {
+		auto finder = index.find(id);
+		if (finder == index.end()) return;
+		for (const auto &idx : finder->second) layer[idx] = 0;
+		index.erase(finder);
+	}
+
+	static const std::vector<int> &index_find(const tile_index_t &index, const uint32_t id) {
+		const auto finder = index.find(id);
+		return finder == index.end() ? no_tiles : finder->second;
+	}
+
+	static void index_rebuild(tile_index_t &index, const std::vector<uint32_t> &layer) {
+		index.clear();
+		for (int i = 0; i < REGION_TILES_COUNT; ++i) {
+			if (layer[i] > 0) index[layer[i]].emplace_back(i);
+		}
+	}
+
+	void region_t::rebuild_tile_indices() {
+		index_rebuild(building_tiles, building_id);
+		index_rebuild(tree_tiles, tree_id);
+		index_rebuild(bridge_tiles, bridge_id);
+		index_rebuild(stockpile_tiles, stockpile_id);
+	}
+
 	std::vector<bengine::bitset<tile_flag_type>> * get_tile_flags()
 	{
 		return &current_region->tile_flags;
 	}
 
+	uint32_t walkability_version(const int chunk)
+	{
+		return current_region->walkability_version[chunk];
+	}
+
 	std::vector<uint32_t> * get_water_level()
 	{
 		return &current_region->water_level;
@@ -136,13 +247,15 @@ namespace region {
 	}
 
 	void set_building_id(const int idx, const int id) {
-		current_region->building_id[idx] = id;
+		index_set(current_region->building_tiles, current_region->building_id, idx, id);
 	}
 
 	void delete_building(const int building_id) {
-		for (auto &bid : current_region->building_id) {
-			if (bid == building_id) bid = 0;
-		}
+		index_delete(current_region->building_tiles, current_region->building_id, building_id);
+	}
+
+	const std::vector<int> &building_tiles(const int building_id) {
+		return index_find(current_region->building_tiles, building_id);
 	}
 
     uint16_t veg_ticker(const int idx) { return current_region->tile_vegetation_ticker[idx]; }
@@ -158,7 +271,7 @@ namespace region {
 
     void set_tile_type(const int idx, const uint8_t type) {
 		if (idx < 0 || idx > REGION_TILES_COUNT) return;
-        current_region->tile_type[idx] = type;
+        current_region->change_type(idx, type);
     }
 
     void set_tile_material(const int idx, const std::size_t material) {
@@ -170,6 +283,7 @@ namespace region {
 
     void set_veg_type(const int idx, const uint8_t type) {
         current_region->tile_vegetation_type[idx] = type;
+        current_region->veg_changes.emplace_back(idx);
     }
 
     void set_veg_hp(const int idx, const uint8_t hp) {
@@ -178,10 +292,24 @@ namespace region {
 
     void set_veg_ticker(const int idx, const uint16_t ticker) {
         current_region->tile_vegetation_ticker[idx] = ticker;
+        current_region->veg_changes.emplace_back(idx);
     }
 
     void set_veg_lifecycle(const int idx, const uint8_t lifecycle) {
         current_region->tile_vegetation_lifecycle[idx] = lifecycle;
+        current_region->veg_changes.emplace_back(idx);
+    }
+
+    bool take_vegetation_changes(std::vector<int> &changed) {
+        changed.clear();
+        changed.swap(current_region->veg_changes);
+        const auto reset = current_region->veg_reset;
+        current_region->veg_reset = false;
+        return reset;
+    }
+
+    void on_outdoor_changed(const std::function<void(int, int, int, int)> &func) {
+        outdoor_listeners.emplace_back(func);
     }
 
     void set_water_level(const int idx, const uint32_t level) {
@@ -190,7 +318,7 @@ namespace region {
     }
 
     void set_tree_id(const int idx, const int tree_id) {
-        current_region->tree_id[idx] = tree_id;
+        index_set(current_region->tree_tiles, current_region->tree_id, idx, tree_id);
     }
 
     void inc_next_tree() {
@@ -225,29 +353,39 @@ namespace region {
     }
 
     void set_bridge_id(const int idx, const std::size_t id) {
-        current_region->bridge_id[idx] = id;
+        index_set(current_region->bridge_tiles, current_region->bridge_id, idx, static_cast<uint32_t>(id));
     }
 
     void set_stockpile_id(const int idx, const std::size_t id) {
-        current_region->stockpile_id[idx] = id;
+        index_set(current_region->stockpile_tiles, current_region->stockpile_id, idx, static_cast<uint32_t>(id));
     }
 
     void delete_bridge(const std::size_t bridge_id) {
-        for (auto &bid : current_region->bridge_id) {
-            if (bid == bridge_id) bid = 0;
-        }
+        index_delete(current_region->bridge_tiles, current_region->bridge_id, static_cast<uint32_t>(bridge_id));
     }
 
     void delete_stockpile(const std::size_t stockpile_id) {
-        for (auto &sid : current_region->stockpile_id) {
-            if (sid == stockpile_id) sid = 0;
-        }
+        index_delete(current_region->stockpile_tiles, current_region->stockpile_id, static_cast<uint32_t>(stockpile_id));
     }
 
     void delete_tree(const int tree_id) {
-        for (auto &sid : current_region->tree_id) {
-            if (sid == tree_id) sid = 0;
-        }
+        index_delete(current_region->tree_tiles, current_region->tree_id, tree_id);
+    }
+
+    const std::vector<int> &bridge_tiles(const std::size_t bridge_id) {
+        return index_find(current_region->bridge_tiles, static_cast<uint32_t>(bridge_id));
+    }
+
+    const std::vector<int> &stockpile_tiles(const std::size_t stockpile_id) {
+        return index_find(current_region->stockpile_tiles, static_cast<uint32_t>(stockpile_id));
+    }
+
+    void each_stockpile(const std::function<void(std::size_t, const std::vector<int> &)> &func) {
+        for (const auto &sp : current_region->stockpile_tiles) func(sp.first, sp.second);
+    }
+
+    const std::vector<int> &tree_tiles(const int tree_id) {
+        return index_find(current_region->tree_tiles, tree_id);
     }
 
     void set_tile(const int idx, const uint8_t type, const bool solid, const bool opaque,
@@ -269,7 +407,7 @@ namespace region {
 			current_region->tile_flags[idx].reset(OPAQUE_TILE);
 		}
         set_tile_material(idx, material);
-        if (remove_vegetation) current_region->tile_vegetation_type[idx] = 0;
+        if (remove_vegetation) current_region->clear_vegetation(idx);
         current_region->water_level[idx] = water;
         if (construction) current_region->tile_flags[idx].set(CONSTRUCTION);
     }
@@ -314,6 +452,16 @@ namespace region {
         std::fill(current_region->water_level.begin(), current_region->water_level.end(), 0);
         std::fill(current_region->stockpile_id.begin(), current_region->stockpile_id.end(), 0);
         std::fill(current_region->bridge_id.begin(), current_region->bridge_id.end(), 0);
+        current_region->building_tiles.clear();
+        current_region->tree_tiles.clear();
+        current_region->bridge_tiles.clear();
+        current_region->stockpile_tiles.clear();
+        current_region->veg_changes.clear();
+        current_region->veg_reset = true;
+        for (int column = 0; column < REGION_WIDTH * REGION_HEIGHT; ++column) {
+            current_region->roof_height[column] = -1;
+            current_region->mark_column_dirty(column);
+        }
     }
 
     void clear_visibility() {
@@ -343,82 +491,111 @@ namespace region {
         current_region->tile_calculate(x, y, z);
     }
 
+    void recalc_box(const int min_x, const int min_y, const int min_z, const int max_x, const int max_y, const int max_z) {
+        current_region->recalc_box(min_x, min_y, min_z, max_x, max_y, max_z);
+    }
+
+    void recalc_tiles(const std::vector<int> &tiles) {
+        if (tiles.empty()) return;
+
+        int min_x = REGION_WIDTH, min_y = REGION_HEIGHT, min_z = REGION_DEPTH;
+        int max_x = 0, max_y = 0, max_z = 0;
+        for (const auto &idx : tiles) {
+            const auto &[x, y, z] = idxmap(idx);
+            min_x = std::min(min_x, x); max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y); max_y = std::max(max_y, y);
+            min_z = std::min(min_z, z); max_z = std::max(max_z, z);
+        }
+        current_region->recalc_box(min_x, min_y, min_z, max_x, max_y, max_z);
+    }
+
+    void on_tiles_recalculated(const std::function<void(int, int, int, int, int, int)> &func) {
+        recalc_listeners.emplace_back(func);
+    }
+
     void make_open_space(const int idx) {
-        current_region->tile_type[idx] = tile_type::OPEN_SPACE;
+        current_region->change_type(idx, tile_type::OPEN_SPACE);
 		current_region->tile_flags[idx].reset(SOLID);
 		current_region->tile_flags[idx].reset(OPAQUE_TILE);
         current_region->tile_flags[idx].reset(CAN_STAND_HERE);
         current_region->tile_flags[idx].reset(CONSTRUCTION);
-        current_region->tile_vegetation_type[idx] = 0;
+        current_region->clear_vegetation(idx);
 		mark_chunk_dirty_by_tileidx(idx);
     }
 
     void make_floor(const int idx, const std::size_t mat) {
-        current_region->tile_type[idx] = tile_type::FLOOR;
+        current_region->change_type(idx, tile_type::FLOOR);
 		current_region->tile_flags[idx].reset(SOLID);
 		current_region->tile_flags[idx].reset(OPAQUE_TILE);
         current_region->tile_flags[idx].set(CAN_STAND_HERE);
-        current_region->tile_vegetation_type[idx] = 0;
+        current_region->clear_vegetation(idx);
 		if (mat > 0) set_tile_material(idx, mat);
 		mark_chunk_dirty_by_tileidx(idx);
     }
 
     void make_ramp(const int idx, const std::size_t mat) {
-        current_region->tile_type[idx] = tile_type::RAMP;
+        current_region->change_type(idx, tile_type::RAMP);
 		current_region->tile_flags[idx].reset(SOLID);
 		current_region->tile_flags[idx].reset(OPAQUE_TILE);
         current_region->tile_flags[idx].set(CAN_STAND_HERE);
-        current_region->tile_vegetation_type[idx] = 0;
+        current_region->clear_vegetation(idx);
 		if (mat > 0) set_tile_material(idx, mat);
 		mark_chunk_dirty_by_tileidx(idx);
     }
 
     void make_stairs_up(const int idx, const std::size_t mat) {
-        current_region->tile_type[idx] = tile_type::STAIRS_UP;
+        current_region->change_type(idx, tile_type::STAIRS_UP);
 		current_region->tile_flags[idx].reset(SOLID);
 		current_region->tile_flags[idx].reset(OPAQUE_TILE);
         current_region->tile_flags[idx].set(CAN_STAND_HERE);
-        current_region->tile_vegetation_type[idx] = 0;
+        current_region->clear_vegetation(idx);
 		if (mat > 0) set_tile_material(idx, mat);
 		mark_chunk_dirty_by_tileidx(idx);
     }
 
     void make_stairs_down(const int idx, const std::size_t mat) {
-        current_region->tile_type[idx] = tile_type::STAIRS_DOWN;
+        current_region->change_type(idx, tile_type::STAIRS_DOWN);
 		current_region->tile_flags[idx].reset(SOLID);
 		current_region->tile_flags[idx].reset(OPAQUE_TILE);
         current_region->tile_flags[idx].set(CAN_STAND_HERE);
-        current_region->tile_vegetation_type[idx] = 0;
+        current_region->clear_vegetation(idx);
 		if (mat > 0) set_tile_material(idx, mat);
 		mark_chunk_dirty_by_tileidx(idx);
     }
 
     void make_stairs_updown(const int idx, const std::size_t mat) {
-        current_region->tile_type[idx] = tile_type::STAIRS_UPDOWN;
+        current_region->change_type(idx, tile_type::STAIRS_UPDOWN);
 		current_region->tile_flags[idx].reset(SOLID);
 		current_region->tile_flags[idx].reset(OPAQUE_TILE);
         current_region->tile_flags[idx].set(CAN_STAND_HERE);
-        current_region->tile_vegetation_type[idx] = 0;
+        current_region->clear_vegetation(idx);
 		if (mat > 0) set_tile_material(idx, mat);
 		mark_chunk_dirty_by_tileidx(idx);
     }
 
     void make_wall(const int idx, const std::size_t mat) {
-        current_region->tile_type[idx] = tile_type::WALL;
+        current_region->change_type(idx, tile_type::WALL);
 		current_region->tile_flags[idx].reset(SOLID);
 		current_region->tile_flags[idx].reset(OPAQUE_TILE);
         current_region->tile_flags[idx].reset(CAN_STAND_HERE);
         current_region->tile_flags[idx].set(CONSTRUCTION);
-        current_region->tile_vegetation_type[idx] = 0;
+        current_region->clear_vegetation(idx);
         set_tile_material(idx, mat);
 		mark_chunk_dirty_by_tileidx(idx);
     }
 
 	void update_outdoor_calculation() {
-		current_region->above_ground_calculation();
+		current_region->update_dirty_columns();
+	}
+
+	void on_before_save(const std::function<void()> &func) {
+		save_listeners.emplace_back(func);
 	}
 
 	void save_current_region() {
+		profiler::scope_t profile("save.region");
+		for (const auto &listener : save_listeners) listener();
+
 		const auto region_filename =
 				get_save_path() + std::string("/region_") + std::to_string(current_region->region_x) + "_" +
 				std::to_string(current_region->region_y) + ".dat";
@@ -445,6 +622,7 @@ namespace region {
 	}
 
 	void load_current_region(const int region_x, const int region_y) {
+		profiler::scope_t profile("load.region");
 		const auto region_filename =
 				get_save_path() + std::string("/region_") + std::to_string(region_x) + "_" + std::to_string(region_y) +
 				".dat";
@@ -469,6 +647,8 @@ namespace region {
 		inflate.deserialize(current_region->water_level);
 		inflate.deserialize(current_region->stockpile_id);
 		inflate.deserialize(current_region->bridge_id);
+		current_region->rebuild_tile_indices();
+		current_region->above_ground_calculation();
 
 		//std::cout << "Recalculating region paths\n";
 		current_region->tile_recalc_all();
@@ -478,7 +658,7 @@ namespace region {
 		for (int z = 0; z < REGION_DEPTH; ++z) {
 			for (int y = 0; y < REGION_HEIGHT; ++y) {
 				for (int x = 0; x < REGION_WIDTH; ++x) {
-					tile_calculate(x, y, z);
+					tile_standability(x, y, z);
 				}
 			}
 		}
@@ -489,9 +669,61 @@ namespace region {
 				}
 			}
 		}
+
+		for (const auto &listener : recalc_listeners) {
+			listener(0, 0, 0, REGION_WIDTH - 1, REGION_HEIGHT - 1, REGION_DEPTH - 1);
+		}
 	}
 
 	void region_t::tile_calculate(const int &x, const int &y, const int &z) {
+		tile_standability(x, y, z);
+		tile_pathing(x, y, z);
+	}
+
+	void region_t::recalc_box(int min_x, int min_y, int min_z, int max_x, int max_y, int max_z) {
+		min_x = std::max(0, min_x); max_x = std::min(REGION_WIDTH - 1, max_x);
+		min_y = std::max(0, min_y); max_y = std::min(REGION_HEIGHT - 1, max_y);
+		min_z = std::max(0, min_z); max_z = std::min(REGION_DEPTH - 1, max_z);
+		if (min_x > max_x || min_y > max_y || min_z > max_z) return;
+
+		// Standability depends on the tile below, so the layer above the box can change too.
+		const auto stand_max_z = std::min(REGION_DEPTH - 1, max_z + 1);
+		for (int z = min_z; z <= stand_max_z; ++z) {
+			for (int y = min_y; y <= max_y; ++y) {
+				for (int x = min_x; x <= max_x; ++x) {
+					tile_standability(x, y, z);
+				}
+			}
+		}
+
+		// Exits depend on the standability of every neighbour, so they go one tile further in each direction.
+		const auto path_min_x = std::max(0, min_x - 1), path_max_x = std::min(REGION_WIDTH - 1, max_x + 1);
+		const auto path_min_y = std::max(0, min_y - 1), path_max_y = std::min(REGION_HEIGHT - 1, max_y + 1);
+		const auto path_min_z = std::max(0, min_z - 1), path_max_z = std::min(REGION_DEPTH - 1, stand_max_z + 1);
+		for (int z = path_min_z; z <= path_max_z; ++z) {
+			for (int y = path_min_y; y <= path_max_y; ++y) {
+				for (int x = path_min_x; x <= path_max_x; ++x) {
+					tile_pathing(x, y, z);
+				}
+			}
+		}
+
+		update_dirty_columns();
+
+		for (int cz = path_min_z / CHUNK_SIZE; cz <= path_max_z / CHUNK_SIZE; ++cz) {
+			for (int cy = path_min_y / CHUNK_SIZE; cy <= path_max_y / CHUNK_SIZE; ++cy) {
+				for (int cx = path_min_x / CHUNK_SIZE; cx <= path_max_x / CHUNK_SIZE; ++cx) {
+					mark_chunk_dirty(chunk_idx(cx, cy, cz));
+				}
+			}
+		}
+
+		for (const auto &listener : recalc_listeners) {
+			listener(path_min_x, path_min_y, path_min_z, path_max_x, path_max_y, path_max_z);
+		}
+	}
+
+	void region_t::tile_standability(const int &x, const int &y, const int &z) {
 		const auto idx = mapidx(x, y, z);
 
 		// Calculate render characteristics
@@ -535,12 +767,11 @@ namespace region {
 					tile_flags[idx].set(CAN_STAND_HERE);
 			}
 		}
-
-		tile_pathing(x, y, z);
 	}
 
 	void region_t::tile_pathing(const int &x, const int &y, const int &z) {
 		const auto idx = mapidx(x, y, z);
+		const auto before = tile_flags[idx].bits;
 
 		// Start with a clean slate
 		tile_flags[idx].reset(CAN_GO_NORTH);
@@ -582,6 +813,8 @@ namespace region {
 				tile_flags[idx].set(CAN_GO_DOWN);
 			}
 		}
+
+		if (tile_flags[idx].bits != before) bump_walkability(x, y, z);
 	}
 
 	void region_t::calc_render(const int &idx) {		
@@ -607,25 +840,77 @@ namespace region {
 		//veg_render_cache_ascii[idx] = ascii_vegetation;
 	}
 
-	void region_t::above_ground_calculation() {
-		for (auto &f : tile_flags)
-		{
-			f.reset(ABOVE_GROUND);
-		}
-		for (auto y = 0; y < REGION_HEIGHT; ++y) {
-			for (auto x = 0; x < REGION_WIDTH; ++x) {
-				for (auto z = REGION_DEPTH - 1; z > 0; --z) {
-					const auto idx = mapidx(x, y, z);
-					tile_flags[idx].set(ABOVE_GROUND);
-					const auto tt = tile_type[idx];
-					const auto hit_ground = (tt == tile_type::SOLID || tt == tile_type::FLOOR || tt == tile_type::WALL);
-					if (hit_ground) goto escape_from_dive;
-				}
+	static inline bool is_roof(const uint8_t type) noexcept {
+		return type == tile_type::SOLID || type == tile_type::FLOOR || type == tile_type::WALL;
+	}
+
+	void region_t::clear_vegetation(const int &idx) {
+		if (tile_vegetation_type[idx] == 0) return;
+		tile_vegetation_type[idx] = 0;
+		veg_changes.emplace_back(idx);
+	}
+
+	void region_t::change_type(const int &idx, const uint8_t type) {
+		const auto old_type = tile_type[idx];
+		tile_type[idx] = type;
+		if (is_roof(old_type) != is_roof(type)) mark_column_dirty(idx % (REGION_WIDTH * REGION_HEIGHT));
+	}
+
+	void region_t::mark_column_dirty(const int &column) {
+		if (column_dirty[column]) return;
+		column_dirty[column] = 1;
+		dirty_columns.emplace_back(column);
+	}
+
+	void region_t::update_column(const int &column) {
+		const auto x = column % REGION_WIDTH;
+		const auto y = column / REGION_WIDTH;
 
-			escape_from_dive: {
+		int roof = 0;
+		for (int z = REGION_DEPTH - 1; z > 0; --z) {
+			if (is_roof(tile_type[mapidx(x, y, z)])) {
+				roof = z;
+				break;
+			}
+		}
 
+		// Open down to (and including) the highest roof; z 0 is never outdoors. Only the band between the
+		// old and new roofs can have changed.
+		const int old_roof = roof_height[column];
+		const auto low = old_roof < 0 ? 0 : std::min(old_roof, roof);
+		const auto high = old_roof < 0 ? REGION_DEPTH - 1 : std::max(old_roof, roof);
+		if (old_roof != roof || old_roof < 0) {
+			for (int z = low; z <= high; ++z) {
+				auto &flags = tile_flags[mapidx(x, y, z)];
+				if (z > 0 && z >= roof) {
+					flags.set(ABOVE_GROUND);
+				}
+				else {
+					flags.reset(ABOVE_GROUND);
 				}
 			}
 		}
+		roof_height[column] = static_cast<int16_t>(roof);
+
+		if (old_roof >= 0 && old_roof != roof) {
+			for (const auto &listener : outdoor_listeners) listener(x, y, low, high);
+		}
+	}
+
+	void region_t::update_dirty_columns() {
+		for (const auto &column : dirty_columns) {
+			update_column(column);
+			column_dirty[column] = 0;
+		}
+		dirty_columns.clear();
+	}
+
+	void region_t::above_ground_calculation() {
+		for (int column = 0; column < REGION_WIDTH * REGION_HEIGHT; ++column) {
+			roof_height[column] = -1;
+			update_column(column);
+			column_dirty[column] = 0;
+		}
+		dirty_columns.clear();
 	}
-}
\ No newline at end of file
+}
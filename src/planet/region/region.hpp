@@ -31,6 +31,9 @@ namespace region {
     /* Save the current region to disk. */
     void save_current_region();
 
+    /* Register a function to call at the start of every save, for systems that keep region state written back lazily. */
+    void on_before_save(const std::function<void()> &func);
+
     /* Load the current region from disk, using the specified world co-ordinates. */
     void load_current_region(const int region_x, const int region_y);
 
@@ -82,6 +85,9 @@ namespace region {
 	bengine::bitset<tile_flags::tile_flag_type> get_flag_reference(const int idx);
 	std::vector<bengine::bitset<tile_flags::tile_flag_type>> * get_tile_flags();
 
+    /* Changes whenever standability or exits change anywhere in the chunk; cached paths compare it to see if they still hold. */
+    uint32_t walkability_version(const int chunk);
+
     /* Reveal a cell. */
     void reveal(const int idx);
 
@@ -146,6 +152,10 @@ namespace region {
     /* Apply damage to a tile's vegetation. */
     void damage_vegetation(const int idx, const uint8_t damage);
 
+    /* Hands over the tiles whose vegetation type, ticker or lifecycle has been written since the last call.
+     * Returns true if the region itself was replaced or zeroed, in which case every tile may have changed. */
+    bool take_vegetation_changes(std::vector<int> &changed);
+
 	/*************************************
      * Stockpiles
      */
@@ -159,12 +169,19 @@ namespace region {
     /* Erase a stockpile by ID #. */
     void delete_stockpile(const std::size_t stockpile_id);
 
+    /* The tiles belonging to a stockpile (empty if there are none). */
+    const std::vector<int> &stockpile_tiles(const std::size_t stockpile_id);
+
+    /* For each stockpile, execute with its ID # and tiles. */
+    void each_stockpile(const std::function<void(std::size_t, const std::vector<int> &)> &func);
+
 	/*************************************
 	* Buildings
 	*/
 	std::size_t get_building_id(const int idx);
 	void set_building_id(const int idx, const int id);
 	void delete_building(const int building_id);
+	const std::vector<int> &building_tiles(const int building_id);
 
     /*************************************
      * Bridges
@@ -179,6 +196,9 @@ namespace region {
     /* Erase a bridge by ID #. */
     void delete_bridge(const std::size_t bridge_id);
 
+    /* The tiles belonging to a bridge (empty if there are none). */
+    const std::vector<int> &bridge_tiles(const std::size_t bridge_id);
+
     /* For each bridge, execute... */
     void each_bridge(const std::function<void(std::size_t)> &func);
 
@@ -198,6 +218,9 @@ namespace region {
     /* Erase a tree by ID #. */
     void delete_tree(const int tree_id);
 
+    /* The tiles belonging to a tree (empty if there are none). */
+    const std::vector<int> &tree_tiles(const int tree_id);
+
     /* Increment the tree counter. */
     void inc_next_tree();
 
@@ -210,6 +233,17 @@ namespace region {
     /* Recalculate everything about a single tile. */
     void tile_calculate(const int x, const int y, const int z);
 
+    /* Recalculate solidity, standability, exits, outdoor flags and chunk dirtiness for a box of tiles
+     * (inclusive, clamped to the region) and the neighbours that depend on them, then notify listeners. */
+    void recalc_box(const int min_x, const int min_y, const int min_z, const int max_x, const int max_y, const int max_z);
+
+    /* As recalc_box, covering the bounding box of a set of tile indices. */
+    void recalc_tiles(const std::vector<int> &tiles);
+
+    /* Register a function to call with the bounds (min x/y/z, max x/y/z) of everything each recalculation touched;
+     * tile_recalc_all reports the whole region. */
+    void on_tiles_recalculated(const std::function<void(int, int, int, int, int, int)> &func);
+
     /*************************************
      * Builders
      */
@@ -245,6 +279,9 @@ namespace region {
 
 	int ground_z(const int x, const int y);
 
-	/* Calculate outdoors */
+	/* Bring the outdoor (ABOVE_GROUND) flags up to date; only columns whose roof may have changed are revisited. */
 	void update_outdoor_calculation();
+
+	/* Register a function to call with x, y and the z range whenever part of a column moves indoors or outdoors. */
+	void on_outdoor_changed(const std::function<void(int, int, int, int)> &func);
 }
\ No newline at end of file
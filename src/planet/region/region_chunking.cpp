@@ -6,6 +6,7 @@
 #include "../../raws/defs/building_def_t.hpp"
 #include "../../global_assets/game_ecs.hpp"
 #include "../../global_assets/farming_designations.hpp"
+#include "../../utils/profiler.hpp"
 #include <array>
 #include <vector>
 #include <bitset>
@@ -307,6 +308,8 @@ namespace region {
 	}
 
 	void update_chunk(const int &chunk_idx) {
+		profiler::scope_t profile("chunks.mesh");
+
 		for (auto &layer : chunks[chunk_idx].layers) {
 			layer.cubes.clear();
 			layer.floors.clear();
@@ -409,6 +412,7 @@ namespace region {
 	}
 
 	void update_chunks() {
+		profiler::scope_t profile("chunks.update");
 		for (auto i = 0; i < CHUNKS_TOTAL; ++i) {
 			if (dirty.test(i)) update_chunk(i);
 		}
@@ -416,6 +420,7 @@ namespace region {
 	}
 
 	void update_chunks_listing_changes(std::vector<int> &dirty_list) {
+		profiler::scope_t profile("chunks.update");
 		for (auto i = 0; i < CHUNKS_TOTAL; ++i) {
 			if (dirty.test(i)) {
 				update_chunk(i);
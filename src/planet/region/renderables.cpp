@@ -5,6 +5,7 @@
 #include "../../global_assets/building_designations.hpp"
 #include "../../raws/species.hpp"
 #include "region.hpp"
+#include "view_culling.hpp"
 #include "../../global_assets/building_designations.hpp"
 #include "../../global_assets/game_building.hpp"
 #include "../../raws/buildings.hpp"
@@ -33,33 +34,30 @@ namespace render {
 		}
 	}
 
-	static void build_voxel_buildings(int selected_building, int mouse_wx, int mouse_wy, int mouse_wz) {
-		bengine::each<building_t, position_t>(
-			[](bengine::entity_t &e, building_t &b, position_t &pos) {
-			if (pos.z > camera_position->region_z - 10 && pos.z <= camera_position->region_z) {
-				if (b.vox_model > 0) {
-					//std::cout << "Found model #" << b.vox_model << "\n";
-					auto x = static_cast<float>(pos.x);
-					const auto y = static_cast<float>(pos.y);
-					auto z = static_cast<float>(pos.z);
-
-					//std::cout << b.width << " x " << b.height << "\n";
-
-					auto red = 1.0f;
-					auto green = 1.0f;
-					auto blue = 1.0f;
-
-					if (!b.complete) {
-						red = 1.0f;
-						green = 1.0f;
-						blue = 1.0f;
-					}
+	static void render_building(bengine::entity_t &e, building_t &b, position_t &pos) {
+		if (b.vox_model > 0) {
+			//std::cout << "Found model #" << b.vox_model << "\n";
+			auto x = static_cast<float>(pos.x);
+			const auto y = static_cast<float>(pos.y);
+			auto z = static_cast<float>(pos.z);
 
-					add_voxel_model(b.vox_model, e.id, x, y, z, red, green, blue, static_cast<float>(pos.rotation), 0.0f, 1.0f, 0.0f);
-				}
+			//std::cout << b.width << " x " << b.height << "\n";
+
+			auto red = 1.0f;
+			auto green = 1.0f;
+			auto blue = 1.0f;
+
+			if (!b.complete) {
+				red = 1.0f;
+				green = 1.0f;
+				blue = 1.0f;
 			}
-		});
 
+			add_voxel_model(b.vox_model, e.id, x, y, z, red, green, blue, static_cast<float>(pos.rotation), 0.0f, 1.0f, 0.0f);
+		}
+	}
+
+	static void build_design_mode_building(int selected_building, int mouse_wx, int mouse_wy, int mouse_wz) {
 		if (game_master_mode == DESIGN && game_design_mode == BUILDING && buildings::has_build_mode_building) {
 
 
@@ -108,18 +106,14 @@ namespace render {
 		}
 	}
 
-	static void build_voxel_items() {
-		bengine::each<renderable_t, position_t>([](bengine::entity_t &e, renderable_t &r, position_t &pos) {
-			if (pos.z > camera_position->region_z - 10 && pos.z <= camera_position->region_z) {
-				if (r.vox > 0) {
-					auto x = static_cast<float>(pos.x);
-					const auto y = static_cast<float>(pos.y);
-					auto z = static_cast<float>(pos.z);
+	static void render_item(bengine::entity_t &e, renderable_t &r, position_t &pos) {
+		if (r.vox > 0) {
+			auto x = static_cast<float>(pos.x);
+			const auto y = static_cast<float>(pos.y);
+			auto z = static_cast<float>(pos.z);
 
-					add_voxel_model(r.vox, e.id, x, y, z, 1.0f, 1.0f, 1.0f);
-				}
-			}
-		});
+			add_voxel_model(r.vox, e.id, x, y, z, 1.0f, 1.0f, 1.0f);
+		}
 	}
 
 	static bool is_lying_down(bengine::entity_t &e)
@@ -147,63 +141,61 @@ namespace render {
 		const auto species = e.component<species_t>();
 		if (!species) return;
 
-		if (pos.z > camera_position->region_z - 10 && pos.z <= camera_position->region_z) {
-			const auto inner_x = static_cast<float>(pos.x);
-			const auto inner_y = static_cast<float>(pos.y);
-			const auto inner_z = static_cast<float>(pos.z);
+		const auto inner_x = static_cast<float>(pos.x);
+		const auto inner_y = static_cast<float>(pos.y);
+		const auto inner_z = static_cast<float>(pos.z);
 
-			const auto is_upright = !is_lying_down(e);
+		const auto is_upright = !is_lying_down(e);
 
-			const auto rotation = is_upright ? static_cast<float>(pos.rotation) : 180.0f;
-			const auto rot1 = is_upright ? 0.0f : 1.0f;
-			const auto rot2 = is_upright ? 1.0f : 0.0f;
-			const auto rot3 = 0.0f;
-			const auto xscale = 1.0f;
-			const auto zscale = species->height_cm / 200.0f;
-			const auto yscale = 1.0f;			
+		const auto rotation = is_upright ? static_cast<float>(pos.rotation) : 180.0f;
+		const auto rot1 = is_upright ? 0.0f : 1.0f;
+		const auto rot2 = is_upright ? 1.0f : 0.0f;
+		const auto rot3 = 0.0f;
+		const auto xscale = 1.0f;
+		const auto zscale = species->height_cm / 200.0f;
+		const auto yscale = 1.0f;			
 
-			const auto cache_finder = composite_cache.find(e.id);
-			if (cache_finder != composite_cache.end())
+		const auto cache_finder = composite_cache.find(e.id);
+		if (cache_finder != composite_cache.end())
+		{
+			for (const auto &c : cache_finder->second)
 			{
-				for (const auto &c : cache_finder->second)
-				{
-					add_voxel_model(c.voxel_model, e.id, inner_x, inner_y, inner_z, c.r, c.g, c.b, rotation, rot1, rot2, rot3, xscale, yscale, zscale);
-				}
-				return;
-			}
-			std::vector<composite_cache_t> cc;
-
-			// Clip check passed - add the model
-			add_voxel_model(49, e.id, inner_x, inner_y, inner_z, species->skin_color.second.r, species->skin_color.second.g, species->skin_color.second.b, rotation, rot1, rot2, rot3, xscale, yscale, zscale);
-			cc.emplace_back(composite_cache_t{ 49, species->skin_color.second.r, species->skin_color.second.g, species->skin_color.second.b });
-
-			// Add hair
-			int hair_vox;
-			switch (species->hair_style) {
-			case SHORT_HAIR: hair_vox = 50; break;
-			case LONG_HAIR: hair_vox = 51; break;
-			case PIGTAILS: hair_vox = 52; break;
-			case MOHAWK: hair_vox = 53; break;
-			case BALDING: hair_vox = 54; break;
-			case TRIANGLE: hair_vox = 55; break;
-			default: hair_vox = 0;
-			}
-			if (hair_vox > 0) {
-				add_voxel_model(hair_vox, e.id, inner_x, inner_y, inner_z, species->hair_color.second.r, species->hair_color.second.g, species->hair_color.second.b, rotation, rot1, rot2, rot3, xscale, yscale, zscale);
-				cc.emplace_back(composite_cache_t{ hair_vox, species->hair_color.second.r, species->hair_color.second.g, species->hair_color.second.b });
+				add_voxel_model(c.voxel_model, e.id, inner_x, inner_y, inner_z, c.r, c.g, c.b, rotation, rot1, rot2, rot3, xscale, yscale, zscale);
 			}
+			return;
+		}
+		std::vector<composite_cache_t> cc;
+
+		// Clip check passed - add the model
+		add_voxel_model(49, e.id, inner_x, inner_y, inner_z, species->skin_color.second.r, species->skin_color.second.g, species->skin_color.second.b, rotation, rot1, rot2, rot3, xscale, yscale, zscale);
+		cc.emplace_back(composite_cache_t{ 49, species->skin_color.second.r, species->skin_color.second.g, species->skin_color.second.b });
+
+		// Add hair
+		int hair_vox;
+		switch (species->hair_style) {
+		case SHORT_HAIR: hair_vox = 50; break;
+		case LONG_HAIR: hair_vox = 51; break;
+		case PIGTAILS: hair_vox = 52; break;
+		case MOHAWK: hair_vox = 53; break;
+		case BALDING: hair_vox = 54; break;
+		case TRIANGLE: hair_vox = 55; break;
+		default: hair_vox = 0;
+		}
+		if (hair_vox > 0) {
+			add_voxel_model(hair_vox, e.id, inner_x, inner_y, inner_z, species->hair_color.second.r, species->hair_color.second.g, species->hair_color.second.b, rotation, rot1, rot2, rot3, xscale, yscale, zscale);
+			cc.emplace_back(composite_cache_t{ hair_vox, species->hair_color.second.r, species->hair_color.second.g, species->hair_color.second.b });
+		}
 
-			// Add items
-			using namespace bengine;
-			each<item_t, item_carried_t>([&e, &inner_x, &inner_y, &inner_z, &rotation, &rot1, &rot2, &rot3, &cc, &xscale, &yscale, &zscale](entity_t &E, item_t &item, item_carried_t &carried) {
-				if (carried.carried_by == e.id && item.clothing_layer > 0) {
-					add_voxel_model(item.clothing_layer, e.id, inner_x, inner_y, inner_z, item.clothing_color.r, item.clothing_color.g, item.clothing_color.b, rotation, rot1, rot2, rot3, xscale, yscale, zscale);
-					cc.emplace_back(composite_cache_t{ item.clothing_layer, item.clothing_color.r, item.clothing_color.g, item.clothing_color.b });
-				}
-			});
+		// Add items
+		using namespace bengine;
+		each<item_t, item_carried_t>([&e, &inner_x, &inner_y, &inner_z, &rotation, &rot1, &rot2, &rot3, &cc, &xscale, &yscale, &zscale](entity_t &E, item_t &item, item_carried_t &carried) {
+			if (carried.carried_by == e.id && item.clothing_layer > 0) {
+				add_voxel_model(item.clothing_layer, e.id, inner_x, inner_y, inner_z, item.clothing_color.r, item.clothing_color.g, item.clothing_color.b, rotation, rot1, rot2, rot3, xscale, yscale, zscale);
+				cc.emplace_back(composite_cache_t{ item.clothing_layer, item.clothing_color.r, item.clothing_color.g, item.clothing_color.b });
+			}
+		});
 
-			composite_cache.insert(std::make_pair(e.id, cc));
-		}
+		composite_cache.insert(std::make_pair(e.id, cc));
 	}
 
 	static void render_composite_sentient(bengine::entity_t &e, renderable_composite_t &r, position_t &pos) {
@@ -215,56 +207,69 @@ namespace render {
 		//}
 	}
 
-	static void build_composites() {
-		bengine::each<renderable_composite_t, position_t>([](bengine::entity_t &e, renderable_composite_t &r, position_t &pos) {
-			//std::cout << r.render_mode << "\n";
-			if (camera->following == e.id && camera->fps) return; // Do not render yourself in FPS mode
-			if (pos.z > camera_position->region_z - 10 && pos.z <= camera_position->region_z) {
-				switch (r.render_mode) {
-				case RENDER_SETTLER: render_settler(e, r, pos); break;
-				case RENDER_SENTIENT: render_composite_sentient(e, r, pos); break;
-				}
-			}
-		});
+	static void render_composite(bengine::entity_t &e, renderable_composite_t &r, position_t &pos) {
+		//std::cout << r.render_mode << "\n";
+		if (camera->following == e.id && camera->fps) return; // Do not render yourself in FPS mode
+		switch (r.render_mode) {
+		case RENDER_SETTLER: render_settler(e, r, pos); break;
+		case RENDER_SENTIENT: render_composite_sentient(e, r, pos); break;
+		}
 	}
 
-	static void build_creature_models() {
-		bengine::each<position_t, renderable_t, grazer_ai>([](bengine::entity_t &e, position_t &pos, renderable_t &r, grazer_ai &g) {
-			if (r.vox != 0) {
-				//std::cout << "Found critter " << r.vox << "\n";
-				const auto is_upright = true;
-				const auto rotation = is_upright ? static_cast<float>(pos.rotation) : 180.0f;
-				const auto rot1 = is_upright ? 0.0f : 1.0f;
-				const auto rot2 = is_upright ? 1.0f : 0.0f;
-				const auto rot3 = 0.0f;
-				add_voxel_model(r.vox, e.id, static_cast<float>(pos.x), static_cast<float>(pos.y), static_cast<float>(pos.z), 1.0f, 1.0f, 1.0f, rotation, rot1, rot2, rot3);
-			}
-		});
+	static void render_creature(bengine::entity_t &e, renderable_t &r, position_t &pos) {
+		if (r.vox != 0) {
+			//std::cout << "Found critter " << r.vox << "\n";
+			const auto is_upright = true;
+			const auto rotation = is_upright ? static_cast<float>(pos.rotation) : 180.0f;
+			const auto rot1 = is_upright ? 0.0f : 1.0f;
+			const auto rot2 = is_upright ? 1.0f : 0.0f;
+			const auto rot3 = 0.0f;
+			add_voxel_model(r.vox, e.id, static_cast<float>(pos.x), static_cast<float>(pos.y), static_cast<float>(pos.z), 1.0f, 1.0f, 1.0f, rotation, rot1, rot2, rot3);
+		}
+	}
 
-		// Render sentients who don't have a composite component
-		bengine::each_without<renderable_composite_t, position_t, sentient_ai, species_t>([](bengine::entity_t &e, position_t &pos, sentient_ai &g, species_t &species) {
-			auto def = get_species_def(species.tag);
-			if (def == nullptr) return;
+	// Render sentients who don't have a composite component
+	static void render_plain_sentient(bengine::entity_t &e, species_t &species, position_t &pos) {
+		auto def = get_species_def(species.tag);
+		if (def == nullptr) return;
 
-			if (def->voxel_model != 0) {
-				//std::cout << "Found critter " << r.vox << "\n";
-				const auto is_upright = true;
-				const auto rotation = is_upright ? static_cast<float>(pos.rotation) : 180.0f;
-				const auto rot1 = is_upright ? 0.0f : 1.0f;
-				const auto rot2 = is_upright ? 1.0f : 0.0f;
-				const auto rot3 = 0.0f;
+		if (def->voxel_model != 0) {
+			//std::cout << "Found critter " << r.vox << "\n";
+			const auto is_upright = true;
+			const auto rotation = is_upright ? static_cast<float>(pos.rotation) : 180.0f;
+			const auto rot1 = is_upright ? 0.0f : 1.0f;
+			const auto rot2 = is_upright ? 1.0f : 0.0f;
+			const auto rot3 = 0.0f;
 
-				add_voxel_model(def->voxel_model, e.id, static_cast<float>(pos.x), static_cast<float>(pos.y), static_cast<float>(pos.z), 1.0f, 1.0f, 1.0f, rotation, rot1, rot2, rot3);
-			}
-		});
+			add_voxel_model(def->voxel_model, e.id, static_cast<float>(pos.x), static_cast<float>(pos.y), static_cast<float>(pos.z), 1.0f, 1.0f, 1.0f, rotation, rot1, rot2, rot3);
+		}
 	}
 
 	void build_voxel_list(int selected_building, int mouse_x, int mouse_y, int mouse_z) {
 		models_to_render.clear();
-		build_voxel_buildings(selected_building, mouse_x, mouse_y, mouse_z);
-		build_voxel_items();
-		build_composites();
-		build_creature_models();
+
+		// One pass over the entities bucketed into visible chunks, rather than one pass over the ECS per model type.
+		each_entity_in_view([](bengine::entity_t &e, position_t &pos) {
+			const auto building = e.component<building_t>();
+			if (building) render_building(e, *building, pos);
+
+			const auto renderable = e.component<renderable_t>();
+			if (renderable) {
+				render_item(e, *renderable, pos);
+				if (e.component<grazer_ai>()) render_creature(e, *renderable, pos);
+			}
+
+			const auto composite = e.component<renderable_composite_t>();
+			if (composite) {
+				render_composite(e, *composite, pos);
+			}
+			else if (e.component<sentient_ai>()) {
+				const auto species = e.component<species_t>();
+				if (species) render_plain_sentient(e, *species, pos);
+			}
+		});
+
+		build_design_mode_building(selected_building, mouse_x, mouse_y, mouse_z);
 	}
 
 	void get_model_list(std::vector<nf::dynamic_model_t> &models) {
@@ -0,0 +1,97 @@
+#include "view_culling.hpp"
+#include "../../global_assets/game_ecs.hpp"
+#include "../../global_assets/game_camera.hpp"
+#include "../../noxconsts.h"
+#include <array>
+#include <algorithm>
+
+using namespace nf;
+
+namespace render {
+	static bool has_view_box = false;
+	static view_box_t host_view_box{ 0, 0, 0, 0, 0, 0 };
+
+	static std::array<std::vector<int>, CHUNKS_TOTAL> entity_buckets;
+	static bool buckets_valid = false;
+	static int buckets_entity_counter = -1;
+
+	void set_view_box(const view_box_t &box) {
+		host_view_box = view_box_t{
+			std::max(0, std::min(box.min_x, box.max_x)), std::max(0, std::min(box.min_y, box.max_y)), std::max(0, std::min(box.min_z, box.max_z)),
+			std::min(REGION_WIDTH - 1, std::max(box.min_x, box.max_x)), std::min(REGION_HEIGHT - 1, std::max(box.min_y, box.max_y)), std::min(REGION_DEPTH - 1, std::max(box.min_z, box.max_z))
+		};
+		has_view_box = true;
+	}
+
+	void clear_view_box() {
+		has_view_box = false;
+	}
+
+	view_box_t get_view_box() {
+		if (has_view_box) return host_view_box;
+
+		// No host-supplied box: fall back to the traditional "ten levels below the camera" slice.
+		return view_box_t{ 0, 0, std::max(0, camera_position->region_z - 9), REGION_WIDTH - 1, REGION_HEIGHT - 1, camera_position->region_z };
+	}
+
+	bool in_view(const int &x, const int &y, const int &z) {
+		return in_view(x, y, z, 0);
+	}
+
+	bool in_view(const int &x, const int &y, const int &z, const int &margin) {
+		const auto box = get_view_box();
+		return x >= box.min_x - margin && x <= box.max_x + margin
+			&& y >= box.min_y - margin && y <= box.max_y + margin
+			&& z >= box.min_z - margin && z <= box.max_z + margin;
+	}
+
+	static void for_chunks_in_box(const view_box_t &box, const std::function<void(int)> &func) {
+		for (int cz = box.min_z / CHUNK_SIZE; cz <= box.max_z / CHUNK_SIZE; ++cz) {
+			for (int cy = box.min_y / CHUNK_SIZE; cy <= box.max_y / CHUNK_SIZE; ++cy) {
+				for (int cx = box.min_x / CHUNK_SIZE; cx <= box.max_x / CHUNK_SIZE; ++cx) {
+					func(chunk_idx(cx, cy, cz));
+				}
+			}
+		}
+	}
+
+	void get_visible_chunks(std::vector<int> &visible) {
+		for_chunks_in_box(get_view_box(), [&visible](int idx) {
+			visible.emplace_back(idx);
+		});
+	}
+
+	void invalidate_entity_buckets() {
+		buckets_valid = false;
+	}
+
+	static inline bool in_region(const position_t &pos) {
+		return pos.x >= 0 && pos.x < REGION_WIDTH && pos.y >= 0 && pos.y < REGION_HEIGHT && pos.z >= 0 && pos.z < REGION_DEPTH;
+	}
+
+	static void rebuild_entity_buckets() {
+		for (auto &bucket : entity_buckets) bucket.clear();
+		bengine::each<position_t>([](bengine::entity_t &e, position_t &pos) {
+			if (!in_region(pos)) return;
+			entity_buckets[chunk_idx(pos.x / CHUNK_SIZE, pos.y / CHUNK_SIZE, pos.z / CHUNK_SIZE)].emplace_back(e.id);
+		});
+		buckets_valid = true;
+		buckets_entity_counter = bengine::impl::ecs.entity_counter;
+	}
+
+	void each_entity_in_view(const std::function<void(bengine::entity_t &, position_t &)> &func) {
+		if (!buckets_valid || buckets_entity_counter != bengine::impl::ecs.entity_counter) rebuild_entity_buckets();
+
+		const auto box = get_view_box();
+		for_chunks_in_box(box, [&box, &func](int idx) {
+			for (const auto &id : entity_buckets[idx]) {
+				auto e = bengine::entity(id);
+				if (!e) continue;
+				auto pos = e->component<position_t>();
+				if (!pos) continue;
+				if (pos->x < box.min_x || pos->x > box.max_x || pos->y < box.min_y || pos->y > box.max_y || pos->z < box.min_z || pos->z > box.max_z) continue;
+				func(*e, *pos);
+			}
+		});
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../../noxtypes.h"
+#include <vector>
+#include <functional>
+
+namespace bengine {
+	class entity_t;
+}
+struct position_t;
+
+namespace render {
+	void set_view_box(const nf::view_box_t &box);
+	void clear_view_box();
+	nf::view_box_t get_view_box();
+	bool in_view(const int &x, const int &y, const int &z);
+	bool in_view(const int &x, const int &y, const int &z, const int &margin);
+	void get_visible_chunks(std::vector<int> &visible);
+
+	/*
+	 * Entities are bucketed by chunk; the buckets are rebuilt lazily on the next query after being invalidated
+	 * (and whenever new entities have been created).
+	 */
+	void invalidate_entity_buckets();
+	void each_entity_in_view(const std::function<void(bengine::entity_t &, position_t &)> &func);
+}
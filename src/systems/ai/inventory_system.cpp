@@ -1,6 +1,6 @@
 #include "inventory_system.hpp"
 #include "../../global_assets/game_ecs.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../../global_assets/spatial_db.hpp"
 #include "../../global_assets/game_building.hpp"
 #include "../helpers/inventory_assistant.hpp"
@@ -58,12 +58,12 @@ namespace systems {
 			build_request_message(const int new_x, const int new_y, const int new_z, const buildings::available_building_t &build) : x(new_x), y(new_y), z(new_z), building(build) {}
 		};
 
-		thread_safe_message_queue<inventory_changed_message> inventory_changes;
-		thread_safe_message_queue<drop_item_message> dropped_items;
-		thread_safe_message_queue<item_claimed_message> claimed_items;
-		thread_safe_message_queue<pickup_item_message> pickup_items;
-		thread_safe_message_queue<destroy_item_message> destroy_items;
-		thread_safe_message_queue<build_request_message> building_requests;
+		mpsc_message_queue<inventory_changed_message> inventory_changes;
+		mpsc_message_queue<drop_item_message> dropped_items;
+		mpsc_message_queue<item_claimed_message> claimed_items;
+		mpsc_message_queue<pickup_item_message> pickup_items;
+		mpsc_message_queue<destroy_item_message> destroy_items;
+		mpsc_message_queue<build_request_message> building_requests;
 
 		bool dirty = true;
 
@@ -21,7 +21,7 @@ namespace systems {
 		void run(const double &duration_ms) {
 			each<settler_ai_t, ai_tag_leisure_shift_t, position_t>([](entity_t &e, settler_ai_t &ai, ai_tag_leisure_shift_t &leisure, position_t &pos) {
 				// Do we already have a leisure job? If so, then return to doing it!
-				if (is_working_on_leisure(e)) return;
+				if (is_working_on_leisure(e, ai)) return;
 
 				// Build a job candidates list, goal is to pick the easiest job to complete.
 				auto available_jobs = jobs_board::idle_evaluations(e, pos);
@@ -21,7 +21,7 @@ namespace systems {
 				delete_component<ai_tag_work_shift_t>(e.id);
 				delete_component<ai_tag_sleep_shift_t>(e.id);
 
-				if (jobs_board::is_working(e)) return; // Don't interrupt ongoing jobs
+				if (jobs_board::is_working(e, ai)) return; // Don't interrupt ongoing jobs
 
 				auto guard = e.component<ai_tag_work_guarding>();
 				if (current_schedule != WORK_SHIFT && guard) {
@@ -29,6 +29,7 @@ namespace systems {
 						if (g.second == guard->guard_post) g.first = false;
 					}
 					delete_component<ai_tag_work_guarding>(e.id);
+					jobs_board::job_finished<ai_tag_work_guarding>(ai);
 				}
 
 				switch (current_schedule) {
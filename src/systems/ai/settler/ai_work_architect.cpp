@@ -26,6 +26,24 @@ namespace systems {
 				if (inventory::blocks_available() == 0) return; // No blocks
 				board.insert(std::make_pair(5, jt));
 			}
+
+			void list_architecture_tasks(std::vector<job_task_t> &tasks) {
+				using namespace architecture_system;
+				if (!architecture_map) return;
+
+				std::unordered_set<int> taken;
+				each<ai_tag_work_architect>([&taken](entity_t &e, ai_tag_work_architect &a) {
+					if (a.target_tile > 0) taken.insert(a.target_tile);
+				});
+				for (const auto &t : architecture_map->targets) {
+					if (taken.find(std::get<1>(t)) == taken.end()) tasks.emplace_back(job_task_t{ std::get<0>(t), std::get<1>(t) });
+				}
+			}
+
+			void assign_architecture_task(entity_t &e, const job_task_t &task) {
+				auto architect = e.component<ai_tag_work_architect>();
+				if (architect) architect->target_tile = task.id;
+			}
 		}
 
 		static const char * job_tag = "Construction";
@@ -131,7 +149,9 @@ namespace systems {
 					work.cancel_work_tag(e);
 					return;
 				}
-				const auto finder = architecture_map->find_nearest_reachable_target(pos);
+				// Head for the site we were assigned if it still needs building, otherwise the nearest
+				auto finder = a.target_tile > 0 ? architecture_map->find_path_to_target(pos, a.target_tile) : flow_maps::path_result_t{ nullptr, 0 };
+				if (finder.target == 0) finder = architecture_map->find_nearest_reachable_target(pos);
 				if (finder.target == 0)
 				{
 					// Nothing to do
@@ -235,13 +255,12 @@ namespace systems {
 					// We need to iterate through the bridge tiles and see if it is done yet.
 					const auto bid = bridge_id(bidx);
 					auto complete = true;
-					auto bridge_idx = 0;
-					each_bridge([&bridge_idx, &bid, &bidx, &complete](std::size_t id) {
-						if (id == bid && bridge_idx != bidx && architecture_designations->architecture.find(bridge_idx) != architecture_designations->architecture.end()) {
+					for (const auto &bridge_idx : bridge_tiles(bid)) {
+						if (bridge_idx != bidx && architecture_designations->architecture.find(bridge_idx) != architecture_designations->architecture.end()) {
 							complete = false;
+							break;
 						}
-						++bridge_idx;
-					});
+					}
 					if (complete) {
 						entity(bid)->component<bridge_t>()->complete = true;
 						entity(bid)->assign(receives_signal_t{});
@@ -253,15 +272,7 @@ namespace systems {
 				}
 
 				auto[cx, cy, cz] = idxmap(bidx);
-				tile_calculate(cx, cy, cz);
-				for (int Z = -2; Z<3; ++Z) {
-					for (int Y = -2; Y<3; ++Y) {
-						for (int X = -2; X<3; ++X) {
-							tile_calculate(cx + X, cy + Y, cz + Z);
-						}
-					}
-				}
-				region::mark_chunk_dirty_by_tileidx(bidx);
+				recalc_box(cx, cy, cz, cx, cy, cz);
 
 				architecture_designations->architecture.erase(bidx);
 				mining_system::mining_map_changed();
@@ -290,7 +301,7 @@ namespace systems {
 		}
 
 		void run(const double &duration_ms) {
-			work.do_work(jobs_board::evaluate_architecture, dispatch, job_tag);
+			work.do_work(jobs_board::evaluate_architecture, jobs_board::list_architecture_tasks, jobs_board::assign_architecture_task, dispatch, job_tag);
 		}
 	}
 }
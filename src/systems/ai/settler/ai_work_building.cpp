@@ -159,8 +159,9 @@ namespace systems {
 			}
 
 			if (!b.current_path) {
-				b.current_path = find_path(pos, *bpos, true); // Allow adjacent
-				if (!b.current_path->success) {
+				// The search runs off the main thread; keep coming back to this step until it's done
+				if (path_service::path_for(e.id, pos, *bpos, b.current_path, true) == path_service::PATH_PENDING) return; // Allow adjacent
+				if (!b.current_path || !b.current_path->success) {
 					// We can't get there.
 					if (b.current_tool > 0) {
 						inventory_system::drop_item(b.current_tool, pos.x, pos.y, pos.z);
@@ -110,8 +110,9 @@ namespace systems {
 
 			h.current_path.reset();
 			auto[X, Y, Z] = idxmap(plant_targets.begin()->first);
-			h.current_path = find_path(pos, position_t{ X, Y, Z });
-			if (!h.current_path->success) {
+			// The search runs off the main thread; keep coming back to this step until it's done
+			if (path_service::path_for(e.id, pos, position_t{ X, Y, Z }, h.current_path) == path_service::PATH_PENDING) return;
+			if (!h.current_path || !h.current_path->success) {
 				work.cancel_work_tag(e);
 				return;
 			}
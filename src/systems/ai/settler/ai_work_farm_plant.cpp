@@ -96,8 +96,14 @@ namespace systems {
 			}
 
 			h.current_path.reset();
-			h.current_path = find_path(pos, *inventory::get_item_location(h.seed_id));
-			if (!h.current_path->success) {
+			const auto seed_pos = inventory::get_item_location(h.seed_id);
+			if (!seed_pos) {
+				work.cancel_work_tag(e);
+				return;
+			}
+			// The search runs off the main thread; keep coming back to this step until it's done
+			if (path_service::path_for(e.id, pos, *seed_pos, h.current_path) == path_service::PATH_PENDING) return;
+			if (!h.current_path || !h.current_path->success) {
 				work.cancel_work_tag(e);
 				return;
 			}
@@ -122,8 +128,9 @@ namespace systems {
 
 		inline void find_target(entity_t &e, ai_tag_work_farm_plant &h, ai_tag_my_turn_t &t, position_t &pos) {
 			h.current_path.reset();
-			h.current_path = find_path(pos, h.farm_position);
-			if (!h.current_path->success) {
+			// The search runs off the main thread; keep coming back to this step until it's done
+			if (path_service::path_for(e.id, pos, h.farm_position, h.current_path) == path_service::PATH_PENDING) return;
+			if (!h.current_path || !h.current_path->success) {
 				work.cancel_work_tag(e);
 				return;
 			}
@@ -74,8 +74,9 @@ namespace systems {
 			}
 
 			h.current_path.reset();
-			h.current_path = find_path(pos, plant_targets.begin()->second.first);
-			if (!h.current_path->success) {
+			// The search runs off the main thread; keep coming back to this step until it's done
+			if (path_service::path_for(e.id, pos, plant_targets.begin()->second.first, h.current_path) == path_service::PATH_PENDING) return;
+			if (!h.current_path || !h.current_path->success) {
 				work.cancel_work_tag(e);
 				return;
 			}
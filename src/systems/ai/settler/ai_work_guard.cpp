@@ -17,7 +17,7 @@ namespace systems {
 				if (shooting_range(e, pos)<1) return; // No gun
 				for (const auto &g : designations->guard_points) {
 					if (!g.first) {
-						board[static_cast<int>(distance3d(pos.x, pos.y, pos.z, g.second.x, g.second.y, g.second.z))] = jt;
+						board.insert(std::make_pair(static_cast<int>(distance3d(pos.x, pos.y, pos.z, g.second.x, g.second.y, g.second.z)), jt));
 					}
 				}
 			}
@@ -70,8 +70,8 @@ namespace systems {
 
 					if (!g.current_path) {
 						// Determine a path - bail out if none
-						g.current_path = find_path(pos, g.guard_post);
-						if (!g.current_path->success) {
+						if (path_service::path_for(e.id, pos, g.guard_post, g.current_path) == path_service::PATH_PENDING) return;
+						if (!g.current_path || !g.current_path->success) {
 							work.cancel_work_tag(e);
 							for (auto &gp : designations->guard_points) {
 								if (gp.second == g.guard_post) gp.first = false;
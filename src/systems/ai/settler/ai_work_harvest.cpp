@@ -30,6 +30,22 @@ namespace systems {
 
 				board.insert(std::make_pair((int)bengine::distance3d(pos.x, pos.y, pos.z, farm_designations->harvest.begin()->second.x, farm_designations->harvest.begin()->second.y, farm_designations->harvest.begin()->second.z), jt));
 			}
+
+			void list_harvest_tasks(std::vector<job_task_t> &tasks) {
+				std::unordered_set<int> taken;
+				each<ai_tag_work_harvest>([&taken](entity_t &e, ai_tag_work_harvest &h) {
+					if (h.target_tile > 0) taken.insert(h.target_tile);
+				});
+				for (const auto &ht : farm_designations->harvest) {
+					const auto idx = mapidx(ht.second);
+					if (taken.find(idx) == taken.end()) tasks.emplace_back(job_task_t{ idx, idx });
+				}
+			}
+
+			void assign_harvest_task(entity_t &e, const job_task_t &task) {
+				auto harvester = e.component<ai_tag_work_harvest>();
+				if (harvester) harvester->target_tile = task.id;
+			}
 		}
 
 		static const char * job_tag = "Farm - Harvest";
@@ -43,6 +59,21 @@ namespace systems {
 		}
 
 		inline void find_harvest(entity_t &e, ai_tag_work_harvest &h, ai_tag_my_turn_t &t, position_t &pos) {
+			// Head for the tile we were assigned if it still wants harvesting
+			if (h.target_tile > 0) {
+				const auto target = h.target_tile;
+				const auto wanted = std::find_if(farm_designations->harvest.begin(), farm_designations->harvest.end(),
+					[&target](const std::pair<bool, position_t> &p) { return mapidx(p.second) == target; });
+				if (wanted != farm_designations->harvest.end()) {
+					h.current_path = find_path(pos, wanted->second);
+					if (h.current_path->success) {
+						h.step = ai_tag_work_harvest::harvest_steps::GOTO_HARVEST;
+						return;
+					}
+				}
+				h.target_tile = 0;
+			}
+
 			std::map<int, position_t> harvest_targets;
 			for (const auto ht : farm_designations->harvest) {
 				const float distance = bengine::distance3d(pos.x, pos.y, pos.z, ht.second.x, ht.second.y, ht.second.z);
@@ -58,6 +89,7 @@ namespace systems {
 					if (iterator == harvest_targets.end()) done = true;
 				}
 				else {
+					h.target_tile = mapidx(iterator->second);
 					h.step = ai_tag_work_harvest::harvest_steps::GOTO_HARVEST;
 					return;
 				}
@@ -157,7 +189,7 @@ namespace systems {
 		}
 
 		void run(const double &duration_ms) {
-			work.do_work(jobs_board::evaluate_harvest, dispatch, job_tag);
+			work.do_work(jobs_board::evaluate_harvest, jobs_board::list_harvest_tasks, jobs_board::assign_harvest_task, dispatch, job_tag);
 		}
 	}
 }
@@ -51,8 +51,9 @@ namespace systems {
 							work.cancel_work_tag(e);
 							return;
 						}
-						l.current_path = find_path(pos, *lpos);
-						if (!l.current_path->success)
+						// The search runs off the main thread; the lever stays on the list until it's done
+						if (path_service::path_for(e.id, pos, *lpos, l.current_path) == path_service::PATH_PENDING) return;
+						if (!l.current_path || !l.current_path->success)
 						{
 							work.cancel_work_tag(e);
 							return;
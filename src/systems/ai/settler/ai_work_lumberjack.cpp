@@ -191,27 +191,20 @@ namespace systems {
 				int number_of_logs = 0;
 				int tree_idx = 0;
 				int lowest_z = 1000;
-				for (int z = 0; z<REGION_DEPTH; ++z) {
-					for (int y = 0; y<REGION_HEIGHT; ++y) {
-						for (int x = 0; x<REGION_WIDTH; ++x) {
-							const auto idx = mapidx(x, y, z);
-							if (tree_id(idx) == lj.target_tree) {
-								if (z < lowest_z) {
-									lowest_z = z;
-									tree_idx = idx;
-								}
-
-								make_open_space(idx);
-								tile_calculate(x, y, z);
-								++number_of_logs;
-								//particles::block_destruction_effect(x, y, z, 0.0f, 1.0f, 0.0f, particles::PARTICLE_LUMBERJACK);
-								region::mark_chunk_dirty_by_tileidx(mapidx(x, y, z));
-							}
-						}
+				const auto felled = tree_tiles(lj.target_tree);
+				for (const auto &idx : felled) {
+					const auto &[x, y, z] = idxmap(idx);
+					if (z < lowest_z || (z == lowest_z && idx < tree_idx)) {
+						lowest_z = z;
+						tree_idx = idx;
 					}
+
+					make_open_space(idx);
+					++number_of_logs;
+					//particles::block_destruction_effect(x, y, z, 0.0f, 1.0f, 0.0f, particles::PARTICLE_LUMBERJACK);
 				}
+				delete_tree(lj.target_tree);
 				make_floor(tree_idx);
-				tile_calculate(lj.target_x, lj.target_y, lj.target_z);
 				auto[tx, ty, tz] = idxmap(tree_idx);
 
 				// Spawn wooden logs
@@ -225,14 +218,7 @@ namespace systems {
 				}
 
 				// Update pathing
-				for (int Z = -2; Z<10; ++Z) {
-					for (int Y = -10; Y<10; ++Y) {
-						for (int X = -10; X<10; ++X) {
-							tile_calculate(pos.x + X, pos.y + Y, pos.z + Z);
-							//tile_calculate(pos.x + X, pos.y + Y, pos.z + Z);
-						}
-					}
-				}
+				recalc_tiles(felled);
 				distance_map::refresh_all_distance_maps();
 
 				// Remove the tree from the designations list
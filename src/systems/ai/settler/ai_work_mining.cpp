@@ -22,6 +22,23 @@ namespace systems {
 
 				board.insert(std::make_pair(10, jt));
 			}
+
+			void list_mining_tasks(std::vector<job_task_t> &tasks) {
+				if (!mining_map) return;
+
+				std::unordered_set<int> taken;
+				each<ai_tag_work_miner>([&taken](entity_t &e, ai_tag_work_miner &m) {
+					if (m.target_tile > 0) taken.insert(m.target_tile);
+				});
+				for (const auto &t : mining_map->targets) {
+					if (taken.find(std::get<1>(t)) == taken.end()) tasks.emplace_back(job_task_t{ std::get<0>(t), std::get<1>(t) });
+				}
+			}
+
+			void assign_mining_task(entity_t &e, const job_task_t &task) {
+				auto miner = e.component<ai_tag_work_miner>();
+				if (miner) miner->target_tile = task.id;
+			}
 		}
 
 		static const char * job_tag = "Mining";		
@@ -72,8 +89,9 @@ namespace systems {
 				});
 			} else
 			{
-				// Find one
-				const auto mine_search = mining_map->find_nearest_reachable_target(pos);
+				// Find one, heading for the target we were assigned if it's still there
+				auto mine_search = m.target_tile > 0 ? mining_map->find_path_to_target(pos, m.target_tile) : flow_maps::path_result_t{ nullptr, 0 };
+				if (mine_search.target == 0) mine_search = mining_map->find_nearest_reachable_target(pos);
 				if (mine_search.target == 0)
 				{
 					// There is no available path.
@@ -121,7 +139,7 @@ namespace systems {
 		}
 
 		void run(const double &duration_ms) {
-			work.do_work(jobs_board::evaluate_mining, dispatch, job_tag);
+			work.do_work(jobs_board::evaluate_mining, jobs_board::list_mining_tasks, jobs_board::assign_mining_task, dispatch, job_tag);
 		}
 	}
 }
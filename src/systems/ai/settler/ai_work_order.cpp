@@ -99,7 +99,7 @@ namespace systems {
 					auto reactor_pos = entity(w.reaction_target.building_id)->component<position_t>();
 					if (w.reaction_target.components.empty() && !(pos == *reactor_pos)) {
 						w.step = ai_tag_work_order::work_steps::GO_TO_WORKSHOP;
-						w.current_path = find_path(pos, position_t{ reactor_pos->x, reactor_pos->y, reactor_pos->z });
+						w.current_path.reset();
 						return;
 					}
 
@@ -174,11 +174,16 @@ namespace systems {
 						}
 						return;
 					}
-					const auto reactor_pos = reactor_e->component<position_t>();
-					w.current_path = find_path(pos, position_t{ reactor_pos->x, reactor_pos->y, reactor_pos->z });
+					w.current_path.reset();
 					return;
 				}
 				else if (w.step == ai_tag_work_order::work_steps::GO_TO_WORKSHOP) {
+					if (!w.current_path) {
+						// The search runs off the main thread; keep coming back to this step until it's done
+						const auto reactor_e = entity(w.reaction_target.building_id);
+						const auto reactor_pos = reactor_e ? reactor_e->component<position_t>() : nullptr;
+						if (reactor_pos && path_service::path_for(e.id, pos, *reactor_pos, w.current_path) == path_service::PATH_PENDING) return;
+					}
 					work.follow_path(w, pos, e, [&w, &e, &pos, &work]() {
 						// Cancel
 						unclaim_by_id(w.current_tool);
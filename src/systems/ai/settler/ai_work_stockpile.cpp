@@ -13,6 +13,27 @@ namespace systems {
 				if (stockpile_system::storable_items.empty()) return;
 				board.insert(std::make_pair(30, jt));
 			}
+
+			void list_hauling_tasks(std::vector<job_task_t> &tasks) {
+				// Items already picked out, but not yet claimed from the list
+				std::unordered_set<std::size_t> taken;
+				each<ai_tag_work_stockpiles_t>([&taken](entity_t &e, ai_tag_work_stockpiles_t &h) {
+					if (h.step == ai_tag_work_stockpiles_t::FIND_ITEM && h.tool_id > 0) taken.insert(h.tool_id);
+				});
+
+				for (const auto &sp : stockpile_system::storable_items) {
+					if (sp.deleteme || taken.find(static_cast<std::size_t>(sp.item_id)) != taken.end()) continue;
+					const auto stockpile = stockpile_system::stockpiles.find(sp.dest_tile);
+					if (stockpile == stockpile_system::stockpiles.end() || stockpile->second.free_capacity < 1) continue;
+					const auto loc = inventory::get_item_location(sp.item_id);
+					if (loc) tasks.emplace_back(job_task_t{ mapidx(*loc), sp.item_id });
+				}
+			}
+
+			void assign_hauling_task(entity_t &e, const job_task_t &task) {
+				auto hauler = e.component<ai_tag_work_stockpiles_t>();
+				if (hauler) hauler->tool_id = task.id;
+			}
 		}
 
 		static const char * job_tag = "Stockpile Maintenance";
@@ -20,25 +41,35 @@ namespace systems {
 
 
 		inline void find_item(entity_t &e, ai_tag_work_stockpiles_t &h, ai_tag_my_turn_t &t, position_t &pos) {
-			for (auto &sp : stockpile_system::storable_items)
-			{
-				if (!sp.deleteme) {
-					const auto loc = inventory::get_item_location(sp.item_id);
-					h.current_path = find_path(pos, *loc);
-					if (h.current_path->success)
-					{
-						h.tool_id = sp.item_id;
-						const auto stockpile_id = sp.dest_tile;
-						if (stockpile_system::stockpiles[stockpile_id].free_capacity > 0) {
-							--stockpile_system::stockpiles[stockpile_id].free_capacity;
-							h.destination = *stockpile_system::stockpiles[stockpile_id].open_tiles.begin();
-							stockpile_system::stockpiles[stockpile_id].open_tiles.erase(h.destination);
-							h.step = ai_tag_work_stockpiles_t::GOTO_ITEM;
-							sp.deleteme = true;
-							goto cleanup;
-						}
+			auto try_item = [&h, &pos](stockpile_system::storable_item_t &sp) {
+				if (sp.deleteme) return false;
+				const auto loc = inventory::get_item_location(sp.item_id);
+				h.current_path = find_path(pos, *loc);
+				if (h.current_path->success)
+				{
+					h.tool_id = sp.item_id;
+					const auto stockpile_id = sp.dest_tile;
+					if (stockpile_system::stockpiles[stockpile_id].free_capacity > 0) {
+						--stockpile_system::stockpiles[stockpile_id].free_capacity;
+						h.destination = *stockpile_system::stockpiles[stockpile_id].open_tiles.begin();
+						stockpile_system::stockpiles[stockpile_id].open_tiles.erase(h.destination);
+						h.step = ai_tag_work_stockpiles_t::GOTO_ITEM;
+						sp.deleteme = true;
+						return true;
 					}
 				}
+				return false;
+			};
+
+			// The item we were assigned goes first, then anything else in list order
+			if (h.tool_id > 0) {
+				const auto assigned = std::find_if(stockpile_system::storable_items.begin(), stockpile_system::storable_items.end(),
+					[&h](const stockpile_system::storable_item_t &sp) { return static_cast<std::size_t>(sp.item_id) == h.tool_id; });
+				if (assigned != stockpile_system::storable_items.end() && try_item(*assigned)) goto cleanup;
+			}
+			for (auto &sp : stockpile_system::storable_items)
+			{
+				if (try_item(sp)) goto cleanup;
 			}
 			work.cancel_work_tag(e);
 
@@ -71,8 +102,9 @@ namespace systems {
 			if (!h.current_path)
 			{
 				auto[x, y, z] = idxmap(h.destination);
-				h.current_path = find_path(pos, position_t{ x, y, z });
-				if (!h.current_path->success)
+				// The search runs off the main thread; keep coming back to this step until it's done
+				if (path_service::path_for(e.id, pos, position_t{ x, y, z }, h.current_path) == path_service::PATH_PENDING) return;
+				if (!h.current_path || !h.current_path->success)
 				{
 					inventory_system::drop_item(h.tool_id, pos.x, pos.y, pos.z);
 					work.cancel_work_tag(e);
@@ -110,7 +142,7 @@ namespace systems {
 
 		void run(const double &duration_ms)
 		{
-			work.do_work(jobs_board::evaluate_stockpile_tidying, dispatch, job_tag);
+			work.do_work(jobs_board::evaluate_stockpile_tidying, jobs_board::list_hauling_tasks, jobs_board::assign_hauling_task, dispatch, job_tag);
 		}
 	}
 }
@@ -8,6 +8,7 @@
 #include "../distance_map_system.hpp"
 #include "../../../components/items/item.hpp"
 #include "../../../components/settler_ai.hpp"
+#include "jobs_board.hpp"
 #include "../../../components/game_stats.hpp"
 #include "../../../raws/raws.hpp"
 #include "../../../raws/items.hpp"
@@ -16,6 +17,7 @@
 #include "../../../raws/defs/item_def_t.hpp"
 #include "../../../global_assets/rng.hpp"
 #include "../../helpers/pathfinding.hpp"
+#include "../../helpers/path_service.hpp"
 #include "../../../components/items/item_stored.hpp"
 #include "../../../components/items/item_carried.hpp"
 #include "../inventory_system.hpp"
@@ -48,6 +50,7 @@ public:
 
 			// If not tagged for this work type, go idle
 			if (e.component<TAG>() == nullptr) {
+				jobs_board::job_finished<TAG>(ai);
 				e.assign(ai_mode_idle_t{});
 			}
 		});
@@ -134,6 +137,7 @@ public:
 
 	inline void cancel_work_tag(bengine::entity_t &e) {
 		bengine::delete_component<TAG>(e.id);
+		jobs_board::job_finished<TAG>(e);
 		set_status(e, "Idle");
 	}
 private:
@@ -1,6 +1,14 @@
 #include "ai_work_time.hpp"
 #include "jobs_board.hpp"
 #include "../../../global_assets/game_ecs.hpp"
+#include "../../helpers/pathfinding.hpp"
+#include "../../../bengine/geometry.hpp"
+#include "../../../utils/thread_pool.hpp"
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace systems {
 	namespace ai_work_time {
@@ -18,10 +26,118 @@ namespace systems {
 			}
 		}
 
+		/*
+		 * Everyone looking for work this tick is gathered first. Job types without a task pool are handed out
+		 * straight away, as before. Job types with one (mining, construction, harvesting, hauling) are solved as
+		 * a batch per type: every settler in the batch floods out once to get walking distances to the open tasks,
+		 * then the cheapest settler/task pairs are taken first, each settler and each task at most once. Two
+		 * settlers no longer set off for the same far-off task while a near one waits, and settlers a pool can't
+		 * place go on to the next job on their board.
+		 */
+		struct job_seeker_t {
+			int entity_id;
+			position_t pos;
+			job_board_t board;
+			job_board_t::iterator choice; // The job type currently being tried
+		};
+
+		struct task_cost_t {
+			int cost;
+			int seeker; // Index into the batch
+			int task;	// Index into the task list
+
+			bool operator<(const task_cost_t &rhs) const noexcept {
+				return std::tie(cost, seeker, task) < std::tie(rhs.cost, rhs.seeker, rhs.task);
+			}
+		};
+
+		// Tasks beyond the flood's search limit are costed by straight line, behind everything it did reach
+		constexpr int UNREACHED_COST = 100000;
+
+		static std::vector<job_seeker_t> seekers;
+
+		static void hand_out(job_seeker_t &seeker, job_evaluator_base_t * job, const job_task_t * task) {
+			auto e = entity(seeker.entity_id);
+			if (!e) return;
+
+			delete_component<ai_tag_work_shift_t>(e->id);
+			job->set_tag(*e);
+			if (task) job->assign_task(*e, *task);
+		}
+
+		static void solve_batch(job_evaluator_base_t * job, const std::vector<int> &batch, std::vector<int> &unmatched) {
+			static std::vector<job_task_t> tasks;
+			tasks.clear();
+			job->list_tasks(tasks);
+			if (tasks.empty()) {
+				unmatched.insert(unmatched.end(), batch.begin(), batch.end());
+				return;
+			}
+
+			std::unordered_set<int> goals;
+			std::unordered_map<int, std::vector<int>> tasks_at; // Tile -> indices into tasks
+			for (std::size_t i = 0; i < tasks.size(); ++i) {
+				goals.insert(tasks[i].tile);
+				tasks_at[tasks[i].tile].emplace_back(static_cast<int>(i));
+			}
+
+			// A settler is sure of a task once it has as many distinct candidates as there are settlers in the batch
+			const auto wanted = batch.size();
+			std::vector<std::vector<task_cost_t>> costs(batch.size());
+			auto cost_seeker = [&batch, &goals, &tasks_at, &costs, &wanted](const int s) {
+				const auto &pos = seekers[batch[s]].pos;
+				auto &out = costs[s];
+				std::unordered_set<int> ids_seen;
+
+				const auto exhaustive = flood_to_goals(pos, goals, [&tasks_at, &out, &ids_seen, &wanted, &s](const int tile, const int steps) {
+					for (const auto &task : tasks_at.find(tile)->second) {
+						if (ids_seen.insert(tasks[task].id).second) out.emplace_back(task_cost_t{ steps, s, task });
+					}
+					return ids_seen.size() < wanted;
+				});
+
+				// Nothing within reach of the flood, but it gave up before running out of map
+				if (out.empty() && !exhaustive) {
+					for (std::size_t i = 0; i < tasks.size(); ++i) {
+						const auto[x, y, z] = idxmap(tasks[i].tile);
+						const auto distance = static_cast<int>(distance3d(pos.x, pos.y, pos.z, x, y, z));
+						out.emplace_back(task_cost_t{ UNREACHED_COST + distance, s, static_cast<int>(i) });
+					}
+				}
+			};
+
+			// The floods only read the map, so they can run side by side
+			if (batch.size() > 1) {
+				worker_pool().parallel_for(0, static_cast<int>(batch.size()), cost_seeker);
+			}
+			else {
+				cost_seeker(0);
+			}
+
+			std::vector<task_cost_t> pairs;
+			for (const auto &c : costs) pairs.insert(pairs.end(), c.begin(), c.end());
+			std::sort(pairs.begin(), pairs.end());
+
+			std::vector<bool> placed(batch.size(), false);
+			std::unordered_set<int> taken;
+			for (const auto &pair : pairs) {
+				if (placed[pair.seeker]) continue;
+				const auto &task = tasks[pair.task];
+				if (!taken.insert(task.id).second) continue;
+				placed[pair.seeker] = true;
+				hand_out(seekers[batch[pair.seeker]], job, &task);
+			}
+
+			for (std::size_t i = 0; i < batch.size(); ++i) {
+				if (!placed[i]) unmatched.emplace_back(batch[i]);
+			}
+		}
+
 		void run(const double &duration_ms) {
+			seekers.clear();
 			each<settler_ai_t, ai_tag_work_shift_t, position_t>([](entity_t &e, settler_ai_t &ai, ai_tag_work_shift_t &work, position_t &pos) {
 				// Do we already have a job? If so, then return to doing it!
-				if (is_working(e)) return;
+				if (is_working(e, ai)) return;
 
 				// Build a job candidates list, goal is to pick the easiest job to complete.
 				auto available_jobs = jobs_board::job_evaluations(e, pos);
@@ -31,13 +147,58 @@ namespace systems {
 					e.assign(ai_mode_idle_t{});
 					return;
 				}
-				else {
-					delete_component<ai_tag_work_shift_t>(e.id);
-				}
 
-				auto job_type = available_jobs.begin()->second;
-				job_type->set_tag(e);
+				seekers.emplace_back(job_seeker_t{ e.id, pos, std::move(available_jobs), {} });
 			});
+			if (seekers.empty()) return;
+
+			std::vector<int> waiting;
+			for (std::size_t i = 0; i < seekers.size(); ++i) {
+				seekers[i].choice = seekers[i].board.begin();
+				waiting.emplace_back(static_cast<int>(i));
+			}
+
+			// Each pass hands out plain jobs and solves one batch per task pool; whoever a pool couldn't place
+			// comes back for their next choice. A pool is only solved once per tick.
+			std::unordered_set<job_evaluator_base_t *> solved;
+			std::vector<std::pair<job_evaluator_base_t *, std::vector<int>>> batches;
+			std::vector<int> unmatched;
+			while (!waiting.empty()) {
+				batches.clear();
+				for (const auto &i : waiting) {
+					auto &seeker = seekers[i];
+					while (seeker.choice != seeker.board.end() && seeker.choice->second->has_tasks() && solved.find(seeker.choice->second) != solved.end()) {
+						++seeker.choice;
+					}
+
+					if (seeker.choice == seeker.board.end()) {
+						auto e = entity(seeker.entity_id);
+						if (e) e->assign(ai_mode_idle_t{});
+						continue;
+					}
+
+					const auto job = seeker.choice->second;
+					if (!job->has_tasks()) {
+						hand_out(seeker, job, nullptr);
+						continue;
+					}
+
+					auto batch = std::find_if(batches.begin(), batches.end(), [&job](const auto &b) { return b.first == job; });
+					if (batch == batches.end()) {
+						batches.emplace_back(std::make_pair(job, std::vector<int>{}));
+						batch = batches.end() - 1;
+					}
+					batch->second.emplace_back(i);
+				}
+
+				unmatched.clear();
+				for (const auto &batch : batches) {
+					solve_batch(batch.first, batch.second, unmatched);
+					solved.insert(batch.first);
+				}
+				for (const auto &i : unmatched) ++seekers[i].choice;
+				waiting.swap(unmatched);
+			}
 		}
 	}
 }
@@ -5,20 +5,80 @@ namespace jobs_board {
 	namespace impl {
 		std::vector<std::unique_ptr<job_evaluator_base_t>> evaluators;
 		std::vector<std::unique_ptr<job_evaluator_base_t>> idle_evaluators;
+
+		// Bumped on every registration; a settler whose job state is from another generation gets rebuilt
+		static uint32_t generation = 1;
+		static int bits_used = 0;
+
+		// Job types registered after the 64 bits ran out; these still have to be asked one by one
+		static std::vector<job_evaluator_base_t *> untracked;
+
+		void enrol(job_evaluator_base_t &job, const bool leisure) {
+			job.leisure = leisure;
+			if (bits_used < 64) {
+				job.bit = uint64_t(1) << bits_used;
+				++bits_used;
+			}
+			else {
+				job.bit = 0;
+				untracked.emplace_back(&job);
+			}
+			++generation;
+		}
+
+		static void rebuild(bengine::entity_t &e, job_state_t &state) {
+			state.work = 0;
+			state.leisure = 0;
+			for (const auto &job : evaluators) {
+				if (job->bit && job->has_tag(e)) state.work |= job->bit;
+			}
+			for (const auto &job : idle_evaluators) {
+				if (job->bit && job->has_tag(e)) state.leisure |= job->bit;
+			}
+			state.generation = generation;
+		}
+
+		static bool untracked_tag(bengine::entity_t &e, const bool leisure) {
+			for (const auto &job : untracked) {
+				if (job->leisure == leisure && job->has_tag(e)) return true;
+			}
+			return false;
+		}
 	}
 
-	bool is_working(bengine::entity_t &e) {
-		for (const auto &job : impl::evaluators) {
-			if (job->has_tag(e)) return true;
+	void job_started(bengine::entity_t &e, const job_evaluator_base_t &job) {
+		auto ai = e.component<settler_ai_t>();
+		if (!ai) return;
+
+		if (ai->job_state.generation != impl::generation) {
+			impl::rebuild(e, ai->job_state);
 		}
-		return false;
+		else if (job.leisure) {
+			ai->job_state.leisure |= job.bit;
+		}
+		else {
+			ai->job_state.work |= job.bit;
+		}
+	}
+
+	bool is_working(bengine::entity_t &e, settler_ai_t &ai) {
+		if (ai.job_state.generation != impl::generation) impl::rebuild(e, ai.job_state);
+		return ai.job_state.work != 0 || (!impl::untracked.empty() && impl::untracked_tag(e, false));
+	}
+
+	bool is_working_on_leisure(bengine::entity_t &e, settler_ai_t &ai) {
+		if (ai.job_state.generation != impl::generation) impl::rebuild(e, ai.job_state);
+		return ai.job_state.leisure != 0 || (!impl::untracked.empty() && impl::untracked_tag(e, true));
+	}
+
+	bool is_working(bengine::entity_t &e) {
+		auto ai = e.component<settler_ai_t>();
+		return ai ? is_working(e, *ai) : false;
 	}
 
 	bool is_working_on_leisure(bengine::entity_t &e) {
-		for (const auto &job : impl::idle_evaluators) {
-			if (job->has_tag(e)) return true;
-		}
-		return false;
+		auto ai = e.component<settler_ai_t>();
+		return ai ? is_working_on_leisure(e, *ai) : false;
 	}
 
 	void evaluate(job_board_t &board, bengine::entity_t &entity, position_t &pos) {
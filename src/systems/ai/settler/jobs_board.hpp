@@ -3,22 +3,49 @@
 #include <functional>
 #include "../../../components/position.hpp"
 #include "../../../bengine/ecs.hpp"
+#include "../../../components/settler_ai.hpp"
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace jobs_board {
 
 	struct job_evaluator_base_t;
 
-	using job_board_t = std::map<int, job_evaluator_base_t *>;
+	// Lowest score first; job types that tie keep the order they registered in
+	using job_board_t = std::multimap<int, job_evaluator_base_t *>;
 	using job_evaluator_t = std::function<void(job_board_t &, bengine::entity_t &, position_t &, job_evaluator_base_t *)>;
 
+	/* One open piece of work at a place, as offered to the assignment phase in ai_work_time. */
+	struct job_task_t {
+		int tile;	// Where a settler has to get to
+		int id;		// Job-specific: a mining target, a harvest tile, an item to haul...
+	};
+
+	/* Lists the open tasks nobody is working on yet. */
+	using task_list_t = std::function<void(std::vector<job_task_t> &)>;
+
+	/* Hands a task to a settler that has just been given the job's tag. */
+	using task_assign_t = std::function<void(bengine::entity_t &, const job_task_t &)>;
+
 	struct job_evaluator_base_t {
 		virtual bool has_tag(bengine::entity_t &e) = 0;
 		virtual void set_tag(bengine::entity_t &e) = 0;
 		virtual void exec(job_board_t &board, bengine::entity_t &e, position_t &pos) = 0;
+
+		// Job types with a task pool are handed out as a batch; the rest just get their tag.
+		task_list_t list_tasks;
+		task_assign_t assign_task;
+		bool has_tasks() const { return static_cast<bool>(list_tasks); }
+
+		// This job type's bit in job_state_t, handed out at registration (0 if the board ran out of bits)
+		uint64_t bit = 0;
+		bool leisure = false;
 	};
 
+	/* Records that the settler has just been given the job's tag. */
+	void job_started(bengine::entity_t &e, const job_evaluator_base_t &job);
+
 	template<typename TAG>
 	struct job_evaluator_concrete : public job_evaluator_base_t {
 		job_evaluator_concrete(job_evaluator_t func) :
@@ -36,6 +63,7 @@ namespace jobs_board {
 		// Assign the tag to the entity
 		virtual void set_tag(bengine::entity_t &e) override final {
 			e.assign(TAG{});
+			job_started(e, *this);
 		}
 
 		// Call the job function
@@ -47,11 +75,34 @@ namespace jobs_board {
 	namespace impl {
 		extern std::vector<std::unique_ptr<job_evaluator_base_t>> evaluators;
 		extern std::vector<std::unique_ptr<job_evaluator_base_t>> idle_evaluators;
+
+		// The registered evaluator for a tag type, so cancelling a tag can find its bit
+		template <typename TAG>
+		inline job_evaluator_base_t *& evaluator_for() {
+			static job_evaluator_base_t * evaluator = nullptr;
+			return evaluator;
+		}
+
+		/* Gives a newly registered job type its bit, and marks every settler's job state as needing a rebuild. */
+		void enrol(job_evaluator_base_t &job, const bool leisure);
 	}
 
 	template <typename T>
 	inline void register_job_offer(job_evaluator_t evaluator) {
 		std::unique_ptr<job_evaluator_base_t> base = std::make_unique<job_evaluator_concrete<T>>(evaluator);
+		impl::evaluator_for<T>() = base.get();
+		impl::enrol(*base, false);
+
+		impl::evaluators.emplace_back(std::move(base));
+	}
+
+	template <typename T>
+	inline void register_job_offer(job_evaluator_t evaluator, task_list_t tasks, task_assign_t assign) {
+		std::unique_ptr<job_evaluator_base_t> base = std::make_unique<job_evaluator_concrete<T>>(evaluator);
+		base->list_tasks = tasks;
+		base->assign_task = assign;
+		impl::evaluator_for<T>() = base.get();
+		impl::enrol(*base, false);
 
 		impl::evaluators.emplace_back(std::move(base));
 	}
@@ -59,10 +110,33 @@ namespace jobs_board {
 	template <typename T>
 	inline void register_idle_offer(job_evaluator_t evaluator) {
 		std::unique_ptr<job_evaluator_base_t> base = std::make_unique<job_evaluator_concrete<T>>(evaluator);
+		impl::evaluator_for<T>() = base.get();
+		impl::enrol(*base, true);
 
 		impl::idle_evaluators.emplace_back(std::move(base));
 	}
 
+	/* Clears the bit for a tag that has just been removed. Harmless for tags the board doesn't know. */
+	template <typename TAG>
+	inline void job_finished(settler_ai_t &ai) {
+		const auto job = impl::evaluator_for<TAG>();
+		if (!job) return;
+		if (job->leisure) {
+			ai.job_state.leisure &= ~job->bit;
+		}
+		else {
+			ai.job_state.work &= ~job->bit;
+		}
+	}
+
+	template <typename TAG>
+	inline void job_finished(bengine::entity_t &e) {
+		auto ai = e.component<settler_ai_t>();
+		if (ai) job_finished<TAG>(*ai);
+	}
+
+	bool is_working(bengine::entity_t &e, settler_ai_t &ai);
+	bool is_working_on_leisure(bengine::entity_t &e, settler_ai_t &ai);
 	bool is_working(bengine::entity_t &e);
 	bool is_working_on_leisure(bengine::entity_t &e);
 	void evaluate(job_board_t &board, bengine::entity_t &entity, position_t &pos);
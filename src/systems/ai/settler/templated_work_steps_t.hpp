@@ -10,6 +10,7 @@
 #include "../../../components/game_stats.hpp"
 #include "../../helpers/inventory_assistant.hpp"
 #include "../../helpers/pathfinding.hpp"
+#include "../../helpers/path_service.hpp"
 #include "../../../global_assets/rng.hpp"
 #include "../../damage/damage_system.hpp"
 #include "../../../planet/region/region.hpp"
@@ -27,14 +28,32 @@ namespace work {
 		template <typename REGISTER, typename DISPATCH>
 		void do_work(const REGISTER &&registration, const DISPATCH &dispatch, const char * new_status) 
 		{
-			using namespace bengine;
-
 			// Handle jobs board registration
 			if (first_run) {
 				jobs_board::register_job_offer<WORK_TAG>(registration);
 				first_run = false;
 			}
 
+			dispatch_work(dispatch, new_status);
+		}
+
+		/* As above, for job types that offer their work as a pool of tasks to be assigned in a batch. */
+		template <typename REGISTER, typename TASKS, typename ASSIGN, typename DISPATCH>
+		void do_work(const REGISTER &&registration, const TASKS &&tasks, const ASSIGN &&assign, const DISPATCH &dispatch, const char * new_status)
+		{
+			if (first_run) {
+				jobs_board::register_job_offer<WORK_TAG>(registration, tasks, assign);
+				first_run = false;
+			}
+
+			dispatch_work(dispatch, new_status);
+		}
+
+		template <typename DISPATCH>
+		void dispatch_work(const DISPATCH &dispatch, const char * new_status)
+		{
+			using namespace bengine;
+
 			// Perform tag dispatch
 			each<WORK_TAG, ai_tag_my_turn_t, position_t, settler_ai_t>([&new_status, &dispatch] (entity_t &e, WORK_TAG &tag, ai_tag_my_turn_t &turn, position_t &pos, settler_ai_t &ai) {
 				// It's not my turn anymore - so remove the component
@@ -48,6 +67,7 @@ namespace work {
 
 				// If not tagged for this work type, go idle
 				if (e.component<WORK_TAG>() == nullptr) {
+					jobs_board::job_finished<WORK_TAG>(ai);
 					e.assign(ai_mode_idle_t{});
 				}
 			});
@@ -62,6 +82,7 @@ namespace work {
 
 		static void cancel_work_tag(bengine::entity_t &e) {
 			bengine::delete_component<WORK_TAG>(e.id);
+			jobs_board::job_finished<WORK_TAG>(e);
 			set_status(e, "Idle");
 		}
 
@@ -169,9 +190,11 @@ namespace work {
 			work.cancel_work_tag(e);
 			return;
 		}
-		job.current_path.reset();
-		job.current_path = find_path(pos, *tool_pos);
-		if (!job.current_path->success) {
+		// The search runs off the main thread; keep coming back to this step until it's done
+		std::shared_ptr<navigation_path_t> path;
+		if (path_service::path_for(e.id, pos, *tool_pos, path) == path_service::PATH_PENDING) return;
+		job.current_path = std::move(path);
+		if (!job.current_path || !job.current_path->success) {
 			// We couldn't get there - cancel
 			work.cancel_work_tag(e);
 			return;
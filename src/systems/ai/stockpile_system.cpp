@@ -46,13 +46,11 @@ namespace systems {
 			if (!has_stockpiles) return;
 
 			// Build a free tiles list
-			for (int i = 0; i<REGION_TILES_COUNT; ++i) {
-				const int spid = stockpile_id(i);
-				if (spid > 0) {
-					++stockpiles[spid].free_capacity;
-					stockpiles[spid].open_tiles.insert(i);
-				}
-			}
+			each_stockpile([](std::size_t spid, const std::vector<int> &tiles) {
+				auto &sp = stockpiles[static_cast<int>(spid)];
+				sp.free_capacity += static_cast<int>(tiles.size());
+				sp.open_tiles.insert(tiles.begin(), tiles.end());
+			});
 
 			// Find items in stockpiles and items not in stockpiles
 			each<item_t, position_t>([](entity_t &e, item_t &i, position_t &pos) {
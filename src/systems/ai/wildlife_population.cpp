@@ -28,6 +28,56 @@ namespace systems {
 			});
 		}
 
+		static void spawn_critter(const raw_creature_t &critter_def, const int x, const int y, const int z, uint8_t group) {
+			// Critters have: appropriate AI component, wildlife_group, position, renderable, name, species, stats
+			bool male = true;
+			if (rng.roll_dice(1, 4) <= 2) male = false;
+
+			position_t pos{ x, y, z };
+			renderable_t render{ critter_def.glyph, critter_def.glyph_ascii, critter_def.fg, color_t(0.0F,0.0F,0.0F), critter_def.vox };
+			name_t name{};
+			name.first_name = critter_def.name;
+			if (male) {
+				name.last_name = critter_def.male_name;
+			}
+			else {
+				name.last_name = critter_def.female_name;
+			}
+			species_t species{};
+			species.tag = critter_def.tag;
+			if (male) { species.gender = MALE; }
+			else { species.gender = FEMALE; }
+
+			game_stats_t stats;
+			stats.profession_tag = "Wildlife";
+			stats.age = 1;
+			for (auto it = critter_def.stats.begin(); it != critter_def.stats.end(); ++it) {
+				if (it->first == "str") stats.strength = it->second;
+				if (it->first == "dex") stats.dexterity = it->second;
+				if (it->first == "con") stats.constitution = it->second;
+				if (it->first == "int") stats.intelligence = it->second;
+				if (it->first == "wis") stats.wisdom = it->second;
+				if (it->first == "cha") stats.charisma = it->second;
+			}
+
+			if (critter_def.ai == creature_grazer) {
+				auto new_entity = create_entity();
+				new_entity->assign(std::move(pos));
+				new_entity->assign(std::move(render));
+				new_entity->assign(std::move(name));
+				new_entity->assign(std::move(species));
+				new_entity->assign(create_health_component_creature(critter_def.tag));
+				new_entity->assign(grazer_ai{});
+				new_entity->assign(std::move(stats));
+				new_entity->assign(viewshed_t(6, false, false));
+				new_entity->assign(wildlife_group{ group });
+				new_entity->assign(initiative_t{});
+				new_entity->assign(ai_mode_idle_t{});
+				//std::cout << "Spawning " << critter_tag << " on edge " << edge << "\n";
+				//call_home("Spawn", "Creature", critter_tag);
+			}
+		}
+
 		void spawn_wildlife() {
 			using namespace nf;
 			for (uint8_t i = 0; i<4; ++i) {
@@ -66,59 +116,21 @@ namespace systems {
 					}
 
 					for (int j = 0; j<n_spawn; ++j) {
-						// Critters have: appropriate AI component, wildlife_group, position, renderable, name, species, stats
-						bool male = true;
-						if (rng.roll_dice(1, 4) <= 2) male = false;
-
-						position_t pos{ base_x, base_y, base_z };
-						renderable_t render{ critter_def.glyph, critter_def.glyph_ascii, critter_def.fg, color_t(0.0F,0.0F,0.0F), critter_def.vox };
-						name_t name{};
-						name.first_name = critter_def.name;
-						if (male) {
-							name.last_name = critter_def.male_name;
-						}
-						else {
-							name.last_name = critter_def.female_name;
-						}
-						species_t species{};
-						species.tag = critter_def.tag;
-						if (male) { species.gender = MALE; }
-						else { species.gender = FEMALE; }
-
-						game_stats_t stats;
-						stats.profession_tag = "Wildlife";
-						stats.age = 1;
-						for (auto it = critter_def.stats.begin(); it != critter_def.stats.end(); ++it) {
-							if (it->first == "str") stats.strength = it->second;
-							if (it->first == "dex") stats.dexterity = it->second;
-							if (it->first == "con") stats.constitution = it->second;
-							if (it->first == "int") stats.intelligence = it->second;
-							if (it->first == "wis") stats.wisdom = it->second;
-							if (it->first == "cha") stats.charisma = it->second;
-						}
-
-						if (critter_def.ai == creature_grazer) {
-							auto new_entity = create_entity();
-							std::cout << new_entity->id << "\n";
-							new_entity->assign(std::move(pos));
-							new_entity->assign(std::move(render));
-							new_entity->assign(std::move(name));
-							new_entity->assign(std::move(species));
-							new_entity->assign(create_health_component_creature(critter_def.tag));
-							new_entity->assign(grazer_ai{});
-							new_entity->assign(std::move(stats));
-							new_entity->assign(viewshed_t(6, false, false));
-							new_entity->assign(wildlife_group{ i });
-							new_entity->assign(initiative_t{});
-							new_entity->assign(ai_mode_idle_t{});
-							//std::cout << "Spawning " << critter_tag << " on edge " << edge << "\n";
-							//call_home("Spawn", "Creature", critter_tag);
-						}
+						spawn_critter(critter_def, base_x, base_y, base_z, i);
 					}
 				}
 			}
 		}
 
+		void spawn_critter_at(const int x, const int y, const int z, const uint8_t group) {
+			using namespace nf;
+			const std::size_t biome_type = planet.biomes[region::get_biome_idx()].type;
+			const auto &wildlife = get_biome_def(biome_type)->wildlife;
+			if (wildlife.empty()) return;
+			const auto &critter_tag = wildlife[rng.roll_dice(1, static_cast<int>(wildlife.size())) - 1];
+			spawn_critter(*get_creature_def(critter_tag), x, y, z, static_cast<uint8_t>(group % 4));
+		}
+
 		void run(const double &duration_ms) {
 			if (first_run) {
 				// Check existing population groups
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstdint>
+
 namespace systems {
 	namespace wildlife_population {
 		void run(const double &duration_ms);
 		extern bool first_run;
+
+		/* Adds one critter of the region's wildlife (picked at random for its biome) at x,y,z, in wildlife group 0-3. */
+		void spawn_critter_at(const int x, const int y, const int z, const uint8_t group);
 	}
-}
\ No newline at end of file
+}
@@ -1,6 +1,6 @@
 #include "creature_attacks_system.hpp"
 #include "../../global_assets/game_ecs.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../../raws/creatures.hpp"
 #include "../../raws/defs/raw_creature_t.hpp"
 #include "../helpers/weapons_helper.hpp"
@@ -16,7 +16,7 @@ namespace systems {
 		using namespace bengine;
 		using namespace weapons;
 
-		thread_safe_message_queue<creature_attack_message> attacks;
+		mpsc_message_queue<creature_attack_message> attacks;
 
 		void request_attack(creature_attack_message msg) {
 			attacks.enqueue(creature_attack_message{ msg.attacker, msg.victim });
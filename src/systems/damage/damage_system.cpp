@@ -1,6 +1,6 @@
 #include "damage_system.hpp"
 #include "../../global_assets/game_ecs.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../../global_assets/rng.hpp"
 #include "../../planet/region/region.hpp"
 #include "kill_system.hpp"
@@ -13,7 +13,7 @@ namespace systems {
 
 		using namespace bengine;
 
-		thread_safe_message_queue<inflict_damage_message> damage;
+		mpsc_message_queue<inflict_damage_message> damage;
 
 		void inflict_damage(inflict_damage_message msg) {
 			damage.enqueue(inflict_damage_message{ msg.victim, msg.damage_amount, msg.damage_type });
@@ -1,5 +1,5 @@
 #include "kill_system.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../../global_assets/spatial_db.hpp"
 #include "../ai/inventory_system.hpp"
 #include "../ai/distance_map_system.hpp"
@@ -11,7 +11,7 @@ namespace systems {
 
 		using namespace bengine;
 
-		thread_safe_message_queue<entity_slain_message> kills;
+		mpsc_message_queue<entity_slain_message> kills;
 
 		void fatality(entity_slain_message msg) {
 			kills.enqueue(entity_slain_message{ msg.victim, msg.cause_of_death });
@@ -1,5 +1,5 @@
 #include "sentient_attacks_system.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 //#include "../gui/log_system.hpp"
 #include "../../global_assets/rng.hpp"
 #include "../helpers/weapons_helper.hpp"
@@ -17,8 +17,8 @@ namespace systems {
 		using namespace bengine;
 		using namespace weapons;
 
-		thread_safe_message_queue<sentient_attack_message> attacks;
-		thread_safe_message_queue<sentient_ranged_attack_message> ranged_attacks;
+		mpsc_message_queue<sentient_attack_message> attacks;
+		mpsc_message_queue<sentient_ranged_attack_message> ranged_attacks;
 
 		void request_attack(sentient_attack_message msg) {
 			attacks.enqueue(sentient_attack_message{ msg.attacker, msg.victim });
@@ -1,6 +1,6 @@
 #include "settler_melee_attacks_system.hpp"
 #include "../../global_assets/game_ecs.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../helpers/weapons_helper.hpp"
 #include "../../raws/items.hpp"
 #include "../../raws/defs/item_def_t.hpp"
@@ -18,7 +18,7 @@ namespace systems {
 		using namespace bengine;
 		using namespace weapons;
 
-		thread_safe_message_queue<settler_attack_message> melee;
+		mpsc_message_queue<settler_attack_message> melee;
 
 		void request_melee(settler_attack_message msg) {
 			melee.enqueue(settler_attack_message{ msg.attacker, msg.victim });
@@ -1,6 +1,6 @@
 #include "settler_ranged_attack_system.hpp"
 #include "../../global_assets/game_ecs.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../helpers/weapons_helper.hpp"
 #include "../../raws/items.hpp"
 #include "../../raws/defs/item_def_t.hpp"
@@ -18,7 +18,7 @@ namespace systems {
 		using namespace weapons;
 		//using namespace logging;
 
-		thread_safe_message_queue<settler_ranged_attack_message> attacks;
+		mpsc_message_queue<settler_ranged_attack_message> attacks;
 
 		void request_settler_ranged_attack(settler_ranged_attack_message msg) {
 			attacks.enqueue(settler_ranged_attack_message{ msg.attacker, msg.victim });
@@ -1,6 +1,6 @@
 #include "turret_ranged_attack_system.hpp"
 #include "../../global_assets/game_ecs.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../gui/log_system.hpp"
 #include "../../global_assets/rng.hpp"
 #include "../helpers/weapons_helper.hpp"
@@ -13,7 +13,7 @@ namespace systems {
 		using namespace bengine;
 		using namespace weapons;
 
-		thread_safe_message_queue<turret_ranged_attack_message> attacks;
+		mpsc_message_queue<turret_ranged_attack_message> attacks;
 
 		void request_attack(turret_ranged_attack_message msg) {
 			attacks.enqueue(turret_ranged_attack_message{ msg.attacker, msg.victim });
@@ -0,0 +1,140 @@
+#include "path_cache.hpp"
+#include "../../planet/region/region.hpp"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace path_cache {
+
+	using namespace nf;
+
+	// Past this, stale entries are swept and then the least recently used quarter goes
+	constexpr std::size_t MAX_ENTRIES = 4096;
+
+	struct entry_t {
+		navigation_path_t path;
+		std::vector<std::pair<int, uint32_t>> chunks; // Chunk index and its walkability version when searched
+		uint64_t last_used;
+	};
+
+	static std::unordered_map<uint64_t, entry_t> entries;
+	static path_cache_stats_t stats;
+	static uint64_t use_counter = 0;
+	static std::mutex cache_lock;
+
+	static inline bool in_region(const position_t &pos) noexcept {
+		return pos.x >= 0 && pos.x < REGION_WIDTH && pos.y >= 0 && pos.y < REGION_HEIGHT && pos.z >= 0 && pos.z < REGION_DEPTH;
+	}
+
+	static inline uint64_t cache_key(const position_t &start, const position_t &end, const bool find_adjacent) noexcept {
+		return (static_cast<uint64_t>(mapidx(start)) << 32) | (static_cast<uint64_t>(mapidx(end)) << 1) | (find_adjacent ? 1 : 0);
+	}
+
+	static inline int chunk_of(const position_t &pos) noexcept {
+		return chunk_idx(pos.x / CHUNK_SIZE, pos.y / CHUNK_SIZE, pos.z / CHUNK_SIZE);
+	}
+
+	static bool still_valid(const entry_t &entry) {
+		for (const auto &chunk : entry.chunks) {
+			if (region::walkability_version(chunk.first) != chunk.second) return false;
+		}
+		return true;
+	}
+
+	static void make_room() {
+		for (auto it = entries.begin(); it != entries.end(); ) {
+			if (!still_valid(it->second)) {
+				it = entries.erase(it);
+				++stats.evicted;
+			}
+			else {
+				++it;
+			}
+		}
+		if (entries.size() < MAX_ENTRIES) return;
+
+		std::vector<uint64_t> ages;
+		ages.reserve(entries.size());
+		for (const auto &entry : entries) ages.emplace_back(entry.second.last_used);
+		const auto cutoff = ages.begin() + (ages.size() / 4);
+		std::nth_element(ages.begin(), cutoff, ages.end());
+		const auto oldest_kept = *cutoff;
+		for (auto it = entries.begin(); it != entries.end(); ) {
+			if (it->second.last_used < oldest_kept) {
+				it = entries.erase(it);
+				++stats.evicted;
+			}
+			else {
+				++it;
+			}
+		}
+	}
+
+	std::shared_ptr<navigation_path_t> find(const position_t &start, const position_t &end, const bool find_adjacent) {
+		if (!in_region(start) || !in_region(end)) return nullptr;
+
+		std::lock_guard<std::mutex> lock(cache_lock);
+		const auto finder = entries.find(cache_key(start, end, find_adjacent));
+		if (finder == entries.end()) {
+			++stats.misses;
+			return nullptr;
+		}
+		if (!still_valid(finder->second)) {
+			entries.erase(finder);
+			++stats.invalidated;
+			++stats.misses;
+			return nullptr;
+		}
+
+		++stats.hits;
+		finder->second.last_used = ++use_counter;
+		return make_navigation_path(finder->second.path);
+	}
+
+	void store(const position_t &start, const position_t &end, const bool find_adjacent, const navigation_path_t &path, const std::vector<uint32_t> &versions) {
+		if (!path.success || path.steps.empty() || !in_region(start) || !in_region(end)) return;
+
+		entry_t entry{ path, {}, 0 };
+		auto add_chunk = [&entry, &versions](const position_t &pos) {
+			if (!in_region(pos)) return false;
+			const auto chunk = chunk_of(pos);
+			if (std::find_if(entry.chunks.begin(), entry.chunks.end(), [&chunk](const std::pair<int, uint32_t> &c) { return c.first == chunk; }) == entry.chunks.end()) {
+				entry.chunks.emplace_back(std::make_pair(chunk, versions[chunk]));
+			}
+			return true;
+		};
+		if (!add_chunk(start)) return;
+		for (std::size_t i = 0; i < path.steps.size(); ++i) {
+			if (!add_chunk(path.steps[i])) return;
+		}
+
+		std::lock_guard<std::mutex> lock(cache_lock);
+		if (entries.size() >= MAX_ENTRIES) make_room();
+		entry.last_used = ++use_counter;
+		entries[cache_key(start, end, find_adjacent)] = std::move(entry);
+	}
+
+	void store(const position_t &start, const position_t &end, const bool find_adjacent, const navigation_path_t &path) {
+		static thread_local std::vector<uint32_t> versions;
+		capture_versions(versions);
+		store(start, end, find_adjacent, path, versions);
+	}
+
+	void capture_versions(std::vector<uint32_t> &versions) {
+		versions.resize(CHUNKS_TOTAL);
+		for (int i = 0; i < CHUNKS_TOTAL; ++i) versions[i] = region::walkability_version(i);
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(cache_lock);
+		entries.clear();
+	}
+
+	path_cache_stats_t get_stats() {
+		std::lock_guard<std::mutex> lock(cache_lock);
+		auto result = stats;
+		result.entries = entries.size();
+		return result;
+	}
+}
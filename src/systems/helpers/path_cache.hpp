@@ -0,0 +1,40 @@
+#pragma once
+
+#include "pathfinding.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ * Remembers successful paths by start tile, goal tile and find_adjacent, so settlers shuttling between the same
+ * stockpiles, workshops and beds don't search for the same route over and over. Each entry records the
+ * walkability version of every chunk its path crosses; a lookup that finds any of them changed drops the entry
+ * and counts as a miss. Failed searches aren't cached - any change anywhere could fix them.
+ *
+ * Lookups hand out a copy of the path, since callers consume steps as they walk.
+ */
+namespace path_cache {
+
+	struct path_cache_stats_t {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t invalidated = 0;		// Lookups that found an entry whose chunks had changed
+		uint64_t evicted = 0;
+		std::size_t entries = 0;
+	};
+
+	/* A copy of the cached path, or nullptr if there isn't a valid one. */
+	std::shared_ptr<navigation_path_t> find(const position_t &start, const position_t &end, const bool find_adjacent);
+
+	/* Stores a successful path, stamped with the live chunk versions. */
+	void store(const position_t &start, const position_t &end, const bool find_adjacent, const navigation_path_t &path);
+
+	/* As above, stamped with the chunk versions the path was actually searched against (indexed by chunk). */
+	void store(const position_t &start, const position_t &end, const bool find_adjacent, const navigation_path_t &path, const std::vector<uint32_t> &versions);
+
+	/* The live version of every chunk, for searches that run against a snapshot taken now. */
+	void capture_versions(std::vector<uint32_t> &versions);
+
+	void clear();
+	path_cache_stats_t get_stats();
+}
@@ -0,0 +1,306 @@
+#include "path_service.hpp"
+#include "path_cache.hpp"
+#include "../../planet/region/region.hpp"
+#include "../../global_assets/game_camera.hpp"
+#include "../../utils/thread_pool.hpp"
+#include "../../utils/profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace path_service {
+
+	using namespace nf;
+
+	// Finished paths nobody collects (the requester died, or gave up) are dropped after this many ticks
+	constexpr int ABANDONED_AFTER_TICKS = 16;
+
+	struct request_t {
+		ticket_t ticket;
+		position_t start;
+		position_t end;
+		bool find_adjacent;
+		int priority; // Lower goes first
+	};
+
+	struct entity_request_t {
+		ticket_t ticket;
+		position_t start;
+		position_t end;
+		bool find_adjacent;
+	};
+
+	struct finished_t {
+		std::shared_ptr<navigation_path_t> path;
+		int age;
+	};
+
+	// One tick's worth of work for the pool. Workers claim requests by index until the batch or the budget runs out.
+	struct batch_t {
+		std::vector<request_t> requests;
+		std::vector<std::shared_ptr<navigation_path_t>> results;
+		std::vector<double> search_us; // Negative if never started
+		std::vector<uint32_t> versions; // Chunk walkability versions the snapshot was taken at
+		int limit = 0; // How many requests may be searched
+		std::atomic<int> next{ 0 };
+		std::atomic<int> workers_running{ 0 };
+		std::mutex done_mutex;
+		std::condition_variable done;
+		std::chrono::steady_clock::time_point deadline;
+	};
+
+	// Everything here is touched only by the main thread, apart from the batch and the snapshot it reads.
+	static std::shared_ptr<batch_t> in_flight;
+	static std::vector<request_t> pending;
+	static std::unordered_set<ticket_t> outstanding;
+	static std::unordered_map<ticket_t, finished_t> finished;
+	static std::unordered_map<int, entity_request_t> by_entity;
+	static ticket_t next_ticket = 1;
+	static double time_budget_ms = 4.0;
+	static std::function<int()> batch_limit;
+	static path_service_stats_t stats;
+
+	static std::vector<uint16_t> snapshot;
+	static std::vector<std::array<int, 6>> dirty_boxes;
+	static bool snapshot_stale = true;
+	static bool listening = false;
+
+	static int camera_priority(const position_t &start) {
+		if (!camera_position) return 0;
+		const auto dx = std::abs(start.x - camera_position->region_x);
+		const auto dy = std::abs(start.y - camera_position->region_y);
+		const auto dz = std::abs(start.z - camera_position->region_z);
+		return std::max(dx, dy) + (dz * 4);
+	}
+
+	ticket_t submit(const position_t &start, const position_t &end, const bool find_adjacent) {
+		const auto ticket = next_ticket++;
+		if (!(start == end)) {
+			auto cached = path_cache::find(start, end, find_adjacent);
+			if (cached) {
+				// Nothing to search for; it's ready to collect straight away
+				finished[ticket] = finished_t{ std::move(cached), 0 };
+				return ticket;
+			}
+		}
+
+		pending.emplace_back(request_t{ ticket, start, end, find_adjacent, camera_priority(start) });
+		outstanding.insert(ticket);
+		stats.queue_depth = static_cast<int>(pending.size());
+		return ticket;
+	}
+
+	path_status_t collect(const ticket_t &ticket, std::shared_ptr<navigation_path_t> &path) {
+		const auto finder = finished.find(ticket);
+		if (finder != finished.end()) {
+			path = std::move(finder->second.path);
+			finished.erase(finder);
+			return PATH_READY;
+		}
+		return outstanding.find(ticket) != outstanding.end() ? PATH_PENDING : PATH_UNKNOWN;
+	}
+
+	path_status_t path_for(const int &entity_id, const position_t &start, const position_t &end, std::shared_ptr<navigation_path_t> &path, const bool find_adjacent) {
+		const auto finder = by_entity.find(entity_id);
+		if (finder != by_entity.end()) {
+			const auto &request = finder->second;
+			if (request.start == start && request.end == end && request.find_adjacent == find_adjacent) {
+				const auto status = collect(request.ticket, path);
+				if (status == PATH_PENDING) return PATH_PENDING;
+				by_entity.erase(finder);
+				if (status == PATH_READY) return PATH_READY;
+			}
+			else {
+				finished.erase(request.ticket);
+				by_entity.erase(finder);
+			}
+		}
+
+		const auto ticket = submit(start, end, find_adjacent);
+		if (collect(ticket, path) == PATH_READY) return PATH_READY;
+		by_entity[entity_id] = entity_request_t{ ticket, start, end, find_adjacent };
+		return PATH_PENDING;
+	}
+
+	void set_time_budget(const double &budget_ms) {
+		time_budget_ms = std::max(0.0, budget_ms);
+	}
+
+	void set_batch_limits(const std::function<int()> &limit) {
+		batch_limit = limit;
+	}
+
+	path_service_stats_t get_stats() {
+		return stats;
+	}
+
+	static void work_on(batch_t &batch) {
+		const auto n_requests = batch.limit;
+		// Every worker gets at least one search in, so a tiny budget can't starve the queue
+		for (bool first = true; first || std::chrono::steady_clock::now() < batch.deadline; first = false) {
+			const auto i = batch.next++;
+			if (i >= n_requests) break;
+
+			const auto &request = batch.requests[i];
+			const auto start_time = std::chrono::steady_clock::now();
+			batch.results[i] = find_path_in_snapshot(snapshot.data(), request.start, request.end, request.find_adjacent);
+			batch.search_us[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+			profiler::record("pathfinding.search", batch.search_us[i] / 1000.0);
+		}
+	}
+
+	static void refresh_snapshot() {
+		const auto &flags = *region::get_tile_flags();
+		if (snapshot.size() != flags.size()) snapshot_stale = true;
+
+		if (snapshot_stale) {
+			snapshot.resize(flags.size());
+			for (std::size_t i = 0; i < flags.size(); ++i) snapshot[i] = pack_movement_flags(flags[i].bits);
+			snapshot_stale = false;
+		}
+		else {
+			for (const auto &box : dirty_boxes) {
+				for (int z = box[2]; z <= box[5]; ++z) {
+					for (int y = box[1]; y <= box[4]; ++y) {
+						const auto row = mapidx(box[0], y, z);
+						for (int x = 0; x <= box[3] - box[0]; ++x) snapshot[row + x] = pack_movement_flags(flags[row + x].bits);
+					}
+				}
+			}
+		}
+		dirty_boxes.clear();
+	}
+
+	// Blocks until the workers have finished with the in-flight batch, if there is one
+	static void wait_for_workers() {
+		if (!in_flight) return;
+		std::unique_lock<std::mutex> lock(in_flight->done_mutex);
+		in_flight->done.wait(lock, [] { return in_flight->workers_running == 0; });
+	}
+
+	void run(const double &duration_ms) {
+		if (!listening) {
+			region::on_tiles_recalculated([](int min_x, int min_y, int min_z, int max_x, int max_y, int max_z) {
+				if (min_x == 0 && min_y == 0 && min_z == 0 && max_x == REGION_WIDTH - 1 && max_y == REGION_HEIGHT - 1 && max_z == REGION_DEPTH - 1) {
+					snapshot_stale = true;
+				}
+				else {
+					dirty_boxes.emplace_back(std::array<int, 6>{ min_x, min_y, min_z, max_x, max_y, max_z });
+				}
+			});
+			listening = true;
+		}
+
+		// Age out results nobody came back for
+		for (auto it = finished.begin(); it != finished.end(); ) {
+			if (++it->second.age > ABANDONED_AFTER_TICKS) {
+				it = finished.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+
+		if (!in_flight) return;
+
+		// Wait for the workers; they stop taking new work once the budget is spent, so this is short
+		wait_for_workers();
+
+		std::vector<request_t> deferred;
+		double total_us = 0.0;
+		double max_us = 0.0;
+		int completed = 0;
+		for (std::size_t i = 0; i < in_flight->requests.size(); ++i) {
+			const auto &request = in_flight->requests[i];
+			if (in_flight->search_us[i] < 0.0) {
+				deferred.emplace_back(request);
+				continue;
+			}
+			outstanding.erase(request.ticket);
+			const auto &result = in_flight->results[i];
+			if (result && result->success && !(request.start == request.end)) {
+				path_cache::store(request.start, request.end, request.find_adjacent, *result, in_flight->versions);
+			}
+			finished[request.ticket] = finished_t{ std::move(in_flight->results[i]), 0 };
+			total_us += in_flight->search_us[i];
+			max_us = std::max(max_us, in_flight->search_us[i]);
+			++completed;
+		}
+		in_flight.reset();
+
+		// Requests the budget didn't reach keep their place at the front of the queue
+		pending.insert(pending.begin(), deferred.begin(), deferred.end());
+
+		stats.completed_last_tick = completed;
+		stats.deferred_last_tick = static_cast<int>(deferred.size());
+		stats.mean_search_us = completed > 0 ? total_us / completed : 0.0;
+		stats.max_search_us = max_us;
+		stats.total_completed += completed;
+		stats.in_flight = 0;
+		stats.queue_depth = static_cast<int>(pending.size());
+	}
+
+	void dispatch() {
+		if (in_flight || pending.empty()) return;
+
+		refresh_snapshot();
+
+		auto batch = std::make_shared<batch_t>();
+		std::stable_sort(pending.begin(), pending.end(), [](const request_t &a, const request_t &b) { return a.priority < b.priority; });
+		batch->requests.swap(pending);
+		batch->results.resize(batch->requests.size());
+		batch->search_us.assign(batch->requests.size(), -1.0);
+		path_cache::capture_versions(batch->versions);
+		batch->limit = static_cast<int>(batch->requests.size());
+		if (batch_limit) {
+			const auto limit = batch_limit();
+			if (limit >= 0) batch->limit = std::max(1, std::min(batch->limit, limit));
+			batch->deadline = std::chrono::steady_clock::time_point::max();
+		}
+		else {
+			batch->deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(time_budget_ms * 1000.0));
+		}
+		in_flight = batch;
+		stats.in_flight = static_cast<int>(batch->requests.size());
+		stats.queue_depth = 0;
+
+		auto &pool = worker_pool();
+		if (pool.size() == 0) {
+			// No spare threads: search here, within the same budget
+			work_on(*batch);
+			return;
+		}
+
+		const auto n_workers = static_cast<int>(std::min<std::size_t>(pool.size(), static_cast<std::size_t>(batch->limit)));
+		batch->workers_running = n_workers;
+		for (int i = 0; i < n_workers; ++i) {
+			pool.enqueue([batch]() {
+				work_on(*batch);
+				if (--batch->workers_running == 0) {
+					std::lock_guard<std::mutex> lock(batch->done_mutex);
+					batch->done.notify_all();
+				}
+			});
+		}
+	}
+
+	void reset() {
+		wait_for_workers();
+		in_flight.reset();
+		pending.clear();
+		outstanding.clear();
+		finished.clear();
+		by_entity.clear();
+		next_ticket = 1;
+		stats = path_service_stats_t{};
+		dirty_boxes.clear();
+		snapshot_stale = true;
+		path_cache::clear();
+	}
+}
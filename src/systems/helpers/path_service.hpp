@@ -0,0 +1,64 @@
+#pragma once
+
+#include "pathfinding.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+/*
+ * Asynchronous path requests. Systems submit a request and get a ticket. At the end of each tick the service
+ * hands the queue to the worker pool, which searches a snapshot of the map's walkability taken at that point,
+ * so the next tick is free to change the map. Results are delivered at the start of the next tick. Workers stop
+ * picking up new requests once the time budget is spent, and requests starting near the camera go first.
+ * Requests the path cache can answer skip the queue and are ready to collect at once.
+ *
+ * Submitting and collecting are main-thread only.
+ */
+namespace path_service {
+
+	using ticket_t = uint64_t;
+
+	enum path_status_t { PATH_PENDING, PATH_READY, PATH_UNKNOWN };
+
+	struct path_service_stats_t {
+		int queue_depth = 0;				// Waiting to be searched
+		int in_flight = 0;					// Handed to the workers this tick
+		int completed_last_tick = 0;
+		int deferred_last_tick = 0;			// Left over when the budget ran out
+		double mean_search_us = 0.0;		// Over the last tick's searches
+		double max_search_us = 0.0;
+		uint64_t total_completed = 0;
+	};
+
+	ticket_t submit(const position_t &start, const position_t &end, const bool find_adjacent = false);
+
+	/* PATH_READY moves the finished path into path and forgets the ticket; PATH_UNKNOWN means it was never issued, or already collected. */
+	path_status_t collect(const ticket_t &ticket, std::shared_ptr<navigation_path_t> &path);
+
+	/*
+	 * One outstanding request per entity, for AI steps that re-run every turn until the path arrives: the first
+	 * call submits, later calls return PATH_PENDING until the result is in, then PATH_READY (once). Asking for a
+	 * different start or end replaces the old request.
+	 */
+	path_status_t path_for(const int &entity_id, const position_t &start, const position_t &end, std::shared_ptr<navigation_path_t> &path, const bool find_adjacent = false);
+
+	void set_time_budget(const double &budget_ms);
+
+	/*
+	 * For replays: instead of working until the budget runs out, the workers search the first n requests of each
+	 * batch, where n comes from calling limit once per batch (negative means all of them). Batches are searched in
+	 * a fixed order, so this reproduces whatever the budget allowed when the session was recorded. An empty
+	 * function goes back to the budget.
+	 */
+	void set_batch_limits(const std::function<int()> &limit);
+	path_service_stats_t get_stats();
+
+	/* Waits for the workers and delivers last tick's results. Call first in the tick. */
+	void run(const double &duration_ms);
+
+	/* Refreshes the walkability snapshot and hands the queue to the workers. Call last in the tick. */
+	void dispatch();
+
+	/* Waits for the workers, then drops every request, result and cached path; outstanding tickets become unknown. */
+	void reset();
+}
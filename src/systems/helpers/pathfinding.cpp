@@ -2,16 +2,104 @@
 #include "../../planet/constants.hpp"
 #include "../../bengine/geometry.hpp"
 #include "targeted_flow_map.hpp"
+#include "path_cache.hpp"
+#include "../../utils/profiler.hpp"
 #include <array>
 #include <queue>
 #include <boost/container/flat_map.hpp>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 
 namespace impl {
 
+	// Freed path blocks kept for re-use. allocate_shared only ever asks for one size: a path plus its control block.
+	constexpr static std::size_t MAX_POOLED_PATHS = 4096;
+
+	struct path_pool_t {
+		std::mutex lock;
+		std::vector<void *> blocks;
+		std::size_t block_size = 0;
+	};
+
+	static path_pool_t &path_pool()
+	{
+		// Never destroyed: paths held by statics may be released after it would have been
+		static auto * pool = new path_pool_t;
+		return *pool;
+	}
+
+	template <typename T>
+	struct path_pool_allocator
+	{
+		using value_type = T;
+
+		path_pool_allocator() noexcept = default;
+		template <typename U> path_pool_allocator(const path_pool_allocator<U> &) noexcept {}
+
+		T * allocate(const std::size_t n)
+		{
+			if (n == 1)
+			{
+				auto &pool = path_pool();
+				std::lock_guard<std::mutex> lock(pool.lock);
+				if (pool.blocks.capacity() == 0) pool.blocks.reserve(MAX_POOLED_PATHS);
+				if (pool.block_size == sizeof(T) && !pool.blocks.empty())
+				{
+					const auto block = pool.blocks.back();
+					pool.blocks.pop_back();
+					return static_cast<T *>(block);
+				}
+			}
+			return static_cast<T *>(::operator new(n * sizeof(T)));
+		}
+
+		void deallocate(T * p, const std::size_t n) noexcept
+		{
+			if (n == 1)
+			{
+				auto &pool = path_pool();
+				std::lock_guard<std::mutex> lock(pool.lock);
+				if (pool.block_size == 0) pool.block_size = sizeof(T);
+				if (pool.block_size == sizeof(T) && pool.blocks.size() < pool.blocks.capacity())
+				{
+					pool.blocks.emplace_back(p);
+					return;
+				}
+			}
+			::operator delete(p);
+		}
+	};
+
+	template <typename T, typename U>
+	bool operator==(const path_pool_allocator<T> &, const path_pool_allocator<U> &) noexcept { return true; }
+
+	template <typename T, typename U>
+	bool operator!=(const path_pool_allocator<T> &, const path_pool_allocator<U> &) noexcept { return false; }
+
 	constexpr static float MAX_DIRECT_PATH_CHECK = 24.0f;
 	constexpr static int Z_WEIGHT = 10;
 	constexpr static int MAX_ASTAR_STEPS = 500;
+	constexpr static int MAX_NEAREST_SEARCH_NODES = 20000;
+
+	/* The tiles reachable in one step from idx, for the breadth-first searches. */
+	static std::size_t tile_exits(const int idx, std::array<int, 10> &successors) noexcept
+	{
+		const auto[x, y, z] = idxmap(idx);
+		const auto flags = region::get_flag_reference(idx);
+		std::size_t n_successors = 0;
+		if (flags.test(tile_flags::CAN_GO_NORTH)) successors[n_successors++] = mapidx(x, y - 1, z);
+		if (flags.test(tile_flags::CAN_GO_SOUTH)) successors[n_successors++] = mapidx(x, y + 1, z);
+		if (flags.test(tile_flags::CAN_GO_WEST)) successors[n_successors++] = mapidx(x - 1, y, z);
+		if (flags.test(tile_flags::CAN_GO_EAST)) successors[n_successors++] = mapidx(x + 1, y, z);
+		if (flags.test(tile_flags::CAN_GO_UP)) successors[n_successors++] = mapidx(x, y, z + 1);
+		if (flags.test(tile_flags::CAN_GO_DOWN)) successors[n_successors++] = mapidx(x, y, z - 1);
+		if (flags.test(tile_flags::CAN_GO_NORTH_EAST)) successors[n_successors++] = mapidx(x + 1, y - 1, z);
+		if (flags.test(tile_flags::CAN_GO_NORTH_WEST)) successors[n_successors++] = mapidx(x - 1, y - 1, z);
+		if (flags.test(tile_flags::CAN_GO_SOUTH_EAST)) successors[n_successors++] = mapidx(x + 1, y + 1, z);
+		if (flags.test(tile_flags::CAN_GO_SOUTH_WEST)) successors[n_successors++] = mapidx(x - 1, y + 1, z);
+		return n_successors;
+	}
 
 	struct node_t
 	{
@@ -30,7 +118,7 @@ namespace impl {
 	class a_star_t
 	{
 	public:
-		a_star_t(const position_t &start_pos, const position_t &end_pos) noexcept : start_(mapidx(start_pos)), end_(mapidx(end_pos)), end_loc_(end_pos)
+		a_star_t(const position_t &start_pos, const position_t &end_pos, const uint16_t * snapshot) noexcept : start_(mapidx(start_pos)), end_(mapidx(end_pos)), end_loc_(end_pos), snapshot_(snapshot)
 		{
 			end_x_ = end_pos.x;
 			end_y_ = end_pos.y;
@@ -103,22 +191,23 @@ namespace impl {
 			result.success = true;
 			result.destination = end_loc_;
 
-			result.steps.push_front(end_loc_);
+			result.steps.push_back(end_loc_);
 			auto current = end_;
 			while (current != start_)
 			{
 				const auto parent = parents_.find(current)->second;
 				auto[x, y, z] = idxmap(parent);
-				if (parent != start_) result.steps.push_front(position_t{x,y,z});
+				if (parent != start_) result.steps.push_back(position_t{x,y,z});
 				current = parent;
 			}
+			result.steps.reverse();
 
 			return result;
 		}
 
 		std::shared_ptr<navigation_path_t> search() noexcept
 		{
-			auto result = std::make_shared<navigation_path_t>();
+			auto result = make_navigation_path();
 
 			while (!open_list_.empty() && step_counter_ < MAX_ASTAR_STEPS)
 			{
@@ -131,7 +220,7 @@ namespace impl {
 
 				// Generate successors
 				std::vector<int> successors;
-				const auto flags = region::get_flag_reference(q.idx);
+				const auto flags = snapshot_ ? bengine::bitset<tile_flags::tile_flag_type>{ unpack_movement_flags(snapshot_[q.idx]) } : region::get_flag_reference(q.idx);
 				if (flags.test(tile_flags::CAN_GO_NORTH)) successors.emplace_back(mapidx(x, y - 1, z));
 				if (flags.test(tile_flags::CAN_GO_SOUTH)) successors.emplace_back(mapidx(x, y + 1, z));
 				if (flags.test(tile_flags::CAN_GO_WEST)) successors.emplace_back(mapidx(x - 1, y, z));
@@ -148,9 +237,9 @@ namespace impl {
 					if (add_successor(q, s))
 					{
 						// We found it!
-						const auto success = found_it(s);
+						auto success = found_it(s);
 						result->success = success.success;
-						result->steps = success.steps;
+						result->steps = std::move(success.steps);
 						result->destination = success.destination;
 						goto BAILOUT;
 					}
@@ -179,25 +268,26 @@ namespace impl {
 		boost::container::flat_map<int, float> closed_list_;
 		boost::container::flat_map<int, int> parents_;
 		position_t end_loc_;
+		const uint16_t * snapshot_;
 		int step_counter_ = 0;
 	};
 
-	static std::shared_ptr<navigation_path_t> a_star(const position_t &start, const position_t &end) noexcept
+	static std::shared_ptr<navigation_path_t> a_star(const position_t &start, const position_t &end, const uint16_t * snapshot) noexcept
 	{
-		a_star_t searcher(start, end);
+		a_star_t searcher(start, end, snapshot);
 		return searcher.search();
 	}
 
 	static std::shared_ptr<navigation_path_t> short_direct_line_optimization(const position_t &start, const position_t &end) noexcept
 	{
-		auto result = std::make_shared<navigation_path_t>();
+		auto result = make_navigation_path();
 		auto blocked = false;
 		std::set<int> seen_nodes;
 		bengine::line_func(start.x, start.y, end.x, end.y, [&blocked, &start, &result, &seen_nodes](const int &x, const int &y)
 		{
 			const auto idx = mapidx(x, y, start.z);
 			if (seen_nodes.find(idx) == seen_nodes.end()) {
-				if (idx != mapidx(start)) result->steps.emplace_back(position_t{ x, y, start.z });
+				if (idx != mapidx(start)) result->steps.push_back(position_t{ x, y, start.z });
 				seen_nodes.insert(idx);
 			}
 			if (!region::flag(idx, tile_flags::CAN_STAND_HERE)) blocked = true;
@@ -207,7 +297,7 @@ namespace impl {
 		return result;
 	}
 	
-	static std::shared_ptr<navigation_path_t> find_path(const position_t &start, const position_t &end) noexcept
+	static std::shared_ptr<navigation_path_t> find_path(const position_t &start, const position_t &end, const uint16_t * snapshot) noexcept
 	{
 		// Step 2 - check for the simple straight line option on short, flat paths
 		/*const auto distance = bengine::distance3d(start.x, start.y, start.z, end.x, end.y, end.z);
@@ -220,13 +310,36 @@ namespace impl {
 		}*/
 
 		// Step 3 - Try A*
-		auto result = a_star(start, end);
+		auto result = a_star(start, end, snapshot);
 		return result;
 	}
 
 }
 
+std::shared_ptr<navigation_path_t> make_navigation_path()
+{
+	return std::allocate_shared<navigation_path_t>(impl::path_pool_allocator<navigation_path_t>{});
+}
+
+std::shared_ptr<navigation_path_t> make_navigation_path(const navigation_path_t &copy)
+{
+	return std::allocate_shared<navigation_path_t>(impl::path_pool_allocator<navigation_path_t>{}, copy);
+}
+
 std::shared_ptr<navigation_path_t> find_path(const position_t &start, const position_t &end, const bool find_adjacent, const std::size_t civ) noexcept
+{
+	profiler::scope_t profile("pathfinding.find_path");
+	if (start == end) return find_path_in_snapshot(nullptr, start, end, find_adjacent);
+
+	auto cached = path_cache::find(start, end, find_adjacent);
+	if (cached) return cached;
+
+	auto result = find_path_in_snapshot(nullptr, start, end, find_adjacent);
+	if (result->success) path_cache::store(start, end, find_adjacent, *result);
+	return result;
+}
+
+std::shared_ptr<navigation_path_t> find_path_in_snapshot(const uint16_t * snapshot, const position_t &start, const position_t &end, const bool find_adjacent) noexcept
 {
 	using namespace nf;
 
@@ -234,23 +347,23 @@ std::shared_ptr<navigation_path_t> find_path(const position_t &start, const posi
 	if (start.x < 1 || start.x > REGION_WIDTH - 1 || start.y < 1 || start.y > REGION_HEIGHT - 1 || start.z < 1 || start.z > REGION_DEPTH + 1
 		|| end.x < 1 || end.x > REGION_WIDTH - 1 || end.y < 1 || end.y > REGION_HEIGHT - 1 || end.z < 1 || end.z > REGION_DEPTH + 1) 
 	{
-		auto fail = std::make_shared<navigation_path_t>();
+		auto fail = make_navigation_path();
 		fail->success = false;
 		return fail;
 	}
 
 	if (start == end)
 	{
-		auto stay = std::make_shared<navigation_path_t>();
+		auto stay = make_navigation_path();
 		stay->success = true;
 		stay->destination = end;
-		stay->steps.push_front(start);
+		stay->steps.push_back(start);
 		return stay;
 	}
 
 	constexpr auto num_paths = 10;
 
-	auto result = impl::find_path(start, end);
+	auto result = impl::find_path(start, end, snapshot);
 	if (find_adjacent && !result->success) {
 		std::array<position_t, num_paths> candidates{
 			position_t{ end.x - 1, end.y, end.z },
@@ -267,9 +380,113 @@ std::shared_ptr<navigation_path_t> find_path(const position_t &start, const posi
 		for (const auto &candidate : candidates)
 		{
 			result.reset();
-			result = impl::find_path(start, candidate);
+			result = impl::find_path(start, candidate, snapshot);
 			if (result->success) return result;
 		}
 	}
 	return result;
 }
+
+nearest_path_t find_path_to_nearest(const position_t &start, const std::unordered_set<int> &goals) noexcept
+{
+	using namespace nf;
+	static thread_local std::unordered_map<int, int> parents;
+	static thread_local std::vector<int> frontier;
+
+	nearest_path_t result{ make_navigation_path() };
+	if (goals.empty() || start.x < 1 || start.x > REGION_WIDTH - 1 || start.y < 1 || start.y > REGION_HEIGHT - 1 || start.z < 1 || start.z > REGION_DEPTH - 1)
+	{
+		result.exhaustive = true;
+		return result;
+	}
+
+	const auto start_idx = mapidx(start);
+	if (goals.find(start_idx) != goals.end())
+	{
+		result.path->success = true;
+		result.path->destination = start;
+		result.path->steps.push_back(start);
+		result.goal = start_idx;
+		return result;
+	}
+
+	parents.clear();
+	frontier.clear();
+	parents.emplace(start_idx, start_idx);
+	frontier.emplace_back(start_idx);
+
+	// Every step costs the same, so the first goal the flood touches is the nearest one
+	std::size_t head = 0;
+	while (head < frontier.size() && static_cast<int>(head) < impl::MAX_NEAREST_SEARCH_NODES)
+	{
+		const auto idx = frontier[head++];
+		std::array<int, 10> successors;
+		const auto n_successors = impl::tile_exits(idx, successors);
+
+		for (std::size_t i = 0; i < n_successors; ++i)
+		{
+			const auto next = successors[i];
+			if (!parents.emplace(next, idx).second) continue;
+
+			if (goals.find(next) != goals.end())
+			{
+				const auto[gx, gy, gz] = idxmap(next);
+				result.path->success = true;
+				result.path->destination = position_t{ gx, gy, gz };
+				auto current = next;
+				while (current != start_idx)
+				{
+					const auto[cx, cy, cz] = idxmap(current);
+					result.path->steps.push_back(position_t{ cx, cy, cz });
+					current = parents[current];
+				}
+				result.path->steps.reverse();
+				result.goal = next;
+				return result;
+			}
+			frontier.emplace_back(next);
+		}
+	}
+
+	result.exhaustive = head >= frontier.size();
+	return result;
+}
+
+bool flood_to_goals(const position_t &start, const std::unordered_set<int> &goals, const std::function<bool(int, int)> &visit) noexcept
+{
+	using namespace nf;
+	static thread_local std::unordered_map<int, int> steps_to;
+	static thread_local std::vector<int> frontier;
+
+	if (goals.empty() || start.x < 1 || start.x > REGION_WIDTH - 1 || start.y < 1 || start.y > REGION_HEIGHT - 1 || start.z < 1 || start.z > REGION_DEPTH - 1)
+	{
+		return true;
+	}
+
+	const auto start_idx = mapidx(start);
+	if (goals.find(start_idx) != goals.end() && !visit(start_idx, 0)) return false;
+
+	steps_to.clear();
+	frontier.clear();
+	steps_to.emplace(start_idx, 0);
+	frontier.emplace_back(start_idx);
+
+	std::size_t head = 0;
+	while (head < frontier.size() && static_cast<int>(head) < impl::MAX_NEAREST_SEARCH_NODES)
+	{
+		const auto idx = frontier[head++];
+		const auto steps = steps_to[idx] + 1;
+		std::array<int, 10> successors;
+		const auto n_successors = impl::tile_exits(idx, successors);
+
+		for (std::size_t i = 0; i < n_successors; ++i)
+		{
+			const auto next = successors[i];
+			if (!steps_to.emplace(next, steps).second) continue;
+			if (goals.find(next) != goals.end() && !visit(next, steps)) return false;
+			frontier.emplace_back(next);
+		}
+	}
+
+	return head >= frontier.size();
+}
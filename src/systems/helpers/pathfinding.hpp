@@ -1,14 +1,120 @@
 #pragma once
 
 #include "../../components/position.hpp"
+#include "../../planet/indices.hpp"
 #include <memory>
-#include <deque>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <boost/container/small_vector.hpp>
+
+/*
+ * The steps of a path, as tile indices. Short paths live inline; walking the path moves a cursor rather than
+ * erasing, so following a path never allocates.
+ */
+class path_steps_t
+{
+public:
+	static constexpr std::size_t INLINE_STEPS = 16;
+
+	bool empty() const noexcept { return cursor_ >= tiles_.size(); }
+	std::size_t size() const noexcept { return tiles_.size() - cursor_; }
+
+	int tile(const std::size_t i) const noexcept { return tiles_[cursor_ + i]; }
+
+	position_t operator[](const std::size_t i) const noexcept
+	{
+		const auto[x, y, z] = idxmap(tile(i));
+		return position_t{ x, y, z };
+	}
+
+	position_t front() const noexcept { return (*this)[0]; }
+
+	void pop_front() noexcept
+	{
+		if (++cursor_ >= tiles_.size()) clear();
+	}
+
+	void push_back(const position_t &pos) { tiles_.emplace_back(mapidx(pos)); }
+
+	void push_front(const position_t &pos)
+	{
+		if (cursor_ > 0) {
+			tiles_[--cursor_] = mapidx(pos);
+		}
+		else {
+			tiles_.insert(tiles_.begin(), mapidx(pos));
+		}
+	}
+
+	/* Searches walk back from the goal; they append and reverse once at the end. */
+	void reverse() noexcept { std::reverse(tiles_.begin() + cursor_, tiles_.end()); }
+
+	void clear() noexcept
+	{
+		tiles_.clear();
+		cursor_ = 0;
+	}
+
+private:
+	boost::container::small_vector<int32_t, INLINE_STEPS> tiles_;
+	uint32_t cursor_ = 0;
+};
 
 struct navigation_path_t
 {
 	bool success = false;
-	std::deque<position_t> steps{};
+	path_steps_t steps{};
 	position_t destination{0,0,0};
 };
 
+/*
+ * Paths come from a shared pool: a freed path's memory goes to the next one, so settlers re-pathing every few
+ * turns don't go back to the heap each time.
+ */
+std::shared_ptr<navigation_path_t> make_navigation_path();
+std::shared_ptr<navigation_path_t> make_navigation_path(const navigation_path_t &copy);
+
 std::shared_ptr<navigation_path_t> find_path(const position_t &start, const position_t &end, const bool find_adjacent = false, const std::size_t civ = 0) noexcept;
+
+/*
+ * The movement flags (the ten CAN_GO_ directions and CAN_STAND_HERE) squeezed into 16 bits, for snapshots of the
+ * map's walkability that searches can run against off the main thread.
+ */
+constexpr uint16_t pack_movement_flags(const uint32_t flags) noexcept
+{
+	return static_cast<uint16_t>((flags & 0x7Fu) | ((flags >> 6) & 0x780u));
+}
+
+constexpr uint32_t unpack_movement_flags(const uint16_t packed) noexcept
+{
+	return (packed & 0x7Fu) | ((static_cast<uint32_t>(packed) & 0x780u) << 6);
+}
+
+/*
+ * As find_path, but reading walkability from a packed snapshot (one entry per tile) instead of the live region.
+ * A null snapshot means the live region.
+ */
+std::shared_ptr<navigation_path_t> find_path_in_snapshot(const uint16_t * snapshot, const position_t &start, const position_t &end, const bool find_adjacent = false) noexcept;
+
+struct nearest_path_t
+{
+	std::shared_ptr<navigation_path_t> path;
+	int goal = -1; // Tile index of the goal that was reached
+	bool exhaustive = false; // The search saw every tile reachable from the start, so failure is definitive
+};
+
+/*
+ * Breadth-first search outwards from start for whichever of the goal tiles is closest by path length, returning
+ * the path to it. The search is bounded; if it gives up before running out of tiles, exhaustive is false and a
+ * goal further away may still be reachable.
+ */
+nearest_path_t find_path_to_nearest(const position_t &start, const std::unordered_set<int> &goals) noexcept;
+
+/*
+ * The same bounded breadth-first search, for when more than the nearest goal matters: calls visit(tile, steps)
+ * for each goal tile as it is reached, nearest first, until visit returns false. Returns true if the search saw
+ * every tile reachable from start (so unvisited goals can't be reached), false if it stopped early.
+ */
+bool flood_to_goals(const position_t &start, const std::unordered_set<int> &goals, const std::function<bool(int, int)> &visit) noexcept;
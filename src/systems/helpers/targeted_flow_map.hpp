@@ -5,6 +5,8 @@
 #include "../ai/distance_map_system.hpp"
 #include "../../bengine/geometry.hpp"
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <tuple>
 
@@ -36,9 +38,30 @@ namespace flow_maps {
 			}
 		}
 
+		/*
+		 * Finds the target with the shortest walk from pos, and the path to it. A single flood from pos finds it
+		 * in one go; per-target A* (nearest in a straight line first) is only needed when every target lies
+		 * beyond the flood's search limit.
+		 */
 		path_result_t find_nearest_reachable_target(const position_t &pos)
 		{
-			std::map<int, std::tuple<int, int>> searcher; // index = range, body = position
+			path_result_t result{};
+			result.target = 0;
+			if (targets.empty()) return result;
+
+			std::unordered_set<int> goals;
+			std::unordered_map<int, int> target_at; // tile index -> target, first listed wins
+			for (const auto &t : targets)
+			{
+				goals.insert(std::get<0>(t));
+				target_at.emplace(std::get<0>(t), std::get<1>(t));
+			}
+
+			auto nearest = find_path_to_nearest(pos, goals);
+			if (nearest.path->success) return path_result_t{ std::move(nearest.path), target_at[nearest.goal] };
+			if (nearest.exhaustive) return result;
+
+			std::multimap<int, std::tuple<int, int>> searcher; // index = range, body = position
 			for (const auto &t : targets)
 			{
 				const auto[x, y, z] = idxmap(std::get<0>(t));
@@ -46,14 +69,33 @@ namespace flow_maps {
 				searcher.insert(std::make_pair(range, t));
 			}
 
-			for (const auto search : searcher)
+			for (const auto &search : searcher)
 			{
 				const auto[x, y, z] = idxmap(std::get<0>(search.second));
 				auto path = find_path(pos, position_t{ x,y,z });
 				if (path->success) return path_result_t{ std::move(path), std::get<1>(search.second) };
 			}
+			return result;
+		}
+
+		/*
+		 * As find_nearest_reachable_target, but only heading for one target (one a settler was assigned). Fails if
+		 * the target is gone or can't be reached from pos.
+		 */
+		path_result_t find_path_to_target(const position_t &pos, const int &target)
+		{
 			path_result_t result{};
 			result.target = 0;
+
+			std::unordered_set<int> goals;
+			for (const auto &t : targets)
+			{
+				if (std::get<1>(t) == target) goals.insert(std::get<0>(t));
+			}
+			if (goals.empty()) return result;
+
+			auto nearest = find_path_to_nearest(pos, goals);
+			if (nearest.path->success) return path_result_t{ std::move(nearest.path), target };
 			return result;
 		}
 
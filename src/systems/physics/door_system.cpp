@@ -28,15 +28,7 @@ namespace systems {
 						set_tile_type(idx, tile_type::FLOOR);
 					}
 
-					tile_calculate(pos.x, pos.y, pos.z);
-					for (int Z = -2; Z<3; ++Z) {
-						for (int Y = -2; Y<3; ++Y) {
-							for (int X = -2; X<3; ++X) {
-								tile_calculate(pos.x + X, pos.y + Y, pos.z + Z);
-							}
-						}
-					}
-					region::mark_chunk_dirty_by_tileidx(idx);
+					recalc_box(pos.x, pos.y, pos.z, pos.x, pos.y, pos.z);
 				});
 				dirty = false;
 			}
@@ -9,6 +9,9 @@
 #include "../../raws/materials.hpp"
 #include "../../raws/defs/material_def_t.hpp"
 #include "../../noxtypes.h"
+#include <map>
+#include <memory>
+#include <tuple>
 
 using namespace bengine;
 using namespace region;
@@ -18,47 +21,85 @@ using namespace nf;
 namespace systems {
 	namespace explosives {
 
-		inline void internal_boom_to(position_t &pos, int radius, int x, int y, int z, std::unordered_set<int> &targets) {
-			const float dist_square = radius * radius;
-
-			int last_z = pos.z;
-			line_func_3d_cancellable(pos.x, pos.y, pos.z, pos.x + x, pos.y + y, pos.z + z, [&targets, &pos, &dist_square, &last_z](int X, int Y, int Z) {
-				if (X < 1 || X > REGION_WIDTH - 1 || Y < 1 || Y > REGION_HEIGHT - 1 || Z < 1 || Z > REGION_DEPTH - 1)
-				{
-					return false;
-				}
-				else {
-					const auto idx = mapidx(X, Y, Z);
-					bool blocked = flag(idx, SOLID);
-					// TODO: if (blocked_visibility.find(idx) != blocked_visibility.end()) blocked = true;
-					if (!blocked && last_z != Z) {
-						//std::cout << "Last Z: " << last_z << ", Z: " << Z << "\n";
-						// Check for ceilings and floors
-						if (last_z > Z) {
-							if (region::tile_type(idx) == tile_type::FLOOR) {
-								blocked = true;
-								//std::cout << "Ceiling block\n";
-							}
+		/*
+		 * Blast shells: every ray an explosion casts at a given blast timer (360 one-degree rays per z slice), as
+		 * offsets from the origin, merged into a tree so that rays sharing a prefix share cells. A cell's parent
+		 * is the cell before it on the ray (-1 for the origin), and always comes earlier in the table.
+		 */
+		static std::vector<std::unique_ptr<std::vector<fov_cell_t>>> blast_tables;
+
+		static const std::vector<fov_cell_t> &blast_table(const int &radius) {
+			if (radius >= static_cast<int>(blast_tables.size())) blast_tables.resize(radius + 1);
+			if (blast_tables[radius]) return *blast_tables[radius];
+
+			auto table = std::make_unique<std::vector<fov_cell_t>>();
+			std::map<std::tuple<int32_t, int, int, int>, int32_t> children;
+			for (int z = (0 - radius); z < radius; ++z) {
+				for (double angle = 0.0; angle<360.0; angle += 1.0) {
+					const auto dest = project_angle(0, 0, radius, angle*0.0174533);
+					int32_t parent = -1;
+					line_func_3d_cancellable(0, 0, 0, dest.first, dest.second, z, [&table, &children, &parent](int X, int Y, int Z) {
+						const auto key = std::make_tuple(parent, X, Y, Z);
+						auto finder = children.find(key);
+						if (finder == children.end()) {
+							finder = children.emplace(key, static_cast<int32_t>(table->size())).first;
+							table->emplace_back(fov_cell_t{ static_cast<int16_t>(X), static_cast<int16_t>(Y), static_cast<int16_t>(Z), parent });
 						}
-						else if (last_z < Z) {
-							if (region::tile_type(mapidx(X, Y, last_z)) == tile_type::FLOOR) {
-								blocked = true;
-								//std::cout << "Floor block\n";
-							}
-						}
-					}
-					// TODO: emit(emit_particles_message{ PARTICLE_BOOM, X, Y, Z });
-					if (targets.find(idx) == targets.end()) {
-						targets.insert(idx);
+						parent = finder->second;
+						return true;
+					});
+				}
+			}
+			blast_tables[radius] = std::move(table);
+			return *blast_tables[radius];
+		}
+
+		/*
+		 * Walks the blast shell for this tick, adding every tile it reaches for the first time to new_tiles. A ray
+		 * stops at the region edge (without hitting it), after the first tile beyond the blast radius, or after a
+		 * solid tile, floor or ceiling.
+		 */
+		static void blast_shell(const position_t &pos, const explosion_t &boom, fov_bitset_t &tiles_hit, std::vector<int> &new_tiles) {
+			static std::vector<uint8_t> continues;
+			static std::vector<int> cell_z;
+
+			const auto &table = blast_table(boom.blast_timer);
+			continues.assign(table.size(), 0);
+			cell_z.resize(table.size());
+			const int dist_square = boom.blast_radius * boom.blast_radius;
+
+			for (std::size_t i = 0; i < table.size(); ++i) {
+				const auto &cell = table[i];
+				if (cell.parent >= 0 && !continues[cell.parent]) continue;
+
+				const int X = pos.x + cell.x;
+				const int Y = pos.y + cell.y;
+				const int Z = pos.z + cell.z;
+				if (X < 1 || X > REGION_WIDTH - 1 || Y < 1 || Y > REGION_HEIGHT - 1 || Z < 1 || Z > REGION_DEPTH - 1) continue;
+
+				const auto idx = mapidx(X, Y, Z);
+				const int last_z = cell.parent >= 0 ? cell_z[cell.parent] : pos.z;
+				bool blocked = flag(idx, SOLID);
+				// TODO: if (blocked_visibility.find(idx) != blocked_visibility.end()) blocked = true;
+				if (!blocked && last_z != Z) {
+					// Check for ceilings and floors
+					if (last_z > Z) {
+						if (region::tile_type(idx) == tile_type::FLOOR) blocked = true;
 					}
-					const float distance = distance3d_squared(pos.x, pos.y, pos.z, X, Y, Z);
-					if (distance > dist_square) {
-						return false;
+					else if (region::tile_type(mapidx(X, Y, last_z)) == tile_type::FLOOR) {
+						blocked = true;
 					}
-					last_z = Z;
-					return !blocked;
 				}
-			});
+				// TODO: emit(emit_particles_message{ PARTICLE_BOOM, X, Y, Z });
+				if (!tiles_hit.test(X, Y, Z)) {
+					tiles_hit.set_offset(X - tiles_hit.origin_x, Y - tiles_hit.origin_y, Z - tiles_hit.origin_z);
+					new_tiles.emplace_back(idx);
+				}
+
+				const int distance = ((X - pos.x) * (X - pos.x)) + ((Y - pos.y) * (Y - pos.y)) + ((Z - pos.z) * (Z - pos.z));
+				cell_z[i] = Z;
+				continues[i] = (distance <= dist_square && !blocked) ? 1 : 0;
+			}
 		}
 
 		void run(const double &duration_ms) {
@@ -85,108 +126,94 @@ namespace systems {
 				if (boom.blast_timer < boom.blast_radius + 1) {
 					//std::cout << "Boom - radius " << +boom.blast_timer << "\n";
 
-					// Do a Line-of-Sight traversal over the boom radius
-					std::unordered_set<int> exploding_tiles;
-					exploding_tiles.insert(mapidx(pos)); // Always hit the origin
-					for (int z = (0 - boom.blast_timer); z < boom.blast_timer; ++z) {
-						for (double angle = 0.0; angle<360.0; angle += 1.0) {
-							auto dest = project_angle(0, 0, boom.blast_timer, angle*0.0174533);
-							internal_boom_to(pos, boom.blast_radius, dest.first, dest.second, z, exploding_tiles);
-						}
+					// Walk the precomputed blast shell; only tiles this explosion hasn't hit before come back
+					if (boom.tiles_hit.radius < 0) boom.tiles_hit.reset(pos.x, pos.y, pos.z, boom.blast_radius + 2);
+					static std::vector<int> exploding_tiles;
+					static std::vector<int> opened_tiles;
+					exploding_tiles.clear();
+					opened_tiles.clear();
+					if (!boom.tiles_hit.test(pos.x, pos.y, pos.z)) {
+						// Always hit the origin
+						boom.tiles_hit.set_offset(0, 0, 0);
+						exploding_tiles.emplace_back(mapidx(pos));
 					}
+					blast_shell(pos, boom, boom.tiles_hit, exploding_tiles);
 
 					// Affect each blasted tile
 					for (auto boomidx : exploding_tiles) {
-						if (boom.tiles_hit.find(boomidx) == boom.tiles_hit.end()) {
-							boom.tiles_hit.insert(boomidx);
-
-							const auto &[x,y,z] = idxmap(boomidx);
-
-							// Create a smoke effect
-							// TODO: emit(emit_particles_message{ PARTICLE_SMOKE, x, y, z });
-
-							// Damage to the tile - change it to use the material properties
-							if (flag(boomidx, SOLID) || region::tile_type(boomidx) == tile_type::FLOOR) {
-								// We need to damage the tile
-								const int damage_base = rng.roll_dice(boom.damage_dice, boom.damage_dice_type);
-								const int damage = damage_base / 10;
-								// TODO: emit(vegetation_damage_message{ boomidx, damage });
-								if (damage > tile_hit_points(boomidx)) {
-									damage_tile(boomidx, damage);
-									// Destroyed
-									if (tree_id(boomidx) > 0) {
-										// Destroy the tree and make wood
-										const auto tid = tree_id(boomidx);
-										for (int Z = 0; Z < REGION_DEPTH; ++Z) {
-											for (int Y = 0; Y < REGION_HEIGHT; ++Y) {
-												for (int X = 0; X < REGION_WIDTH; ++X) {
-													const int idx = mapidx(X, Y, Z);
-													if (tree_id(idx) == tid) {
-														make_open_space(idx);
-														if (rng.roll_dice(1, 4) > 2) spawn_item_on_ground(X, Y, Z, "wood_log", get_material_by_tag("wood"), 3, 50, 0, "Explosives");
-													}
-												}
-											}
-										}
-										delete_tree(tid);
-										designations->chopping.erase(tid);
-										for (int Z = -2; Z < 10; ++Z) {
-											for (int Y = -10; Y < 10; ++Y) {
-												for (int X = -10; X < 10; ++X) {
-													if (x + X > 0 && x + X < REGION_WIDTH && y + Y > 0 &&
-														y + Y < REGION_HEIGHT && z + Z > 0 && z + Z < REGION_DEPTH) {
-														tile_calculate(x + X, y + Y, z + Z);
-														tile_calculate(x + X, y + Y, z + Z);
-													}
-												}
-											}
-										}
-									}
-									else {
-										// Mine out the tile
-										// TODO: emit(perform_mining_message{ boomidx, 1, x, y, z });
-										if (region::tile_type(boomidx) == tile_type::FLOOR) {
-											make_open_space(boomidx);
-											tile_calculate(x, y, z);
-										}
+						const auto &[x,y,z] = idxmap(boomidx);
+
+						// Create a smoke effect
+						// TODO: emit(emit_particles_message{ PARTICLE_SMOKE, x, y, z });
+
+						// Damage to the tile - change it to use the material properties
+						if (flag(boomidx, SOLID) || region::tile_type(boomidx) == tile_type::FLOOR) {
+							// We need to damage the tile
+							const int damage_base = rng.roll_dice(boom.damage_dice, boom.damage_dice_type);
+							const int damage = damage_base / 10;
+							// TODO: emit(vegetation_damage_message{ boomidx, damage });
+							if (damage > tile_hit_points(boomidx)) {
+								damage_tile(boomidx, damage);
+								// Destroyed
+								if (tree_id(boomidx) > 0) {
+									// Destroy the tree and make wood
+									const auto tid = tree_id(boomidx);
+									const auto felled = tree_tiles(tid);
+									for (const auto &idx : felled) {
+										make_open_space(idx);
+										const auto &[X, Y, Z] = idxmap(idx);
+										if (rng.roll_dice(1, 4) > 2) spawn_item_on_ground(X, Y, Z, "wood_log", get_material_by_tag("wood"), 3, 50, 0, "Explosives");
 									}
+									delete_tree(tid);
+									designations->chopping.erase(tid);
+									opened_tiles.insert(opened_tiles.end(), felled.begin(), felled.end());
 								}
 								else {
-									damage_tile(boomidx, damage);
+									// Mine out the tile
+									// TODO: emit(perform_mining_message{ boomidx, 1, x, y, z });
+									if (region::tile_type(boomidx) == tile_type::FLOOR) {
+										make_open_space(boomidx);
+										opened_tiles.emplace_back(boomidx);
+									}
 								}
 							}
-
-							// Damage everyone/everything present
-							const auto targets = entity_octree.find_by_loc(octree_location_t{ x, y, z });
-
-							float vx = 0.0f, vy = 0.0f, vz = 0.0f;
-
-							vx = static_cast<float>(pos.x - x);
-							vy = static_cast<float>(pos.y - y);
-							vz = static_cast<float>(pos.z - z);
-							const float distance = distance3d(x, y, z, (int)vx, (int)vy, (int)vz);
-							if (distance > 0) {
-								vx /= distance;
-								vy /= distance;
-								vz /= distance;
-							}
-							position_t dest{ static_cast<int>(x + vx), static_cast<int>(y + vy), static_cast<int>(z + vz) };
-							if (dest.x < 1) dest.x = 1;
-							if (dest.x > REGION_WIDTH - 1) dest.x = REGION_WIDTH - 1;
-							if (dest.y < 1) dest.y = 1;
-							if (dest.y > REGION_HEIGHT - 1) dest.y = REGION_HEIGHT - 1;
-							if (dest.z < 1) dest.z = 1;
-							if (dest.z > REGION_DEPTH - 1) dest.z = REGION_DEPTH - 1;
-							const bool dest_solid = flag(mapidx(dest), SOLID);
-
-							for (const auto &target : targets) {
-								// TODO: emit(inflict_damage_message{ target,	rng.roll_dice(boom.damage_dice, boom.damage_dice_type),	"explosion" });
-								//if (!dest_solid && distance > 0.9f && ) {
-								//    emit_deferred(entity_wants_to_move_message{target, dest});
-								//}
+							else {
+								damage_tile(boomidx, damage);
 							}
 						}
+
+						// Damage everyone/everything present
+						float vx = 0.0f, vy = 0.0f, vz = 0.0f;
+
+						vx = static_cast<float>(pos.x - x);
+						vy = static_cast<float>(pos.y - y);
+						vz = static_cast<float>(pos.z - z);
+						const float distance = distance3d(x, y, z, (int)vx, (int)vy, (int)vz);
+						if (distance > 0) {
+							vx /= distance;
+							vy /= distance;
+							vz /= distance;
+						}
+						position_t dest{ static_cast<int>(x + vx), static_cast<int>(y + vy), static_cast<int>(z + vz) };
+						if (dest.x < 1) dest.x = 1;
+						if (dest.x > REGION_WIDTH - 1) dest.x = REGION_WIDTH - 1;
+						if (dest.y < 1) dest.y = 1;
+						if (dest.y > REGION_HEIGHT - 1) dest.y = REGION_HEIGHT - 1;
+						if (dest.z < 1) dest.z = 1;
+						if (dest.z > REGION_DEPTH - 1) dest.z = REGION_DEPTH - 1;
+						const bool dest_solid = flag(mapidx(dest), SOLID);
+
+						// Visited in place, so anything done to a target has to be deferred rather than move it in the octree now
+						entity_octree.find_by_loc(octree_location_t{ x, y, z }, [&](const int target) {
+							// TODO: emit(inflict_damage_message{ target,	rng.roll_dice(boom.damage_dice, boom.damage_dice_type),	"explosion" });
+							//if (!dest_solid && distance > 0.9f && ) {
+							//    emit_deferred(entity_wants_to_move_message{target, dest});
+							//}
+						});
 					}
+
+					// One recalculation for everything this shell opened up
+					if (!opened_tiles.empty()) recalc_tiles(opened_tiles);
 				}
 
 				++boom.blast_timer; // Decrease the boom effect
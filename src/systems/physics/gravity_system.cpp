@@ -8,6 +8,7 @@
 #include "../../global_assets/spatial_db.hpp"
 #include "../../noxtypes.h"
 #include <algorithm>
+#include <unordered_set>
 
 using namespace nf;
 
@@ -20,6 +21,13 @@ namespace systems {
 		static bool first_run = true;
 		bool tile_removed = true;
 
+		// Tiles removed since the last tick; only the structure around them needs re-checking.
+		static std::vector<int> removed_tiles;
+
+		// A local search that grows beyond this gives up and falls back to the full-region solve.
+		constexpr std::size_t MAX_LOCAL_SEARCH = 250000;
+		constexpr int LAYER = REGION_WIDTH * REGION_HEIGHT;
+
 		static void check_if_new(const int &idx)
 		{
 			if (!considered[idx]) {
@@ -27,6 +35,21 @@ namespace systems {
 			}
 		}
 
+		static void collapse_tile(const int &idx)
+		{
+			const auto tiletypes = region::get_tile_types_array();
+			auto[tx, ty, tz] = idxmap(idx);
+			if (tiletypes->operator[](idx) == tile_type::TREE_TRUNK || tiletypes->operator[](idx) == tile_type::TREE_LEAF)
+			{
+				if (idx % 3 == 0) spawn_item_on_ground(tx, ty, tz, "wood_log", get_material_by_tag("wood"), 3, 100, 0, "");
+			} else
+			{
+				topology::spawn_mining_result(topology::perform_mining_message(idx, 0, tx, ty, tz));
+			}
+			region::make_open_space(idx);
+			region::recalc_box(tx, ty, tz, tx, ty, tz);
+		}
+
 		static void check_for_collapse()
 		{
 			if (first_run)
@@ -95,6 +118,9 @@ namespace systems {
 				}
 			}
 
+			// The local solver uses considered as its visited marker, and expects to find it clear
+			std::fill(considered.begin(), considered.end(), false);
+
 			std::vector<int> collapses;
 			for (auto idx=0; idx<REGION_TILES_COUNT; ++idx)
 			{
@@ -106,16 +132,140 @@ namespace systems {
 
 			for (const auto &idx : collapses)
 			{
-				auto[tx, ty, tz] = idxmap(idx);
-				if (tiletypes->operator[](idx) == tile_type::TREE_TRUNK || tiletypes->operator[](idx) == tile_type::TREE_LEAF)
+				collapse_tile(idx);
+			}
+		}
+
+		/*
+		 * Incremental solver. A tile is supported if the flood above can reach it. When a tile is removed,
+		 * the tiles it used to pass support to are re-checked by searching backwards (towards whatever could
+		 * support them) until reaching bedrock, a support column or a tile already confirmed this pass.
+		 * Searches prefer going down, so solid ground resolves in roughly z steps. If the search runs out
+		 * of tiles, everything it saw is unsupported and collapses - and whatever those tiles held up is
+		 * checked next.
+		 */
+
+		static inline bool passes_support_up(const uint8_t tt)
+		{
+			return tt != tile_type::OPEN_SPACE && tt != tile_type::FLOOR;
+		}
+
+		// The tiles a (non-floor) solid tile at idx hands support to
+		template <typename F>
+		static inline void each_dependent(const int &idx, F &&func)
+		{
+			auto[x, y, z] = idxmap(idx);
+			if (x > 0) func(idx - 1);
+			if (x < REGION_WIDTH - 1) func(idx + 1);
+			if (y > 0) func(idx - REGION_WIDTH);
+			if (y < REGION_HEIGHT - 1) func(idx + REGION_WIDTH);
+			if (z > 1) func(idx - LAYER);
+			if (z < REGION_DEPTH - 1) func(idx + LAYER);
+			if (z < REGION_DEPTH - 1 && x > 0) func(idx + LAYER - 1);
+			if (z < REGION_DEPTH - 1 && x < REGION_WIDTH - 1) func(idx + LAYER + 1);
+			if (z < REGION_DEPTH - 1 && y > 0) func(idx + LAYER - REGION_WIDTH);
+			if (z < REGION_DEPTH - 1 && y < REGION_HEIGHT - 1) func(idx + LAYER + REGION_WIDTH);
+		}
+
+		// The tiles that could hand support to idx; pushed so that the tile below is visited first.
+		template <typename F>
+		static inline void each_supporter(const int &idx, const std::vector<uint8_t> &tiletypes, F &&func)
+		{
+			auto[x, y, z] = idxmap(idx);
+			if (x > 0 && tiletypes[idx - 1] != tile_type::OPEN_SPACE) func(idx - 1);
+			if (x < REGION_WIDTH - 1 && tiletypes[idx + 1] != tile_type::OPEN_SPACE) func(idx + 1);
+			if (y > 0 && tiletypes[idx - REGION_WIDTH] != tile_type::OPEN_SPACE) func(idx - REGION_WIDTH);
+			if (y < REGION_HEIGHT - 1 && tiletypes[idx + REGION_WIDTH] != tile_type::OPEN_SPACE) func(idx + REGION_WIDTH);
+			if (z > 0 && z < REGION_DEPTH - 1 && passes_support_up(tiletypes[idx + LAYER])) func(idx + LAYER);
+			if (z > 0) {
+				if (x > 0 && passes_support_up(tiletypes[idx - LAYER - 1])) func(idx - LAYER - 1);
+				if (x < REGION_WIDTH - 1 && passes_support_up(tiletypes[idx - LAYER + 1])) func(idx - LAYER + 1);
+				if (y > 0 && passes_support_up(tiletypes[idx - LAYER - REGION_WIDTH])) func(idx - LAYER - REGION_WIDTH);
+				if (y < REGION_HEIGHT - 1 && passes_support_up(tiletypes[idx - LAYER + REGION_WIDTH])) func(idx - LAYER + REGION_WIDTH);
+				if (passes_support_up(tiletypes[idx - LAYER])) func(idx - LAYER);
+			}
+		}
+
+		static bool check_for_collapse_locally()
+		{
+			const auto &tiletypes = *region::get_tile_types_array();
+
+			// Support columns (and everything next to them) are anchors, as are the bottom of the map and the corner seed
+			std::unordered_set<int> anchors;
+			bengine::each<construct_support_t, position_t>([&anchors](bengine::entity_t &e, construct_support_t &s, position_t &pos)
+			{
+				const auto idx = mapidx(pos);
+				anchors.insert(idx);
+				each_dependent(idx, [&anchors](const int &n) { anchors.insert(n); });
+			});
+			const auto is_anchor = [&anchors](const int &idx) {
+				return idx == 0 || idx < LAYER || anchors.find(idx) != anchors.end();
+			};
+
+			std::vector<int> candidates;
+			for (const auto &idx : removed_tiles)
+			{
+				candidates.emplace_back(idx);
+				each_dependent(idx, [&candidates](const int &n) { candidates.emplace_back(n); });
+			}
+			removed_tiles.clear();
+
+			std::unordered_set<int> confirmed;
+			std::vector<int> visited;
+			std::vector<int> search;
+			while (!candidates.empty())
+			{
+				const auto candidate = candidates.back();
+				candidates.pop_back();
+				if (tiletypes[candidate] == tile_type::OPEN_SPACE || confirmed.find(candidate) != confirmed.end()) continue;
+
+				// Search back towards something that is definitely supported
+				auto found_support = false;
+				search.clear();
+				search.emplace_back(candidate);
+				while (!search.empty() && !found_support)
 				{
-					if (idx % 3 == 0) spawn_item_on_ground(tx, ty, tz, "wood_log", get_material_by_tag("wood"), 3, 100, 0, "");
-				} else
+					const auto idx = search.back();
+					search.pop_back();
+					if (considered[idx]) continue;
+					considered[idx] = true;
+					visited.emplace_back(idx);
+
+					if (is_anchor(idx) || confirmed.find(idx) != confirmed.end()) {
+						found_support = true;
+					}
+					else if (visited.size() > MAX_LOCAL_SEARCH) {
+						// Too big to reason about locally
+						for (const auto &v : visited) considered[v] = false;
+						return false;
+					}
+					else {
+						each_supporter(idx, tiletypes, [&search](const int &n) { if (!considered[n]) search.emplace_back(n); });
+					}
+				}
+
+				if (found_support)
 				{
-					topology::spawn_mining_result(topology::perform_mining_message(idx, 0, tx, ty, tz));
+					confirmed.insert(candidate);
+					supported[candidate] = true;
 				}
-				region::make_open_space(idx);
+				else
+				{
+					// Nothing that could hold up the candidate is itself held up: bring it all down
+					std::sort(visited.begin(), visited.end());
+					for (const auto &idx : visited)
+					{
+						if (tiletypes[idx] == tile_type::OPEN_SPACE) continue;
+						supported[idx] = false;
+						collapse_tile(idx);
+						each_dependent(idx, [&candidates](const int &n) { candidates.emplace_back(n); });
+					}
+				}
+
+				for (const auto &v : visited) considered[v] = false;
+				visited.clear();
 			}
+			return true;
 		}
 
 		static void start_falling()
@@ -175,8 +325,7 @@ namespace systems {
 							}
 
 							// What else is here?
-							const auto also_here = entity_octree.find_by_loc(octree_location_t{ pos.x, pos.y, pos.z, 0 });
-							for (const auto &victim : also_here)
+							entity_octree.find_by_loc(octree_location_t{ pos.x, pos.y, pos.z, 0 }, [&e, &fall_damage](const int &victim)
 							{
 								if (victim != e.id)
 								{
@@ -190,7 +339,7 @@ namespace systems {
 										}
 									}
 								}
-							}
+							});
 						}
 					}
 				}
@@ -202,10 +351,26 @@ namespace systems {
 			tile_removed = true;
 		}
 
+		void tile_was_removed(const int &idx)
+		{
+			removed_tiles.emplace_back(idx);
+		}
+
+		void reset()
+		{
+			std::fill(supported.begin(), supported.end(), false);
+			removed_tiles.clear();
+			tile_removed = true;
+		}
+
 		void run(const double &duration_ms) {
+			if (!tile_removed && !removed_tiles.empty()) {
+				if (!check_for_collapse_locally()) tile_removed = true;
+			}
 			if (tile_removed) {
 				check_for_collapse();
 				tile_removed = false;
+				removed_tiles.clear();
 			}
 			start_falling();
 			fall();
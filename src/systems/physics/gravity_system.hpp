@@ -7,6 +7,11 @@ namespace systems {
 	namespace gravity {
 		void run(const double &duration_ms);
 		extern std::array<bool, nf::REGION_TILES_COUNT> supported;
+		/* Something changed that could affect support anywhere; re-solve the whole region. */
 		void tile_was_removed();
+		/* The tile at idx was removed; only the structure around it is re-checked. */
+		void tile_was_removed(const int &idx);
+		/* Forgets the last solve; the next run re-solves the whole region. */
+		void reset();
 	}
 }
@@ -1,12 +1,15 @@
 #include "movement_system.hpp"
 #include "../../planet/region/region.hpp"
 #include "../../global_assets/rng.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../../global_assets/spatial_db.hpp"
 #include "trigger_system.hpp"
 #include "visibility_system.hpp"
 #include "../../global_assets/game_ecs.hpp"
+#include "../../utils/thread_pool.hpp"
 #include "../../noxtypes.h"
+#include <algorithm>
+#include <vector>
 
 using namespace tile_flags;
 using namespace nf;
@@ -41,11 +44,10 @@ namespace systems {
 			int charge_to_id;
 		};		
 
-		thread_safe_message_queue<entity_wants_to_move_message> move_requests;
-		thread_safe_message_queue<entity_wants_to_move_randomly_message> wander_requests;
-		thread_safe_message_queue<entity_wants_to_charge_message> charge_requests;
-		thread_safe_message_queue<entity_wants_to_flee_message> flee_requests;
-		thread_safe_message_queue<entity_moved_message> move_completions;
+		mpsc_message_queue<entity_wants_to_move_message> move_requests;
+		mpsc_message_queue<entity_wants_to_move_randomly_message> wander_requests;
+		mpsc_message_queue<entity_wants_to_charge_message> charge_requests;
+		mpsc_message_queue<entity_wants_to_flee_message> flee_requests;
 
 		void move_to(bengine::entity_t &e, const position_t &pos, const position_t &dest) {
 			move_requests.enqueue(entity_wants_to_move_message{ e.id, dest });
@@ -63,23 +65,98 @@ namespace systems {
 			wander_requests.enqueue(entity_wants_to_move_randomly_message{ id });
 		}
 
-		void process_wandering() {
-			using namespace bengine;
-			using namespace region;
+		/*
+		 * Every movement request is collected into one batch per tick. The batch is resolved against the region's
+		 * walkability flags (in parallel for big batches - resolution only reads the map and its own intent), then
+		 * applied serially in a fixed order, and finally the octree, entry triggers and visibility are updated in
+		 * one pass over everything that moved.
+		 *
+		 * Intents are numbered in the order they are gathered: fleeing, charging, explicit moves, then wandering.
+		 * An entity moves at most once per tick; if it asked more than once, the lowest numbered intent that
+		 * resolves to a legal move wins. That makes the outcome independent of how the batch was split up.
+		 */
+		enum movement_intent_type_t : uint8_t { INTENT_FLEE, INTENT_CHARGE, INTENT_MOVE, INTENT_WANDER };
+
+		struct movement_intent_t {
+			int entity_id;
+			movement_intent_type_t type;
+			int direction;				// Pre-rolled d10 for wandering
+			position_t origin;
+			position_t target;			// Destination for moves, the other entity's position for fleeing/charging
+			position_t destination;		// Filled in by resolution
+			bool valid;
+			bool wants_wander;			// Fleeing or charging had nowhere to go; wander next tick instead
+		};
+
+		static std::vector<movement_intent_t> intents;
+		constexpr int PARALLEL_BATCH_SIZE = 256;
 
-			wander_requests.process_all([](entity_wants_to_move_randomly_message msg) {
-				const auto e = entity(msg.entity_id);
-				const auto original = e->component<position_t>();
-				if (!original) return;
+		static void add_intent(const int &entity_id, const movement_intent_type_t &type, const position_t &target, const int &direction) {
+			const auto e = bengine::entity(entity_id);
+			if (!e) return;
+			const auto pos = e->component<position_t>();
+			if (!pos) return;
+			intents.emplace_back(movement_intent_t{ entity_id, type, direction, *pos, target, *pos, false, false });
+		}
 
-				auto dest = position_t{};
-				dest.x = original->x;
-				dest.y = original->y;
-				dest.z = original->z;
+		static void gather_intents() {
+			using namespace bengine;
 
-				const auto tile_index = mapidx(dest.x, dest.y, dest.z);
+			intents.clear();
+			flee_requests.process_all([](entity_wants_to_flee_message &msg) {
+				const auto other = entity(msg.flee_from_id);
+				const auto other_pos = other ? other->component<position_t>() : nullptr;
+				if (other_pos) add_intent(msg.entity_id, INTENT_FLEE, *other_pos, 0);
+			});
+			charge_requests.process_all([](entity_wants_to_charge_message &msg) {
+				const auto other = entity(msg.charge_to_id);
+				const auto other_pos = other ? other->component<position_t>() : nullptr;
+				if (other_pos) add_intent(msg.entity_id, INTENT_CHARGE, *other_pos, 0);
+			});
+			move_requests.process_all([](entity_wants_to_move_message &msg) {
+				add_intent(msg.entity_id, INTENT_MOVE, msg.destination, 0);
+			});
+			wander_requests.process_all([](entity_wants_to_move_randomly_message &msg) {
+				// Rolled here, in arrival order, so that resolution order can't change the RNG stream
 				const auto direction = rng.roll_dice(1, 10);
-				switch (direction) {
+				add_intent(msg.entity_id, INTENT_WANDER, position_t{}, direction);
+			});
+		}
+
+		static inline bool in_movement_bounds(const position_t &p) noexcept {
+			return p.x >= 1 && p.x <= REGION_WIDTH - 1 && p.y >= 1 && p.y <= REGION_HEIGHT - 1 && p.z >= 1 && p.z <= REGION_DEPTH - 1;
+		}
+
+		static void resolve_intent(movement_intent_t &intent) {
+			using namespace region;
+
+			const auto &pos = intent.origin;
+			const auto tile_index = mapidx(pos.x, pos.y, pos.z);
+			auto &dest = intent.destination;
+			dest = position_t{ pos.x, pos.y, pos.z };
+
+			switch (intent.type) {
+			case INTENT_MOVE: {
+				dest = position_t{ intent.target.x, intent.target.y, intent.target.z };
+			} break;
+			case INTENT_FLEE: {
+				const auto &other = intent.target;
+				if (pos.x > other.x && flag(tile_index, CAN_GO_EAST)) dest.x++;
+				else if (pos.x < other.x && flag(tile_index, CAN_GO_WEST)) dest.x--;
+				else if (pos.y < other.y && flag(tile_index, CAN_GO_NORTH)) dest.y--;
+				else if (pos.y > other.y && flag(tile_index, CAN_GO_SOUTH)) dest.y++;
+				else intent.wants_wander = true;
+			} break;
+			case INTENT_CHARGE: {
+				const auto &other = intent.target;
+				if (pos.x > other.x && flag(tile_index, CAN_GO_WEST)) dest.x--;
+				else if (pos.x < other.x && flag(tile_index, CAN_GO_EAST)) dest.x++;
+				else if (pos.y < other.y && flag(tile_index, CAN_GO_SOUTH)) dest.y++;
+				else if (pos.y > other.y && flag(tile_index, CAN_GO_NORTH)) dest.y--;
+				else intent.wants_wander = true;
+			} break;
+			case INTENT_WANDER: {
+				switch (intent.direction) {
 				case 1: if (flag(tile_index, CAN_GO_UP)) dest.z++; break;
 				case 2: if (flag(tile_index, CAN_GO_DOWN)) dest.z--; break;
 				case 3: if (flag(tile_index, CAN_GO_NORTH)) dest.y--; break;
@@ -91,183 +168,159 @@ namespace systems {
 				case 9: if (flag(tile_index, CAN_GO_SOUTH_EAST)) { dest.y++; dest.x++; } break;
 				case 10: if (flag(tile_index, CAN_GO_SOUTH_WEST)) { dest.y++; dest.x--; } break;
 				}
-
+				if (dest == pos || !in_movement_bounds(dest)) return;
 				const auto destidx = mapidx(dest);
-				if (flag(destidx, CAN_STAND_HERE) && destidx != tile_index) {
-					auto can_go = true;
-
-					if (water_level(destidx)>2 && water_level(tile_index)<3) can_go = false;
+				if (!flag(destidx, CAN_STAND_HERE)) return;
+				if (water_level(destidx)>2 && water_level(tile_index)<3) return;
+			} break;
+			}
 
-					if (can_go) move_to(*e, *original, dest);
-				}
-			});
+			intent.valid = !intent.wants_wander && !(dest == pos) && in_movement_bounds(dest);
 		}
 
-		void process_movement() {
-			using namespace bengine;
-			using namespace region;
-			move_requests.process_all([](entity_wants_to_move_message msg) {
-				if (!entity(msg.entity_id)) {
-					//glog(log_target::GAME, log_severity::warning, "Oops - move request for entity {0}, but entity does not exist!", msg.entity_id);
-					return;
-				}
-				auto epos = entity(msg.entity_id)->component<position_t>();
-				if (!epos) {
-					//glog(log_target::GAME, log_severity::warning, "Oops - move request for entity {0}, but entity does not have a position!", msg.entity_id);
-					return;
-				}
-				position_t origin{ epos->x, epos->y, epos->z };
-				if (origin == msg.destination) {
-					//glog(log_target::GAME, log_severity::warning, "Oops - Moving to same tile, entity {0}", msg.entity_id);
-					return;
-				}
-
-				// Bounds check
-				if (msg.destination.x < 1 || msg.destination.x > REGION_WIDTH - 1 || msg.destination.y < 1 ||
-					msg.destination.y > REGION_HEIGHT - 1
-					|| msg.destination.z < 1 || msg.destination.z > REGION_DEPTH - 1)
-					return;
-
-				// Add sliding effect
-				auto slide = entity(msg.entity_id)->component<slidemove_t>();
-				auto initiative = entity(msg.entity_id)->component<initiative_t>();
-
-				const auto d_x = msg.destination.x - epos->x;
-				const auto d_y = msg.destination.y - epos->y;
-				const auto d_z = msg.destination.z - epos->z;
-				if (d_x > 0 && d_y > 0) {
-					// South-East
-					epos->rotation = 315;
-				}
-				else if (d_x > 0 && d_y < 0) {
-					// North-East
-					epos->rotation = 225;
-				}
-				else if (d_x < 0 && d_y < 0 ) {
-					// North-West
-					epos->rotation = 135;
-				}
-				else if (d_x < 0 && d_y > 0) {
-					// South-West
-					epos->rotation = 45;
-				}
-				else if (d_x > 0) {
-					// East
-					epos->rotation = 270;
-				}
-				else if (d_x < 0) {
-					// West
-					epos->rotation = 90;
-				}
-				else if (d_y < 0) {
-					// North
-					epos->rotation = 180;
-				}
-				else if (d_y > 0) {
-					// South
-					epos->rotation = 0;
-				}
-
-				if (initiative) {
-					const auto deltaX = (float)d_x / (float)initiative->initiative;
-					const auto deltaY = (float)d_y / (float)initiative->initiative;
-					const auto deltaZ = (float)d_z / (float)initiative->initiative;
-
-					if (!slide && initiative) {
-						entity(msg.entity_id)->assign(slidemove_t{ deltaX, deltaY, deltaZ, initiative->initiative });
-					}
-					else if (slide && initiative) {
-						slide->offsetX = deltaX;
-						slide->offsetY = deltaY;
-						slide->offsetZ = deltaZ;
-						slide->lifespan = initiative->initiative;
-					}
-				}
-
-				// Move
-				epos->x = msg.destination.x;
-				epos->y = msg.destination.y;
-				epos->z = msg.destination.z;
-				epos->offset_x = 0.0F - (float)d_x;
-				epos->offset_y = 0.0F - (float)d_y;
-				epos->offset_z = 0.0F - (float)d_z;
-
-				// Do vegetation damage
-				const auto idx = mapidx(msg.destination.x, msg.destination.y, msg.destination.z);
-				if (veg_type(idx) > 0) {
-					// TODO: emit_deferred(vegetation_damage_message{ idx, 1 });
-				}
-
-				auto mounted = entity(msg.entity_id)->component<riding_t>();
-				if (mounted) {
-					auto mount_pos = entity(mounted->riding)->component<position_t>();
-					mount_pos->x = epos->x;
-					mount_pos->y = epos->y;
-					mount_pos->z = epos->z;
-					mount_pos->offset_x = epos->offset_x;
-					mount_pos->offset_y = epos->offset_y;
-					mount_pos->offset_z = epos->offset_z;
-					mount_pos->rotation = epos->rotation;
-				}
+		static void resolve_intents() {
+			const auto n_intents = static_cast<int>(intents.size());
+			if (n_intents < PARALLEL_BATCH_SIZE * 2) {
+				for (auto &intent : intents) resolve_intent(intent);
+				return;
+			}
 
-				move_completions.enqueue(entity_moved_message{ msg.entity_id, origin, msg.destination });
+			const auto n_batches = (n_intents + PARALLEL_BATCH_SIZE - 1) / PARALLEL_BATCH_SIZE;
+			worker_pool().parallel_for(0, n_batches, [n_intents](int batch) {
+				const auto end = std::min(n_intents, (batch + 1) * PARALLEL_BATCH_SIZE);
+				for (int i = batch * PARALLEL_BATCH_SIZE; i < end; ++i) resolve_intent(intents[i]);
 			});
 		}
 
-		void process_fleeing() {
+		static void apply_move(const movement_intent_t &intent, position_t * epos) {
 			using namespace bengine;
-			using namespace region;
 
-			flee_requests.process_all([](entity_wants_to_flee_message msg) {
-				auto pos = entity(msg.entity_id)->component<position_t>();
-				auto other_pos = entity(msg.flee_from_id)->component<position_t>();
-				if (!pos || !other_pos) return;
+			auto e = entity(intent.entity_id);
+			const auto &destination = intent.destination;
+			const auto d_x = destination.x - epos->x;
+			const auto d_y = destination.y - epos->y;
+			const auto d_z = destination.z - epos->z;
+			if (d_x > 0 && d_y > 0) {
+				// South-East
+				epos->rotation = 315;
+			}
+			else if (d_x > 0 && d_y < 0) {
+				// North-East
+				epos->rotation = 225;
+			}
+			else if (d_x < 0 && d_y < 0 ) {
+				// North-West
+				epos->rotation = 135;
+			}
+			else if (d_x < 0 && d_y > 0) {
+				// South-West
+				epos->rotation = 45;
+			}
+			else if (d_x > 0) {
+				// East
+				epos->rotation = 270;
+			}
+			else if (d_x < 0) {
+				// West
+				epos->rotation = 90;
+			}
+			else if (d_y < 0) {
+				// North
+				epos->rotation = 180;
+			}
+			else if (d_y > 0) {
+				// South
+				epos->rotation = 0;
+			}
 
-				if (pos->x > other_pos->x && flag(mapidx(pos->x, pos->y, pos->z), CAN_GO_EAST)) {
-					move_requests.enqueue(entity_wants_to_move_message{ msg.entity_id, position_t{ pos->x + 1, pos->y, pos->z } });
-				}
-				else if (pos->x < other_pos->x && flag(mapidx(pos->x, pos->y, pos->z), CAN_GO_WEST)) {
-					move_requests.enqueue(entity_wants_to_move_message{ msg.entity_id, position_t{ pos->x - 1, pos->y, pos->z } });
-				}
-				else if (pos->y < other_pos->y && flag(mapidx(pos->x, pos->y, pos->z), CAN_GO_NORTH)) {
-					move_requests.enqueue(entity_wants_to_move_message{ msg.entity_id, position_t{ pos->x, pos->y - 1, pos->z } });
-				}
-				else if (pos->y > other_pos->y && flag(mapidx(pos->x, pos->y, pos->z), CAN_GO_SOUTH)) {
-					move_requests.enqueue(entity_wants_to_move_message{ msg.entity_id, position_t{ pos->x, pos->y + 1, pos->z } });
+			// Add sliding effect
+			auto slide = e->component<slidemove_t>();
+			auto initiative = e->component<initiative_t>();
+			if (initiative) {
+				const auto deltaX = (float)d_x / (float)initiative->initiative;
+				const auto deltaY = (float)d_y / (float)initiative->initiative;
+				const auto deltaZ = (float)d_z / (float)initiative->initiative;
+
+				if (!slide) {
+					e->assign(slidemove_t{ deltaX, deltaY, deltaZ, initiative->initiative });
 				}
 				else {
-					wander_requests.enqueue(entity_wants_to_move_randomly_message{ msg.entity_id });
+					slide->offsetX = deltaX;
+					slide->offsetY = deltaY;
+					slide->offsetZ = deltaZ;
+					slide->lifespan = initiative->initiative;
 				}
-			});
-		}
+			}
 
-		void process_charging() {
-			using namespace bengine;
-			using namespace region;
+			// Move
+			epos->x = destination.x;
+			epos->y = destination.y;
+			epos->z = destination.z;
+			epos->offset_x = 0.0F - (float)d_x;
+			epos->offset_y = 0.0F - (float)d_y;
+			epos->offset_z = 0.0F - (float)d_z;
+
+			// Do vegetation damage
+			const auto idx = mapidx(destination.x, destination.y, destination.z);
+			if (region::veg_type(idx) > 0) {
+				// TODO: emit_deferred(vegetation_damage_message{ idx, 1 });
+			}
 
-			charge_requests.process_all([](entity_wants_to_charge_message msg) {
-				auto pos = entity(msg.entity_id)->component<position_t>();
-				auto other_pos = entity(msg.charge_to_id)->component<position_t>();
+			auto mounted = e->component<riding_t>();
+			if (mounted) {
+				auto mount_pos = entity(mounted->riding)->component<position_t>();
+				mount_pos->x = epos->x;
+				mount_pos->y = epos->y;
+				mount_pos->z = epos->z;
+				mount_pos->offset_x = epos->offset_x;
+				mount_pos->offset_y = epos->offset_y;
+				mount_pos->offset_z = epos->offset_z;
+				mount_pos->rotation = epos->rotation;
+			}
+		}
 
-				if (pos->x > other_pos->x && flag(mapidx(pos->x, pos->y, pos->z), CAN_GO_WEST)) {
-					move_requests.enqueue(entity_wants_to_move_message{ msg.entity_id, position_t{ pos->x - 1, pos->y, pos->z } });
-				}
-				else if (pos->x < other_pos->x && flag(mapidx(pos->x, pos->y, pos->z), CAN_GO_EAST)) {
-					move_requests.enqueue(entity_wants_to_move_message{ msg.entity_id, position_t{ pos->x + 1, pos->y, pos->z } });
-				}
-				else if (pos->y < other_pos->y && flag(mapidx(pos->x, pos->y, pos->z), CAN_GO_SOUTH)) {
-					move_requests.enqueue(entity_wants_to_move_message{ msg.entity_id, position_t{ pos->x, pos->y + 1, pos->z } });
+		static void apply_intents(std::vector<entity_moved_message> &moved) {
+			using namespace bengine;
+			static std::vector<int> order;
+
+			// Group each entity's intents together, lowest numbered first, and keep the first legal one
+			order.resize(intents.size());
+			for (std::size_t i = 0; i < intents.size(); ++i) order[i] = static_cast<int>(i);
+			std::stable_sort(order.begin(), order.end(), [](const int &a, const int &b) { return intents[a].entity_id < intents[b].entity_id; });
+
+			std::size_t n_winners = 0;
+			for (std::size_t i = 0; i < order.size(); ) {
+				const auto id = intents[order[i]].entity_id;
+				int winner = -1;
+				bool wants_wander = false;
+				for (; i < order.size() && intents[order[i]].entity_id == id; ++i) {
+					const auto &intent = intents[order[i]];
+					if (winner < 0 && intent.valid) winner = order[i];
+					if (intent.wants_wander) wants_wander = true;
 				}
-				else if (pos->y > other_pos->y && flag(mapidx(pos->x, pos->y, pos->z), CAN_GO_NORTH)) {
-					move_requests.enqueue(entity_wants_to_move_message{ msg.entity_id, position_t{ pos->x, pos->y - 1, pos->z } });
+				if (winner >= 0) {
+					order[n_winners++] = winner;
 				}
-				else {
-					wander_requests.enqueue(entity_wants_to_move_randomly_message{ msg.entity_id });
+				else if (wants_wander) {
+					wander_requests.enqueue(entity_wants_to_move_randomly_message{ id });
 				}
-			});
+			}
+			order.resize(n_winners);
+			std::sort(order.begin(), order.end());
+
+			for (const auto &i : order) {
+				const auto &intent = intents[i];
+				auto e = entity(intent.entity_id);
+				if (!e) continue;
+				auto epos = e->component<position_t>();
+				if (!epos) continue;
+				const position_t origin{ epos->x, epos->y, epos->z };
+				apply_move(intent, epos);
+				moved.emplace_back(entity_moved_message{ intent.entity_id, origin, intent.destination });
+			}
 		}
 
-		void update_octree() {
+		static void update_octree(std::vector<entity_moved_message> &moved) {
 			using namespace bengine;
 
 			if (entity_octree.total_nodes == 0) {
@@ -276,28 +329,28 @@ namespace systems {
 				});
 			}
 
-			move_completions.process_all([](entity_moved_message msg) {
+			for (auto &msg : moved) {
 				octree_location_t start = octree_location_t{ static_cast<int>(msg.origin.x), static_cast<int>(msg.origin.y), msg.origin.z, msg.entity_id };
 				octree_location_t end = octree_location_t{ static_cast<int>(msg.destination.x), static_cast<int>(msg.destination.y), msg.destination.z, msg.entity_id };
-				entity_octree.remove_node(start);
-				entity_octree.add_node(end);
+				entity_octree.move_node(start, end);
 
-				auto e = entity(msg.entity_id);
 				// TODO: Map update notifications
 				//if (e && e->component<settler_ai_t>()) {
 				//	emit(settler_moved_message{});
 
 				triggers::entry_trigger_firing(msg);
 				visibility::on_entity_moved(msg.entity_id);
-			});
-
+			}
 		}
 
 		void run(const double &duration_ms) {
-			process_wandering();
-			process_movement();
-			process_fleeing();
-			update_octree();
+			static std::vector<entity_moved_message> moved;
+
+			gather_intents();
+			resolve_intents();
+			moved.clear();
+			apply_intents(moved);
+			update_octree(moved);
 		}
 	}
-}
\ No newline at end of file
+}
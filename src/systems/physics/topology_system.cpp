@@ -1,6 +1,6 @@
 #include "topology_system.hpp"
 #include "../../global_assets/game_ecs.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../../planet/region/region.hpp"
 #include "../../raws/items.hpp"
 #include "../../raws/defs/item_def_t.hpp"
@@ -36,8 +36,8 @@ namespace systems {
 			std::size_t material = 0;
 		};		
 
-		static thread_safe_message_queue<perform_construction_message> construction;
-		static thread_safe_message_queue<perform_mining_message> mining;
+		static mpsc_message_queue<perform_construction_message> construction;
+		static mpsc_message_queue<perform_mining_message> mining;
 
 		void perform_mining(const int idx, const int op, const int x, const int y, const int z) {
 			mining.enqueue(perform_mining_message{ idx, static_cast<uint8_t>(op), x, y, z });
@@ -50,7 +50,7 @@ namespace systems {
 		static void dig(const perform_mining_message &e) {
 			make_floor(e.target_idx);
 			//auto &[x,y,z] = idxmap(e.target_idx);
-			gravity::tile_was_removed();
+			gravity::tile_was_removed(e.target_idx);
 		}
 
 		static void channel(const perform_mining_message &e) {
@@ -61,7 +61,7 @@ namespace systems {
 			if (flag(below, SOLID)) {
 				make_ramp(below);
 			}
-			gravity::tile_was_removed();
+			gravity::tile_was_removed(e.target_idx);
 		}
 
 		static void ramp(const perform_mining_message &e) {
@@ -71,23 +71,24 @@ namespace systems {
 			if (flag(above, SOLID)) {
 				make_open_space(above);
 				set_flag(above, CAN_STAND_HERE);
+				gravity::tile_was_removed(above);
 			}
-			gravity::tile_was_removed();
+			gravity::tile_was_removed(e.target_idx);
 		}
 
 		static void stairs_up(const perform_mining_message &e) {
 			make_stairs_up(e.target_idx);
-			gravity::tile_was_removed();
+			gravity::tile_was_removed(e.target_idx);
 		}
 
 		static void stairs_down(const perform_mining_message &e) {
 			make_stairs_down(e.target_idx);
-			gravity::tile_was_removed();
+			gravity::tile_was_removed(e.target_idx);
 		}
 
 		static void stairs_updown(const perform_mining_message &e) {
 			make_stairs_updown(e.target_idx);
-			gravity::tile_was_removed();
+			gravity::tile_was_removed(e.target_idx);
 		}
 
 		static void recalculate(const perform_mining_message &e) {
@@ -96,12 +97,12 @@ namespace systems {
 					for (int X = -2; X<3; ++X) {
 						if (e.x + X > 0 && e.x + X < REGION_WIDTH && e.y + Y > 0 && e.y + Y < REGION_HEIGHT && e.z + Z > 0 && e.z + Z<REGION_DEPTH) {
 							reveal(mapidx(e.x + X, e.y + Y, e.z + Z));
-							tile_calculate(e.x + X, e.y + Y, e.z + Z);
-							region::mark_chunk_dirty_by_tileidx(mapidx(e.x + X, e.y + Y, e.z + Z));
 						}
 					}
 				}
 			}
+			// Ramps also open the tile above the target
+			recalc_box(e.x, e.y, e.z, e.x, e.y, e.z + 1);
 		}
 
 		static void spawn_mining_result_impl(const perform_mining_message &e, const std::string &tag) {
@@ -186,14 +187,7 @@ namespace systems {
 				}
 			}
 
-			tile_calculate(construction_pos->x, construction_pos->y, construction_pos->z);
-			for (auto inner_z = -2; inner_z<3; ++inner_z) {
-				for (auto inner_y = -2; inner_y<3; ++inner_y) {
-					for (auto inner_x = -2; inner_x<3; ++inner_x) {
-						tile_calculate(construction_pos->x + inner_x, construction_pos->y + inner_y, construction_pos->z + inner_z);
-					}
-				}
-			}
+			recalc_box(construction_pos->x, construction_pos->y, construction_pos->z, construction_pos->x, construction_pos->y, construction_pos->z);
 			//particles::block_destruction_effect(construction_pos->x, construction_pos->y, construction_pos->z, 1.0f, 1.0f, 1.0f, particles::PARTICLE_LUMBERJACK);
 
 			if (entity_should_be_deleted) {
@@ -15,6 +15,9 @@
 #include "../../global_assets/rng.hpp"
 #include "gravity_system.hpp"
 #include "../../noxtypes.h"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
 
 using namespace bengine;
 using namespace nf;
@@ -48,6 +51,7 @@ namespace systems {
 			triggers_changed.process_all([](triggers_changed_message &msg) {
 				//std::cout << "Received trigger notification\n";
 				dirty = true;
+				dependencies_changed = true;
 			});
 
 			if (dirty) {
@@ -129,7 +133,7 @@ namespace systems {
 
 					// Remove the trap
 					delete_entity(trigger_entity->id);
-					triggers_changed.enqueue(triggers_changed_message{});
+					triggers.erase(tile_index);
 				}
 			}
 		}
@@ -155,7 +159,7 @@ namespace systems {
 
 					// Remove the trap
 					delete_entity(trigger_entity->id);
-					triggers_changed.enqueue(triggers_changed_message{});
+					triggers.erase(tile_index);
 				}
 			}
 		}
@@ -299,253 +303,377 @@ namespace systems {
 			});
 		}
 
-		static std::map<int, std::vector<int>> affects;
-
-		static void calc_dependency()
+		/*
+		 * The circuit network (levers, plates, sensors, oscillators -> gates -> doors, bridges, spikes and supports)
+		 * compiled into flat arrays. Nodes are stored in topological order, so a single pass in index order sees
+		 * every gate after all of its inputs. Inputs and outputs are ranges into shared edge arrays, and the last
+		 * known output of every node is kept in state, so evaluating a gate never has to look up its senders.
+		 */
+		struct circuit_node_t {
+			int entity_id = 0;
+			bool is_gate = false;
+			bool is_actuator = false;
+			processor_type_t processor = AND;
+			int input_begin = 0;
+			int input_end = 0;
+			int output_begin = 0;
+			int output_end = 0;
+		};
+
+		static std::vector<circuit_node_t> circuit_nodes;
+		static std::vector<int> circuit_inputs;
+		static std::vector<int> circuit_outputs;
+		static std::vector<uint8_t> circuit_state;
+		static std::unordered_map<int, int> circuit_node_of;
+
+		// Per-tick evaluation scratch; only the nodes a tick touches are ever reset
+		static std::vector<uint8_t> circuit_queued;
+		static std::vector<uint8_t> circuit_evaluated;
+		static std::vector<int> circuit_trigger;
+		static std::vector<int> circuit_touched;
+		static std::priority_queue<int, std::vector<int>, std::greater<int>> circuit_frontier;
+
+		// Signals that fed back into a node already evaluated this tick (a loop) are delivered next tick: <target, sender>
+		static std::vector<std::pair<int, int>> circuit_deferred;
+
+		static void compile_circuits()
 		{
 			dependencies_changed = false;
-			affects.clear();
-			each<receives_signal_t>([] (entity_t &e, receives_signal_t &s)
+
+			// Gather the edges, skipping any whose sender no longer exists
+			std::vector<std::pair<int, int>> edges; // sender id, receiver id
+			std::unordered_map<int, int> index_of;
+			std::vector<int> ids;
+			auto node_index = [&index_of, &ids](const int &id) {
+				const auto finder = index_of.find(id);
+				if (finder != index_of.end()) return finder->second;
+				const auto idx = static_cast<int>(ids.size());
+				index_of[id] = idx;
+				ids.emplace_back(id);
+				return idx;
+			};
+			each<receives_signal_t>([&edges, &node_index] (entity_t &e, receives_signal_t &s)
 			{
 				for (const auto &r : s.receives_from)
 				{
-					affects[std::get<0>(r)].emplace_back(e.id);
+					const auto sender_id = std::get<0>(r);
+					const auto sender = entity(sender_id);
+					if (!sender || !sender->component<sends_signal_t>()) continue;
+					node_index(sender_id);
+					node_index(e.id);
+					edges.emplace_back(std::make_pair(sender_id, e.id));
 				}
 			});
-		}
 
-		static void and_gate(entity_t * circuit_entity, signal_processor_t * cp)
-		{
-			auto all_set = true;
-			const auto receiver = circuit_entity->component<receives_signal_t>();
-			for (const auto &n : receiver->receives_from)
+			// Kahn's algorithm, lowest entity id first so the order is stable. Anything left over is part of a loop,
+			// and goes on the end in id order.
+			const auto n_nodes = ids.size();
+			std::vector<std::vector<int>> outs(n_nodes);
+			std::vector<int> in_degree(n_nodes, 0);
+			for (const auto &edge : edges)
 			{
-				const auto r = entity(std::get<0>(n));
-				const auto s = r->component<sends_signal_t>();
-				if (!s->active) all_set = false;
+				const auto from = index_of[edge.first];
+				const auto to = index_of[edge.second];
+				outs[from].emplace_back(to);
+				++in_degree[to];
+			}
+			std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> ready;
+			for (std::size_t i = 0; i < n_nodes; ++i)
+			{
+				if (in_degree[i] == 0) ready.push(std::make_pair(ids[i], static_cast<int>(i)));
+			}
+			std::vector<int> order;
+			std::vector<uint8_t> placed(n_nodes, 0);
+			order.reserve(n_nodes);
+			while (!ready.empty())
+			{
+				const auto n = ready.top().second;
+				ready.pop();
+				order.emplace_back(n);
+				placed[n] = 1;
+				for (const auto &to : outs[n])
+				{
+					if (--in_degree[to] == 0) ready.push(std::make_pair(ids[to], to));
+				}
+			}
+			if (order.size() < n_nodes)
+			{
+				std::vector<std::pair<int, int>> looped;
+				for (std::size_t i = 0; i < n_nodes; ++i)
+				{
+					if (!placed[i]) looped.emplace_back(std::make_pair(ids[i], static_cast<int>(i)));
+				}
+				std::sort(looped.begin(), looped.end());
+				for (const auto &l : looped) order.emplace_back(l.second);
+			}
+			std::vector<int> rank(n_nodes);
+			for (std::size_t i = 0; i < order.size(); ++i) rank[order[i]] = static_cast<int>(i);
+
+			// Flatten into the compiled arrays
+			std::vector<std::vector<int>> ins(n_nodes);
+			for (const auto &edge : edges) ins[rank[index_of[edge.second]]].emplace_back(rank[index_of[edge.first]]);
+
+			circuit_nodes.clear();
+			circuit_inputs.clear();
+			circuit_outputs.clear();
+			circuit_node_of.clear();
+			circuit_nodes.resize(n_nodes);
+			circuit_state.assign(n_nodes, 0);
+			for (std::size_t i = 0; i < n_nodes; ++i)
+			{
+				auto &node = circuit_nodes[i];
+				const auto old_index = order[i];
+				node.entity_id = ids[old_index];
+				circuit_node_of[node.entity_id] = static_cast<int>(i);
+
+				node.input_begin = static_cast<int>(circuit_inputs.size());
+				circuit_inputs.insert(circuit_inputs.end(), ins[i].begin(), ins[i].end());
+				node.input_end = static_cast<int>(circuit_inputs.size());
+
+				node.output_begin = static_cast<int>(circuit_outputs.size());
+				for (const auto &to : outs[old_index]) circuit_outputs.emplace_back(rank[to]);
+				node.output_end = static_cast<int>(circuit_outputs.size());
+
+				auto e = entity(node.entity_id);
+				const auto sender = e->component<sends_signal_t>();
+				if (sender) circuit_state[i] = sender->active ? 1 : 0;
+				const auto cp = e->component<signal_processor_t>();
+				if (cp && node.input_end > node.input_begin)
+				{
+					node.is_gate = true;
+					node.processor = cp->processor;
+				}
+				const auto building = e->component<building_t>();
+				node.is_actuator = node.input_end > node.input_begin && (e->component<construct_door_t>() || e->component<bridge_t>() ||
+					(building && (building->tag == "spike_trap" || building->tag == "support")));
 			}
-			cp->active = all_set;
-			const auto sender = circuit_entity->component<sends_signal_t>();
-			sender->active = cp->active;
-			//std::cout << "AND gate state: " << sender->active << "\n";
-			nodes_changed.insert(circuit_entity->id);
+
+			circuit_queued.assign(n_nodes, 0);
+			circuit_evaluated.assign(n_nodes, 0);
+			circuit_trigger.assign(n_nodes, -1);
+			circuit_touched.clear();
 		}
 
-		static void or_gate(entity_t * circuit_entity, signal_processor_t * cp)
+		static bool gate_output(const processor_type_t &processor, const int &set_count, const int &input_count)
 		{
-			auto any_set = true;
-			const auto receiver = circuit_entity->component<receives_signal_t>();
-			for (const auto &n : receiver->receives_from)
+			switch (processor)
 			{
-				const auto r = entity(std::get<0>(n));
-				const auto s = r->component<sends_signal_t>();
-				if (s->active) any_set = true;
+			case AND: return set_count == input_count;
+			case OR: return set_count > 0;
+			case NOTGATE: return set_count != input_count;
+			case NAND: return set_count != input_count;
+			case NOR: return set_count == 0;
+			case XOR: return set_count == 0 || set_count == input_count;
 			}
-			cp->active = any_set;
-			const auto sender = circuit_entity->component<sends_signal_t>();
-			sender->active = cp->active;
-			nodes_changed.insert(circuit_entity->id);
+			return false;
 		}
 
-		static void not_gate(entity_t * circuit_entity, signal_processor_t * cp)
+		static inline void schedule_node(const int &n, const int &from)
 		{
-			auto all_set = true;
-			const auto receiver = circuit_entity->component<receives_signal_t>();
-			for (const auto &n : receiver->receives_from)
+			if (circuit_evaluated[n])
+			{
+				circuit_deferred.emplace_back(std::make_pair(circuit_nodes[n].entity_id, circuit_nodes[from].entity_id));
+				return;
+			}
+			circuit_trigger[n] = from;
+			if (!circuit_queued[n])
 			{
-				const auto r = entity(std::get<0>(n));
-				const auto s = r->component<sends_signal_t>();
-				if (!s->active) all_set = false;
+				circuit_queued[n] = 1;
+				circuit_touched.emplace_back(n);
+				circuit_frontier.push(n);
 			}
-			all_set = !all_set;
-			cp->active = all_set;
-			const auto sender = circuit_entity->component<sends_signal_t>();
-			sender->active = cp->active;
-			nodes_changed.insert(circuit_entity->id);
 		}
 
-		static void nand_gate(entity_t * circuit_entity, signal_processor_t * cp)
+		static inline void schedule_outputs(const int &n)
 		{
-			auto all_set = true;
-			const auto receiver = circuit_entity->component<receives_signal_t>();
-			for (const auto &n : receiver->receives_from)
-			{
-				const auto r = entity(std::get<0>(n));
-				const auto s = r->component<sends_signal_t>();
-				if (!s->active) all_set = false;
-			}
-			all_set = !all_set;
-			cp->active = all_set;
-			const auto sender = circuit_entity->component<sends_signal_t>();
-			sender->active = cp->active;
-			nodes_changed.insert(circuit_entity->id);
+			const auto &node = circuit_nodes[n];
+			for (int i = node.output_begin; i < node.output_end; ++i) schedule_node(circuit_outputs[i], n);
 		}
 
-		static void nor_gate(entity_t * circuit_entity, signal_processor_t * cp)
+		static void actuate_bridge(const int &id, bridge_t * bridge, const bool &active, std::vector<int> &changed_tiles)
 		{
-			auto any_set = true;
-			const auto receiver = circuit_entity->component<receives_signal_t>();
-			for (const auto &n : receiver->receives_from)
-			{
-				const auto r = entity(std::get<0>(n));
-				const auto s = r->component<sends_signal_t>();
-				if (s->active) any_set = true;
+			bridge->retracted = active;
+			const auto &bridge_tiles = region::bridge_tiles(id);
+			if (bridge->retracted) {
+				// Retract the bridge
+				for (const auto &i : bridge_tiles) {
+					make_open_space(i);
+					region::mark_chunk_dirty_by_tileidx(i);
+					gravity::tile_was_removed(i);
+				}
 			}
-			cp->active = !any_set;
-			const auto sender = circuit_entity->component<sends_signal_t>();
-			sender->active = cp->active;
-			nodes_changed.insert(circuit_entity->id);
+			else {
+				// Extend the bridge!
+				for (const auto &i : bridge_tiles) {
+					make_floor(i);
+					region::mark_chunk_dirty_by_tileidx(i);
+				}
+			}
+			changed_tiles.insert(changed_tiles.end(), bridge_tiles.begin(), bridge_tiles.end());
 		}
 
-		static void xor_gate(entity_t * circuit_entity, signal_processor_t * cp)
+		static void actuate_spikes(entity_t * circuit_entity, building_t * building, const bool &active)
 		{
-			auto set_count = 0;
-			const auto receiver = circuit_entity->component<receives_signal_t>();
-			for (const auto &n : receiver->receives_from)
-			{
-				const auto r = entity(std::get<0>(n));
-				const auto s = r->component<sends_signal_t>();
-				if (s->active) ++set_count;
+			const auto target_pos = circuit_entity->component<position_t>();
+			if (!target_pos) return;
+
+			if (active) {
+				building->vox_model = 130;
+				// Attack everything in the tile
+				const auto &[x, y, z] = idxmap(mapidx(*target_pos));
+				entity_octree.find_by_loc(octree_location_t{ x, y, z, 0 }, [](const int &v) {
+					auto victim_entity = entity(v);
+					if (victim_entity) {
+						const auto health = victim_entity->component<health_t>();
+						if (health) {
+							systems::damage_system::inflict_damage(systems::damage_system::inflict_damage_message{ v, rng.roll_dice(2,8), "Floor Spikes" });
+						}
+					}
+				});
+			}
+			else {
+				building->vox_model = 129;
 			}
-			cp->active = (set_count == 0 || set_count == receiver->receives_from.size());
-			const auto sender = circuit_entity->component<sends_signal_t>();
-			sender->active = cp->active;
-			nodes_changed.insert(circuit_entity->id);
 		}
 
-		static void evaluate_signal_processor(entity_t * circuit_entity, signal_processor_t * cp)
+		static void actuate_support(entity_t * circuit_entity)
 		{
-			// TODO: Processing
-
-			switch (cp->processor)
+			const auto rs = circuit_entity->component<receives_signal_t>();
+			for (auto &sender_id : rs->receives_from)
 			{
-			case AND: and_gate(circuit_entity, cp); break;
-			case OR:  or_gate(circuit_entity, cp);  break;
-			case NOTGATE: not_gate(circuit_entity, cp); break;
-			case NAND: nand_gate(circuit_entity, cp); break;
-			case NOR:  nor_gate(circuit_entity, cp); break;
-			case XOR: xor_gate(circuit_entity, cp); break;
+				const auto tmp_e = entity(std::get<0>(sender_id));
+				if (tmp_e)
+				{
+					const auto ss = tmp_e->component<sends_signal_t>();
+					if (ss)
+					{
+						ss->targets.erase(
+							std::remove_if(ss->targets.begin(), ss->targets.end(), [&sender_id](const auto &a) { return a == std::get<0>(sender_id); }),
+							ss->targets.end()
+						);
+					}
+				}
 			}
-			nodes_changed.insert(circuit_entity->id);
+			const auto support_pos = circuit_entity->component<position_t>();
+			if (support_pos) gravity::tile_was_removed(mapidx(*support_pos));
+			delete_entity(circuit_entity->id);
+			dependencies_changed = true;
 		}
 
-		static void evaluate_circuit_node(const int &id, const int &sender)
+		/*
+		 * Propagates this tick's flipped signals through the compiled graph. Only the outputs of changed nodes are
+		 * visited, in topological order; a gate passes the signal on only if its own output flips. Actuators are
+		 * collected as they are reached and applied together once the graph has settled, with a single tile
+		 * recalculation for every bridge that moved.
+		 */
+		static void run_circuits()
 		{
-			auto circuit_entity = entity(id);
-			if (!circuit_entity) return;
-			const auto cp = circuit_entity->component<signal_processor_t>();
-			if (cp)
-			{
-				// Evaluate signal propagation
-				evaluate_signal_processor(circuit_entity, cp);
-			}
-			const auto door = circuit_entity->component<construct_door_t>();
-			if (door)
-			{
-				// Evaluate door
-				const auto sender_e = entity(sender);
-				const auto sender_s = sender_e->component<sends_signal_t>();
-				door->locked = sender_s->active;
-				doors::doors_changed();
-			}
-			const auto bridge = circuit_entity->component<bridge_t>();
-			if (bridge)
+			static std::vector<std::pair<int, int>> actuations; // node, node that triggered it
+			static std::vector<int> changed_tiles;
+
+			if (nodes_changed.empty() && circuit_deferred.empty()) return;
+
+			// Seed with the sources that changed, and anything held over from a loop last tick
+			for (const auto &id : nodes_changed)
 			{
-				// Evaluate bridge
-				const auto sender_e = entity(sender);
-				const auto sender_s = sender_e->component<sends_signal_t>();
-				bridge->retracted = sender_s->active;
-				if (bridge->retracted) {
-					// Retract the bridge
-					for (auto i = 0; i<REGION_TILES_COUNT; ++i) {
-						if (bridge_id(i) == id) {
-							make_open_space(i);
-							region::mark_chunk_dirty_by_tileidx(i);
-						}
-					}
-				}
-				else {
-					// Extend the bridge!
-					for (int i = 0; i<REGION_TILES_COUNT; ++i) {
-						if (bridge_id(i) == id) {
-							make_floor(i);
-							region::mark_chunk_dirty_by_tileidx(i);
-						}
-					}
+				const auto finder = circuit_node_of.find(id);
+				if (finder == circuit_node_of.end()) continue;
+				const auto n = finder->second;
+				const auto e = entity(id);
+				const auto sender = e ? e->component<sends_signal_t>() : nullptr;
+				if (!sender)
+				{
+					dependencies_changed = true;
+					continue;
 				}
-				tile_recalc_all();
-				gravity::tile_was_removed();
+				circuit_state[n] = sender->active ? 1 : 0;
+				schedule_outputs(n);
 			}
-			const auto building = circuit_entity->component<building_t>();
-			if (building && building->tag == "spike_trap")
+			nodes_changed.clear();
+			if (!circuit_deferred.empty())
 			{
-				// Evaluate building; currently spike traps
-				const auto sender_e = entity(sender);
-				const auto sender_s = sender_e->component<sends_signal_t>();
-
-				const auto target_pos = circuit_entity->component<position_t>();
-				const auto receiver = circuit_entity->component<receives_signal_t>();
-
-				if (target_pos && receiver) {
-					if (sender_s->active) {
-						building->vox_model = 130;
-						// Attack everything in the tile
-						const auto &[x, y, z] = idxmap(mapidx(*target_pos));
-						auto visible_here = entity_octree.find_by_loc(octree_location_t{ x, y, z, 0 });
-						for (const auto &v : visible_here) {
-							auto victim_entity = entity(v);
-							if (victim_entity) {
-								const auto health = victim_entity->component<health_t>();
-								if (health) {
-									systems::damage_system::inflict_damage(systems::damage_system::inflict_damage_message{ v, rng.roll_dice(2,8), "Floor Spikes" });
-								}
-							}
-						}
-					}
-					else {
-						building->vox_model = 129;
-					}
+				std::vector<std::pair<int, int>> held;
+				std::swap(held, circuit_deferred);
+				for (const auto &d : held)
+				{
+					const auto target = circuit_node_of.find(d.first);
+					const auto from = circuit_node_of.find(d.second);
+					if (target != circuit_node_of.end() && from != circuit_node_of.end()) schedule_node(target->second, from->second);
 				}
-			} else if (building && building->tag == "support")
+			}
+
+			actuations.clear();
+			while (!circuit_frontier.empty())
 			{
-				const auto rs = circuit_entity->component<receives_signal_t>();
-				for (auto &sender_id : rs->receives_from)
+				const auto n = circuit_frontier.top();
+				circuit_frontier.pop();
+				circuit_queued[n] = 0;
+				circuit_evaluated[n] = 1;
+				const auto &node = circuit_nodes[n];
+
+				if (node.is_gate)
 				{
-					const auto tmp_e = entity(std::get<0>(sender_id));
-					if (tmp_e)
+					auto set_count = 0;
+					for (int i = node.input_begin; i < node.input_end; ++i)
 					{
-						const auto ss = tmp_e->component<sends_signal_t>();
-						if (ss)
+						if (circuit_state[circuit_inputs[i]]) ++set_count;
+					}
+					const auto output = gate_output(node.processor, set_count, node.input_end - node.input_begin);
+					if (output != (circuit_state[n] != 0))
+					{
+						circuit_state[n] = output ? 1 : 0;
+						auto circuit_entity = entity(node.entity_id);
+						if (!circuit_entity)
 						{
-							ss->targets.erase(
-								std::remove_if(ss->targets.begin(), ss->targets.end(), [&sender_id](const auto &a) { return a == std::get<0>(sender_id); }),
-								ss->targets.end()
-							);
+							dependencies_changed = true;
+							continue;
 						}
+						circuit_entity->component<signal_processor_t>()->active = output;
+						circuit_entity->component<sends_signal_t>()->active = output;
+						schedule_outputs(n);
 					}
 				}
-				delete_entity(circuit_entity->id);
-				gravity::tile_was_removed();
+				if (node.is_actuator) actuations.emplace_back(std::make_pair(n, circuit_trigger[n]));
 			}
-		}
+			for (const auto &n : circuit_touched)
+			{
+				circuit_evaluated[n] = 0;
+				circuit_trigger[n] = -1;
+			}
+			circuit_touched.clear();
 
-		static void run_circuits()
-		{
-			while (!nodes_changed.empty())
+			// Apply the outputs
+			changed_tiles.clear();
+			for (const auto &a : actuations)
 			{
-				const auto id = *nodes_changed.begin();
-				//std::cout << id << "\n";
-				nodes_changed.erase(id);
+				const auto id = circuit_nodes[a.first].entity_id;
+				const auto active = circuit_state[a.second] != 0;
+				auto circuit_entity = entity(id);
+				if (!circuit_entity)
+				{
+					dependencies_changed = true;
+					continue;
+				}
 
-				const auto effect_finder = affects.find(id);
-				if (effect_finder != affects.end())
+				const auto door = circuit_entity->component<construct_door_t>();
+				if (door)
 				{
-					for (const auto affected : effect_finder->second)
-					{
-						evaluate_circuit_node(affected, id);
-					}
+					door->locked = active;
+					doors::doors_changed();
+				}
+				const auto bridge = circuit_entity->component<bridge_t>();
+				if (bridge) actuate_bridge(id, bridge, active, changed_tiles);
+				const auto building = circuit_entity->component<building_t>();
+				if (building && building->tag == "spike_trap")
+				{
+					actuate_spikes(circuit_entity, building, active);
+				}
+				else if (building && building->tag == "support")
+				{
+					actuate_support(circuit_entity);
 				}
 			}
+			if (!changed_tiles.empty()) recalc_tiles(changed_tiles);
 		}
 
 		void run(const double &duration_ms) {
@@ -561,8 +689,26 @@ namespace systems {
 			oscillators();
 			float_sensors();
 			if (slow_tick) proximity_sensors();
-			if (dependencies_changed) calc_dependency();
+			if (dependencies_changed) compile_circuits();
 			run_circuits();
 		}
+
+		void reset() {
+			dirty = true;
+			triggers.clear();
+			dependencies_changed = true;
+			nodes_changed.clear();
+			circuit_nodes.clear();
+			circuit_inputs.clear();
+			circuit_outputs.clear();
+			circuit_state.clear();
+			circuit_node_of.clear();
+			circuit_queued.clear();
+			circuit_evaluated.clear();
+			circuit_trigger.clear();
+			circuit_touched.clear();
+			circuit_frontier = std::priority_queue<int, std::vector<int>, std::greater<int>>();
+			circuit_deferred.clear();
+		}
 	}
 }
\ No newline at end of file
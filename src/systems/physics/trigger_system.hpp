@@ -8,6 +8,8 @@ namespace systems {
 		void run(const double &duration_ms);
 		void entry_trigger_firing(const systems::movement::entity_moved_message &msg);
 		void edit_triggers();
+		/* Drops the compiled circuits and trigger map; they are rebuilt from the ECS on the next run. */
+		void reset();
 
 		struct triggers_changed_message {
 		};
@@ -1,5 +1,6 @@
 #include "explosive_system.hpp"
-#include "../../utils/thread_safe_message_queue.hpp"
+#include "vegetation_system.hpp"
+#include "../../utils/mpsc_message_queue.hpp"
 #include "../../global_assets/game_pause.hpp"
 #include "../../planet/region/region.hpp"
 #include "../../raws/plants.hpp"
@@ -9,6 +10,9 @@
 #include "../../global_assets/farming_designations.hpp"
 #include "../../global_assets/rng.hpp"
 #include "../../noxtypes.h"
+#include <unordered_map>
+#include <set>
+#include <array>
 
 using namespace bengine;
 using namespace region;
@@ -25,12 +29,250 @@ namespace systems {
 			int damage;
 		};
 
-		thread_safe_message_queue<vegetation_damage_message> damage;
+		mpsc_message_queue<vegetation_damage_message> damage;
 
 		void inflict_damage(const int &idx, const int &dmg) {
 			damage.enqueue(vegetation_damage_message{ idx, dmg });
 		}
 
+		/*
+		 * Growth is simulated sparsely. Every tile with vegetation has an entry in plants. A plant that is simply
+		 * growing (it has light, or doesn't need it, and isn't on a farm) changes nothing visible until its next
+		 * lifecycle transition, so it waits on a time wheel under the day that happens; its ticker in the region
+		 * is only brought up to date when it is touched. Farm tiles and plants starving in the dark can change
+		 * every day (and roll dice), so they are ticked daily, in tile order.
+		 */
+		struct plant_state_t {
+			uint32_t synced_day = 0; // The region's ticker is correct as of the end of this day
+			uint32_t due_day = 0;    // For wheel plants, the day of the next lifecycle transition
+			bool on_wheel = false;
+		};
+
+		constexpr uint32_t WHEEL_DAYS = 64;
+		static uint32_t current_day = 0;
+		static std::unordered_map<int, plant_state_t> plants;
+		static std::set<int> daily_plants;
+		static std::array<std::vector<int>, WHEEL_DAYS> wheel;
+		static std::vector<int> vegetation_changes;
+		static std::vector<int> outdoor_changes;
+		static bool listening_to_region = false;
+
+		// Writes the days a wheel plant has spent growing since it was last touched back into the region.
+		static void bring_up_to_date(const int &idx, plant_state_t &state) {
+			if (state.on_wheel && state.synced_day < current_day) {
+				set_veg_ticker(idx, static_cast<uint16_t>(veg_ticker(idx) + (current_day - state.synced_day)));
+			}
+			state.synced_day = current_day;
+		}
+
+		// Decides how a plant is simulated from here on; the region must be up to date for it.
+		static void schedule(const int &idx) {
+			if (veg_type(idx) == 0) {
+				plants.erase(idx);
+				daily_plants.erase(idx);
+				return;
+			}
+
+			auto &state = plants[idx];
+			const auto was_on_wheel = state.on_wheel;
+			const auto previous_due = state.due_day;
+			state.synced_day = current_day;
+			state.on_wheel = false;
+
+			const auto plant = get_plant_def(veg_type(idx));
+			if (!plant) {
+				daily_plants.erase(idx);
+				return;
+			}
+
+			const auto farmed = farm_designations->farms.find(idx) != farm_designations->farms.end();
+			const auto starving = plant->requires_light && !region::flag(idx, ABOVE_GROUND);
+			if (farmed || starving) {
+				daily_plants.insert(idx);
+				return;
+			}
+			daily_plants.erase(idx);
+			if (plant->lifecycle.empty()) return; // Nothing will ever happen to it
+
+			const int threshold = plant->lifecycle[veg_lifecycle(idx)];
+			const int ticker = veg_ticker(idx);
+			state.due_day = current_day + (ticker > threshold ? 1 : static_cast<uint32_t>(threshold - ticker + 1));
+			state.on_wheel = true;
+			if (!was_on_wheel || previous_due != state.due_day) wheel[state.due_day % WHEEL_DAYS].emplace_back(idx);
+		}
+
+		// One day of growth for one tile, exactly as the full-region sweep used to do it.
+		static void grow(const int &idx, farm_cycle_t * farm) {
+			if (veg_type(idx) == 0) return;
+
+			const int tick_increase = (farm && farm->fertilized) ? 2 : 1; // Fertilized plants grow faster
+			uint16_t current_tick = veg_ticker(idx) + tick_increase;
+			uint8_t current_cycle = veg_lifecycle(idx);
+			auto plant = get_plant_def(veg_type(idx));
+			if (!plant) return;
+
+			// Photosynthesizeing plants die in the darkness
+			if (plant->requires_light && !region::flag(idx, ABOVE_GROUND)) {
+				if (veg_ticker(idx) > 0) {
+					current_tick = veg_ticker(idx) - 1;
+				}
+				else {
+					set_veg_type(idx, 0);
+					return;
+				}
+			}
+			if (plant->lifecycle.empty()) return;
+
+			int return_val = plant->lifecycle[4];
+			if (return_val > 3 || return_val < 0) return_val = 0;
+
+			if (current_tick > plant->lifecycle[current_cycle]) {
+				++current_cycle;
+				current_tick = 0;
+				if (current_cycle > 3) current_cycle = return_val;
+
+				if (farm && plant->provides[veg_lifecycle(idx)] != "none") {
+					auto[x, y, z] = idxmap(idx);
+					farm_designations->harvest.push_back(std::make_pair(false, position_t{ x,y,z }));
+				}
+
+				calc_render(idx);
+				region::mark_chunk_dirty_by_tileidx(idx);
+				// TODO: emit(map_dirty_message{});
+			}
+
+			// Punish people who don't tend their crops!
+			if (farm) {
+				if (current_cycle > 0 && farm->days_since_watered > 4 && rng.roll_dice(1, 50) <= farm->days_since_watered) {
+					--current_cycle;
+					calc_render(idx);
+					region::mark_chunk_dirty_by_tileidx(idx);
+				}
+				if (current_cycle > 0 && farm->days_since_weeded > 4 && rng.roll_dice(1, 50) <= farm->days_since_weeded) {
+					--current_cycle;
+					calc_render(idx);
+					region::mark_chunk_dirty_by_tileidx(idx);
+				}
+			}
+
+			set_veg_ticker(idx, current_tick);
+			set_veg_lifecycle(idx, current_cycle);
+		}
+
+		// Picks up vegetation written by anyone else, and plants that moved into or out of the light.
+		static void apply_changes() {
+			if (!listening_to_region) {
+				region::on_outdoor_changed([](int x, int y, int min_z, int max_z) {
+					for (int z = min_z; z <= max_z; ++z) outdoor_changes.emplace_back(mapidx(x, y, z));
+				});
+				// Wheel plants' tickers are behind in the region until synced, and a save would keep them that way
+				region::on_before_save([]() { sync_tickers(); });
+				listening_to_region = true;
+			}
+
+			if (take_vegetation_changes(vegetation_changes)) {
+				plants.clear();
+				daily_plants.clear();
+				for (auto &bucket : wheel) bucket.clear();
+				outdoor_changes.clear();
+				for (int idx = 0; idx < REGION_TILES_COUNT; ++idx) {
+					if (veg_type(idx) > 0) schedule(idx);
+				}
+				take_vegetation_changes(vegetation_changes);
+				return;
+			}
+
+			// Whoever wrote these left the region correct, so they just need rescheduling.
+			for (const auto &idx : vegetation_changes) {
+				auto finder = plants.find(idx);
+				if (finder != plants.end()) finder->second.synced_day = current_day;
+				schedule(idx);
+			}
+
+			for (const auto &idx : outdoor_changes) {
+				auto finder = plants.find(idx);
+				if (finder == plants.end()) continue;
+				bring_up_to_date(idx, finder->second);
+				schedule(idx);
+			}
+			outdoor_changes.clear();
+
+			// Our own write-backs are already accounted for
+			take_vegetation_changes(vegetation_changes);
+		}
+
+		void sync_tickers() {
+			// Anything written since the last run has to be picked up first, or it would be lost with our own write-backs
+			apply_changes();
+			for (auto &plant : plants) {
+				bring_up_to_date(plant.first, plant.second);
+			}
+			take_vegetation_changes(vegetation_changes);
+		}
+
+		static void grow_one_day() {
+			// Plants on newly farmed tiles come off the wheel
+			for (const auto &farm : farm_designations->farms) {
+				auto finder = plants.find(farm.first);
+				if (finder != plants.end() && finder->second.on_wheel) {
+					bring_up_to_date(farm.first, finder->second);
+					finder->second.on_wheel = false;
+					daily_plants.insert(farm.first);
+				}
+			}
+
+			++current_day;
+
+			// Farm counters advance whether or not anything is growing
+			for (auto &farm : farm_designations->farms) {
+				++farm.second.days_since_watered;
+				++farm.second.days_since_weeded;
+			}
+
+			// Daily tiles, in tile order so that dice are rolled in the same order as a full sweep
+			std::vector<int> todays_tiles(daily_plants.begin(), daily_plants.end());
+			for (const auto &idx : todays_tiles) {
+				auto farm = farm_designations->farms.find(idx);
+				grow(idx, farm == farm_designations->farms.end() ? nullptr : &farm->second);
+			}
+
+			// Wheel plants whose transition is today
+			auto &bucket = wheel[current_day % WHEEL_DAYS];
+			std::vector<int> due;
+			std::vector<int> later;
+			for (const auto &idx : bucket) {
+				auto finder = plants.find(idx);
+				if (finder == plants.end() || !finder->second.on_wheel) continue;
+				if (finder->second.due_day == current_day) {
+					finder->second.on_wheel = false;
+					due.emplace_back(idx);
+				}
+				else if (finder->second.due_day > current_day && finder->second.due_day % WHEEL_DAYS == current_day % WHEEL_DAYS) {
+					later.emplace_back(idx);
+				}
+			}
+			bucket.swap(later);
+			for (const auto &idx : due) {
+				// The ticker as of yesterday, then today's growth does the transition
+				set_veg_ticker(idx, static_cast<uint16_t>(veg_ticker(idx) + (current_day - 1 - plants[idx].synced_day)));
+				grow(idx, nullptr);
+			}
+
+			for (const auto &idx : todays_tiles) schedule(idx);
+			for (const auto &idx : due) schedule(idx);
+			take_vegetation_changes(vegetation_changes);
+		}
+
+		void reset() {
+			// The region listeners belong to the region module, which outlives any one game, so they stay registered
+			current_day = 0;
+			plants.clear();
+			daily_plants.clear();
+			for (auto &bucket : wheel) bucket.clear();
+			vegetation_changes.clear();
+			outdoor_changes.clear();
+		}
+
 		void run(const double &duration_ms) {
 			damage.process_all([](const vegetation_damage_message &msg) {
 				damage_vegetation(msg.idx, msg.damage);
@@ -45,82 +287,9 @@ namespace systems {
 				}
 			});
 
-			if (day_elapsed) {
-				region::update_outdoor_calculation();
-				for (int z = 0; z<REGION_DEPTH - 1; ++z) {
-					for (int y = 0; y<REGION_HEIGHT - 1; ++y) {
-						for (int x = 0; x<REGION_WIDTH - 1; ++x) {
-							const int idx = mapidx(x, y, z);
-
-							auto farm = farm_designations->farms.find(idx);
-
-							int tick_increase = 1;
-							if (farm != farm_designations->farms.end()) {
-								if (farm->second.fertilized) tick_increase = 2; // Fertilized plants grow faster
-								++farm->second.days_since_watered;
-								++farm->second.days_since_weeded;
-							}
-
-							if (veg_type(idx) > 0) {
-								uint16_t current_tick = veg_ticker(idx) + tick_increase;
-								uint8_t current_cycle = veg_lifecycle(idx);
-								auto plant = get_plant_def(veg_type(idx));
-								if (plant) {
-									// Photosynthesizeing plants die in the darkness
-									if (plant->requires_light && !region::flag(idx, ABOVE_GROUND)) {
-										if (veg_ticker(idx) > 0) {
-											current_tick = veg_ticker(idx) - 1;
-										}
-										else {
-											set_veg_type(idx, 0);
-											goto escape_loop;
-										}
-									}
-									if (!plant->lifecycle.empty()) {
-										//std::cout << "Plant lifecycle ticked\n";
-										int return_val = plant->lifecycle[4];
-										if (return_val > 3 || return_val < 0) return_val = 0;
-
-										if (current_tick > plant->lifecycle[current_cycle]) {
-											++current_cycle;
-											current_tick = 0;
-											if (current_cycle > 3) current_cycle = return_val;
-
-											if (farm != farm_designations->farms.end() && plant->provides[veg_lifecycle(idx)] != "none") {
-												auto[x, y, z] = idxmap(idx);
-												farm_designations->harvest.push_back(std::make_pair(false, position_t{ x,y,z }));
-											}
-
-											calc_render(idx);
-											region::mark_chunk_dirty_by_tileidx(idx);
-											// TODO: emit(map_dirty_message{});
-										}
-
-										// Punish people who don't tend their crops!
-										if (farm != farm_designations->farms.end()) {
-											if (current_cycle > 0 && farm->second.days_since_watered > 4 && rng.roll_dice(1, 50) <= farm->second.days_since_watered) {
-												--current_cycle;
-												calc_render(idx);
-												region::mark_chunk_dirty_by_tileidx(idx);
-											}
-											if (current_cycle > 0 && farm->second.days_since_weeded > 4 && rng.roll_dice(1, 50) <= farm->second.days_since_weeded) {
-												--current_cycle;
-												calc_render(idx);
-												region::mark_chunk_dirty_by_tileidx(idx);
-											}
-										}
-
-										set_veg_ticker(idx, current_tick);
-										set_veg_lifecycle(idx, current_cycle);																			
-									}
-								}
-							}
-
-							escape_loop: {}
-						}
-					}
-				}
-			}
+			if (day_elapsed) region::update_outdoor_calculation();
+			apply_changes();
+			if (day_elapsed) grow_one_day();
 		}
 	}
 }
\ No newline at end of file
@@ -6,5 +6,11 @@ namespace systems {
 	namespace vegetation {
 		void run(const double &duration_ms);
 		void inflict_damage(const int &idx, const int &dmg);
+
+		/* Plants between lifecycle changes don't update their region ticker every day; this writes them all back. */
+		void sync_tickers();
+
+		/* Forgets every plant and restarts the day count; the next run rebuilds them from the region. */
+		void reset();
 	}
 }
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "visibility_system.hpp"
 #include "../../planet/region/region.hpp"
-#include "../../bengine/geometry.hpp"
+#include "../../bengine/fov.hpp"
 #include "../../global_assets/spatial_db.hpp"
 #include "../../global_assets/game_ecs.hpp"
 #include "../../noxtypes.h"
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <cassert>
 
 using namespace bengine;
 using namespace tile_flags;
@@ -17,6 +21,17 @@ namespace systems {
 		bool opacity_dirty = true;
 		bool dirty = true;
 
+		// How many good-guy viewsheds can see each tile; VISIBLE is set while the count is non-zero.
+		static std::vector<uint16_t> visibility_refcount;
+		// What each entity last added to the refcounts, so that it can be taken away again.
+		static std::unordered_map<std::size_t, fov_bitset_t> contributions;
+		// Tiles whose VISIBLE flag changed since the renderer last asked.
+		static std::vector<int> changed_tiles;
+		static std::vector<bool> changed_marker;
+		// Terrain boxes (min x/y/z, max x/y/z) recalculated since the last run; overlapping viewsheds are redone.
+		static std::vector<std::array<int, 6>> terrain_changes;
+		static bool listening_for_terrain = false;
+
 		void opacity_is_dirty() {
 			opacity_dirty = true;
 		}
@@ -26,75 +41,71 @@ namespace systems {
 			dirty = true;
 		}
 
-		static void reveal(const int &idx, viewshed_t &view) {
-			if (view.good_guy_visibility) region::reveal(idx);
-			view.visible_cache.insert(idx);
+		static inline bool in_bounds(const int x, const int y, const int z) noexcept {
+			return x > 0 && x < REGION_WIDTH - 1 && y > 0 && y < REGION_HEIGHT - 1 && z > 0 && z < REGION_DEPTH - 1;
 		}
 
-		inline void internal_pen_view_to(position_t &pos, viewshed_t &view, int x, int y, int z) {
-			const float dist_square = view.viewshed_radius * view.viewshed_radius;
+		static void update_viewshed(entity_t &e, position_t &pos, viewshed_t &view) {
+			fov_3d(pos.x, pos.y, pos.z, view.viewshed_radius, view.penetrating, view.visible_cache, in_bounds, [](const int x, const int y, const int z) {
+				return region::flag(mapidx(x, y, z), SOLID);
+			});
 
-			line_func_3d_cancellable(pos.x, pos.y, pos.z, pos.x + x, pos.y + y, pos.z + z, [&view, &pos, &dist_square](int X, int Y, int Z) {
-				reveal(mapidx(X, Y, Z), view);
-				const float distance = distance3d_squared(pos.x, pos.y, pos.z, X, Y, Z);
-				if (distance < dist_square) {
-					return true;
-				}
-				else {
-					return false;
+			if (view.good_guy_visibility) {
+				view.visible_cache.each([](const int x, const int y, const int z) {
+					region::reveal(mapidx(x, y, z));
+				});
+			}
+		}
+
+		static inline void mark_changed(const int idx) {
+			if (changed_marker[idx]) return;
+			changed_marker[idx] = true;
+			changed_tiles.emplace_back(idx);
+		}
+
+		static void add_contribution(const fov_bitset_t &view) {
+			view.each([](const int x, const int y, const int z) {
+				const auto idx = mapidx(x, y, z);
+				if (visibility_refcount[idx]++ == 0) {
+					region::make_visible(idx);
+					mark_changed(idx);
 				}
 			});
 		}
 
-		static void internal_view_to(position_t &pos, viewshed_t &view, const int x, const int y, const int z) {
-			using namespace region;
-
-			const float dist_square = view.viewshed_radius * view.viewshed_radius;
-
-			//std::cout << "Starting at " << pos.x << ", " << pos.y << ", " << pos.z << "\n";
-			//std::cout << "Ending at " << pos.x+x << ", " << pos.y+y << ", " << pos.z+z << "\n";
-			reveal(mapidx(pos), view); // Always reveal where we are standing
-
-			auto blocked = false;
-			line_func_3d(pos.x, pos.y, pos.z, pos.x + x, pos.y + y, pos.z + z, [&view, &pos, &dist_square, &blocked] (const int at_x, const int at_y, const int at_z)
-			{
-				if (at_x > 0 && at_x < REGION_WIDTH - 1 && at_y > 0 && at_y < REGION_HEIGHT - 1 && at_z > 0 && at_z < REGION_DEPTH-1) {
-					const auto distance = distance3d_squared(pos.x, pos.y, pos.z, at_x, at_y, at_z);
-					if (distance < dist_square) {
-						//std::cout << " - Visit " << at_x << ", " << at_y << ", " << at_z << "\n";
-						const auto idx = mapidx(at_x, at_y, at_z);
-						if (!blocked) reveal(idx, view);
-						if (region::flag(idx, SOLID)) blocked = true;
-					}
+		static void remove_contribution(const fov_bitset_t &view) {
+			view.each([](const int x, const int y, const int z) {
+				const auto idx = mapidx(x, y, z);
+				assert(visibility_refcount[idx] > 0); // Contributions are only ever taken away as they were added
+				if (--visibility_refcount[idx] == 0) {
+					region::reset_flag(idx, VISIBLE);
+					mark_changed(idx);
 				}
 			});
 		}
 
-		static void update_penetrating_viewshed(entity_t &e, position_t &pos, viewshed_t &view) {
-			view.visible_cache.clear();
+		static void reset_visibility_map() {
+			region::clear_visibility();
+			visibility_refcount.assign(REGION_TILES_COUNT, 0);
+			changed_marker.assign(REGION_TILES_COUNT, false);
+			changed_tiles.clear();
+			contributions.clear();
+		}
 
-			reveal(mapidx(pos.x, pos.y, pos.z), view);
-			for (int z = (0 - view.viewshed_radius); z<view.viewshed_radius; ++z) {
-				for (int i = 0 - view.viewshed_radius; i<view.viewshed_radius; ++i) {
-					internal_pen_view_to(pos, view, i, 0 - view.viewshed_radius, z);
-					internal_pen_view_to(pos, view, i, view.viewshed_radius, z);
-					internal_pen_view_to(pos, view, 0 - view.viewshed_radius, i, z);
-					internal_pen_view_to(pos, view, view.viewshed_radius, i, z);
-				}
-			}
+		void reset() {
+			reset_visibility_map();
+			dirty_entities.clear();
+			terrain_changes.clear(); // Viewsheds aren't saved, so every viewer recomputes anyway
+			opacity_dirty = true;
+			dirty = true;
 		}
 
-		static void update_normal_viewshed(entity_t &e, position_t &pos, viewshed_t &view) {
-			view.visible_cache.clear();
-			reveal(mapidx(pos.x, pos.y, pos.z), view);
-			for (auto z = (0 - view.viewshed_radius); z<view.viewshed_radius; ++z) {
-				for (auto i = 0 - view.viewshed_radius; i<view.viewshed_radius; ++i) {
-					internal_view_to(pos, view, i, view.viewshed_radius, z);
-					internal_view_to(pos, view, i, -view.viewshed_radius, z);
-					internal_view_to(pos, view, view.viewshed_radius, i, z);
-					internal_view_to(pos, view, -view.viewshed_radius, i, z);
-				}
+		void get_visibility_changes(std::vector<int> &changed) {
+			for (const auto &idx : changed_tiles) {
+				changed.emplace_back(idx);
+				changed_marker[idx] = false;
 			}
+			changed_tiles.clear();
 		}
 
 		void calculate_building_opacity() {
@@ -125,9 +136,26 @@ namespace systems {
 			});
 		}
 
+		static bool terrain_changed_near(const position_t &pos, const int radius) {
+			for (const auto &box : terrain_changes) {
+				if (pos.x + radius >= box[0] && pos.x - radius <= box[3] &&
+					pos.y + radius >= box[1] && pos.y - radius <= box[4] &&
+					pos.z + radius >= box[2] && pos.z - radius <= box[5]) return true;
+			}
+			return false;
+		}
+
 		void run(const double &duration_ms) {
 			using namespace region;
 
+			if (!listening_for_terrain) {
+				on_tiles_recalculated([](int min_x, int min_y, int min_z, int max_x, int max_y, int max_z) {
+					terrain_changes.emplace_back(std::array<int, 6>{ min_x, min_y, min_z, max_x, max_y, max_z });
+					dirty = true;
+				});
+				listening_for_terrain = true;
+			}
+
 			if (opacity_dirty) {
 				calculate_building_opacity();
 				opacity_dirty = false;
@@ -135,26 +163,26 @@ namespace systems {
 
 			if (!dirty) return;
 
-			// Apply to map - first clear everything
-			clear_visibility();
+			if (visibility_refcount.size() != REGION_TILES_COUNT) reset_visibility_map();
 
 			each<position_t, viewshed_t>([](entity_t &e, position_t &pos, viewshed_t &view) {
-				// Create viewsheds if needed
-				if (view.visible_cache.empty() || dirty_entities.find(e.id) != dirty_entities.end()) {
-					// The entity needs a viewshed!
-					if (view.penetrating) {
-						update_penetrating_viewshed(e, pos, view);
-					}
-					else {
-						update_normal_viewshed(e, pos, view);
+				// Create viewsheds if needed; only the viewsheds that changed touch the visibility map
+				const auto contribution = contributions.find(e.id);
+				const auto needs_contribution = view.good_guy_visibility && contribution == contributions.end();
+				if (view.visible_cache.empty() || needs_contribution || dirty_entities.find(e.id) != dirty_entities.end()
+					|| terrain_changed_near(pos, view.viewshed_radius)) {
+					if (contribution != contributions.end()) {
+						remove_contribution(contribution->second);
+						contributions.erase(contribution);
 					}
+
+					// The entity needs a viewshed!
+					update_viewshed(e, pos, view);
 					dirty_entities.erase(e.id);
-				}
 
-				// Make visible
-				if (view.good_guy_visibility) {
-					for (const int &idx : view.visible_cache) {
-						make_visible(idx);
+					if (view.good_guy_visibility) {
+						add_contribution(view.visible_cache);
+						contributions[e.id] = view.visible_cache;
 					}
 				}
 
@@ -166,16 +194,26 @@ namespace systems {
 				auto sensor = e.component<proximity_sensor_t>();
 				if (grazer || settler || sentient || turret || sensor) {
 					view.visible_entities.clear();
-					for (const int &idx : view.visible_cache) {
-						auto [x,y,z] = idxmap(idx);
-						auto visible_here = entity_octree.find_by_loc(octree_location_t{ x, y, z, 0 });
-						for (const auto &v : visible_here) {
-							view.visible_entities.insert(v);
-						}
-					}
+					entity_octree.find_by_radius(pos.x, pos.y, pos.z, view.viewshed_radius, [&view](const octree_location_t &loc) {
+						if (view.visible_cache.test(loc.x, loc.y, loc.z)) view.visible_entities.insert(loc.id);
+					});
 				}
 			});
+
+			// Viewers that have died or lost their viewshed no longer see anything
+			for (auto it = contributions.begin(); it != contributions.end();) {
+				auto viewer = entity(static_cast<int>(it->first));
+				if (!viewer || !viewer->component<viewshed_t>() || !viewer->component<position_t>()) {
+					remove_contribution(it->second);
+					it = contributions.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+
 			dirty_entities.clear();
+			terrain_changes.clear();
 			dirty = false;
 		}
 	}
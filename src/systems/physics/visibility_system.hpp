@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_set>
+#include <vector>
 
 namespace systems {
 	namespace visibility {
@@ -10,5 +11,11 @@ namespace systems {
 		void run(const double &duration_ms);
 		void opacity_is_dirty();
 		void on_entity_moved(int &entity_id);
+
+		/* Forgets every viewshed's contribution and clears VISIBLE; call when a different region is loaded. */
+		void reset();
+
+		/* Appends the tiles whose VISIBLE flag changed since the last call, and forgets them. */
+		void get_visibility_changes(std::vector<int> &changed);
 	}
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "physics/gravity_system.hpp"
 #include "ai/distance_map_system.hpp"
 #include "overworld/world_system.hpp"
+#include "scheduler/ai_lod.hpp"
 #include "scheduler/initiative_system.hpp"
 #include "ai/sentient_ai_system.hpp"
 #include "scheduler/corpse_system.hpp"
@@ -61,73 +62,97 @@
 #include "physics/item_wear_system.hpp"
 #include "ai/inventory_system.hpp"
 #include "overworld/settler_spawner_system.hpp"
+#include "helpers/path_service.hpp"
+#include "../utils/profiler.hpp"
+#include <chrono>
 
 namespace systems {
+	static std::vector<system_timing_t> timings;
+
+	template <typename SYSTEM>
+	inline void run_system(const char * name, const SYSTEM &system, const double ms) {
+		const auto start = std::chrono::steady_clock::now();
+		system(ms);
+		const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		timings.emplace_back(system_timing_t{ name, elapsed });
+		profiler::record(name, elapsed);
+	}
+
+	const std::vector<system_timing_t> &last_tick_timings() {
+		return timings;
+	}
+
 	void run_systems(const double ms) {
-		tick::run(ms);
+		profiler::scope_t profile("run_systems");
+		timings.clear();
+
+		run_system("path_service", path_service::run, ms);
+		run_system("tick", tick::run, ms);
 		if (major_tick) {
 			// Age log
-			calendarsys::run(ms);
-			hunger_system::run(ms);
-			if (hour_elapsed) settler_spawner::run(ms);
-			wildlife_population::run(ms);
+			run_system("calendarsys", calendarsys::run, ms);
+			run_system("hunger_system", hunger_system::run, ms);
+			if (hour_elapsed) run_system("settler_spawner", settler_spawner::run, ms);
+			run_system("wildlife_population", wildlife_population::run, ms);
 			// fluids
-			explosives::run(ms);
-			doors::run(ms);
-			gravity::run(ms);
-			distance_map::run(ms);
-			world::run(ms);
-			initiative::run(ms);
-			if (day_elapsed) sentient_ai_system::run(ms);
-			corpse_system::run(ms);
-			mining_system::run(ms);
-			architecture_system::run(ms);
-			stockpile_system::run(ms);
-			power::run(ms);
-			workflow_system::run(ms);
-			ai_status_effects::run(ms);
-			ai_stuck::run(ms);
-			ai_visibility_scan::run(ms);
-			ai_new_arrival::run(ms);
-			ai_scheduler::run(ms);
-			ai_leisure_time::run(ms);
-			ai_sleep_time::run(ms);
-			ai_work_time::run(ms);
-			ai_work_lumberjack::run(ms);
-			ai_mining::run(ms);
-			ai_guard::run(ms);
-			ai_harvest::run(ms);
-			ai_farm_plant::run(ms);
-			ai_farm_fertilize::run(ms);
-			ai_farm_clear::run(ms);
-			ai_farm_fixsoil::run(ms);
-			ai_farm_water::run(ms);
-			ai_farm_weed::run(ms);
-			ai_building::run(ms);
-			ai_workorder::run(ms);
-			ai_architect::run(ms);
-			ai_hunt::run(ms);
-			ai_butcher::run(ms);
-			ai_work_stockpiles::run(ms);
-			ai_deconstruction::run(ms);
-			ai_leisure_eat::run(ms);
-			ai_leisure_drink::run(ms);
-			ai_idle_time::run(ms);
-			movement::run(ms);
-			triggers::run(ms);
-			settler_ranged_attack::run(ms);
-			settler_melee_attack::run(ms);
-			sentient_attacks::run(ms);
-			creature_attacks::run(ms);
-			turret_attacks::run(ms);
-			damage_system::run(ms);
-			kill_system::run(ms);
-			if (hour_elapsed) healing_system::run(ms);
-			topology::run(ms);
-			visibility::run(ms);
-			vegetation::run(ms);
-			if (day_elapsed) item_wear::run(ms);
+			run_system("explosives", explosives::run, ms);
+			run_system("doors", doors::run, ms);
+			run_system("gravity", gravity::run, ms);
+			run_system("distance_map", distance_map::run, ms);
+			run_system("world", world::run, ms);
+			run_system("ai_lod", ai_lod::run, ms);
+			run_system("initiative", initiative::run, ms);
+			if (day_elapsed) run_system("sentient_ai_system", sentient_ai_system::run, ms);
+			run_system("corpse_system", corpse_system::run, ms);
+			run_system("mining_system", mining_system::run, ms);
+			run_system("architecture_system", architecture_system::run, ms);
+			run_system("stockpile_system", stockpile_system::run, ms);
+			run_system("power", power::run, ms);
+			run_system("workflow_system", workflow_system::run, ms);
+			run_system("ai_status_effects", ai_status_effects::run, ms);
+			run_system("ai_stuck", ai_stuck::run, ms);
+			run_system("ai_visibility_scan", ai_visibility_scan::run, ms);
+			run_system("ai_new_arrival", ai_new_arrival::run, ms);
+			run_system("ai_scheduler", ai_scheduler::run, ms);
+			run_system("ai_leisure_time", ai_leisure_time::run, ms);
+			run_system("ai_sleep_time", ai_sleep_time::run, ms);
+			run_system("ai_work_time", ai_work_time::run, ms);
+			run_system("ai_work_lumberjack", ai_work_lumberjack::run, ms);
+			run_system("ai_mining", ai_mining::run, ms);
+			run_system("ai_guard", ai_guard::run, ms);
+			run_system("ai_harvest", ai_harvest::run, ms);
+			run_system("ai_farm_plant", ai_farm_plant::run, ms);
+			run_system("ai_farm_fertilize", ai_farm_fertilize::run, ms);
+			run_system("ai_farm_clear", ai_farm_clear::run, ms);
+			run_system("ai_farm_fixsoil", ai_farm_fixsoil::run, ms);
+			run_system("ai_farm_water", ai_farm_water::run, ms);
+			run_system("ai_farm_weed", ai_farm_weed::run, ms);
+			run_system("ai_building", ai_building::run, ms);
+			run_system("ai_workorder", ai_workorder::run, ms);
+			run_system("ai_architect", ai_architect::run, ms);
+			run_system("ai_hunt", ai_hunt::run, ms);
+			run_system("ai_butcher", ai_butcher::run, ms);
+			run_system("ai_work_stockpiles", ai_work_stockpiles::run, ms);
+			run_system("ai_deconstruction", ai_deconstruction::run, ms);
+			run_system("ai_leisure_eat", ai_leisure_eat::run, ms);
+			run_system("ai_leisure_drink", ai_leisure_drink::run, ms);
+			run_system("ai_idle_time", ai_idle_time::run, ms);
+			run_system("movement", movement::run, ms);
+			run_system("triggers", triggers::run, ms);
+			run_system("settler_ranged_attack", settler_ranged_attack::run, ms);
+			run_system("settler_melee_attack", settler_melee_attack::run, ms);
+			run_system("sentient_attacks", sentient_attacks::run, ms);
+			run_system("creature_attacks", creature_attacks::run, ms);
+			run_system("turret_attacks", turret_attacks::run, ms);
+			run_system("damage_system", damage_system::run, ms);
+			run_system("kill_system", kill_system::run, ms);
+			if (hour_elapsed) run_system("healing_system", healing_system::run, ms);
+			run_system("topology", topology::run, ms);
+			run_system("visibility", visibility::run, ms);
+			run_system("vegetation", vegetation::run, ms);
+			if (day_elapsed) run_system("item_wear", item_wear::run, ms);
 		}
-		inventory_system::run(ms);
+		run_system("inventory_system", inventory_system::run, ms);
+		run_system("path_service_dispatch", [](const double &) { path_service::dispatch(); }, ms);
 	}
 }
\ No newline at end of file
@@ -1,5 +1,15 @@
 #pragma once
 
+#include <vector>
+
 namespace systems {
+	struct system_timing_t {
+		const char * name;
+		double ms;
+	};
+
 	void run_systems(const double ms);
-}
\ No newline at end of file
+
+	/* How long each system took in the last call to run_systems, in the order they ran. Systems that were skipped aren't listed. */
+	const std::vector<system_timing_t> &last_tick_timings();
+}
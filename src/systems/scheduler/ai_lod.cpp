@@ -0,0 +1,121 @@
+#include "ai_lod.hpp"
+#include "../../global_assets/game_ecs.hpp"
+#include "../../global_assets/game_camera.hpp"
+#include "../../noxconsts.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace systems {
+	namespace ai_lod {
+
+		using namespace bengine;
+		using namespace nf;
+
+		// Width of the coarse cells the watched area is marked in, in tiles
+		constexpr int WATCH_CELL = 16;
+		constexpr int WATCH_CELLS_X = REGION_WIDTH / WATCH_CELL;
+		constexpr int WATCH_CELLS_Y = REGION_HEIGHT / WATCH_CELL;
+
+		static int full_fidelity_radius = 48;
+		static int reduced_cadence = 4;
+		static ai_lod_stats_t stats;
+		static ai_lod_stats_t counting;
+
+		static std::vector<position_t> watchers;
+		static std::vector<bool> watched_cells(WATCH_CELLS_X * WATCH_CELLS_Y, false);
+
+		void set_full_fidelity_radius(const int tiles) {
+			full_fidelity_radius = std::max(0, tiles);
+		}
+
+		void set_cadence(const int cadence) {
+			reduced_cadence = std::max(1, cadence);
+		}
+
+		void get_settings(int &tiles, int &cadence) {
+			tiles = full_fidelity_radius;
+			cadence = reduced_cadence;
+		}
+
+		void reset() {
+			stats = ai_lod_stats_t{};
+			counting = ai_lod_stats_t{};
+			watchers.clear();
+			std::fill(watched_cells.begin(), watched_cells.end(), false);
+		}
+
+		ai_lod_stats_t get_stats() {
+			return stats;
+		}
+
+		static inline int cell_of(const int x, const int y) noexcept {
+			return (std::min(std::max(y, 0), REGION_HEIGHT - 1) / WATCH_CELL) * WATCH_CELLS_X + (std::min(std::max(x, 0), REGION_WIDTH - 1) / WATCH_CELL);
+		}
+
+		bool is_watched(const position_t &pos) {
+			if (!watched_cells[cell_of(pos.x, pos.y)]) return false;
+			for (const auto &w : watchers) {
+				if (std::abs(w.x - pos.x) <= full_fidelity_radius && std::abs(w.y - pos.y) <= full_fidelity_radius && std::abs(w.z - pos.z) <= full_fidelity_radius) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		int cadence_for(entity_t &e, const position_t &pos) {
+			if (reduced_cadence == 1) return 1;
+
+			// Only creatures that are minding their own business can be slowed down
+			const auto grazer = e.component<grazer_ai>();
+			const auto sentient = e.component<sentient_ai>();
+			if (!grazer && !sentient) return 1;
+			if (sentient && (sentient->hostile || sentient->goal != SENTIENT_GOAL_IDLE)) return 1;
+
+			return is_watched(pos) ? 1 : reduced_cadence;
+		}
+
+		void note_turn(const int cadence) {
+			if (cadence > 1) {
+				++counting.reduced_turns;
+			}
+			else {
+				++counting.full_turns;
+			}
+		}
+
+		void note_woken() {
+			++counting.woken;
+		}
+
+		static void watch(const position_t &pos) {
+			watchers.emplace_back(pos);
+			const auto min_x = std::max(0, pos.x - full_fidelity_radius) / WATCH_CELL;
+			const auto max_x = std::min(REGION_WIDTH - 1, pos.x + full_fidelity_radius) / WATCH_CELL;
+			const auto min_y = std::max(0, pos.y - full_fidelity_radius) / WATCH_CELL;
+			const auto max_y = std::min(REGION_HEIGHT - 1, pos.y + full_fidelity_radius) / WATCH_CELL;
+			for (int y = min_y; y <= max_y; ++y) {
+				for (int x = min_x; x <= max_x; ++x) {
+					watched_cells[y * WATCH_CELLS_X + x] = true;
+				}
+			}
+		}
+
+		void run(const double &duration_ms) {
+			// Last tick's counts become the published stats
+			stats = counting;
+			stats.watchers = static_cast<int>(watchers.size());
+			counting = ai_lod_stats_t{};
+
+			watchers.clear();
+			std::fill(watched_cells.begin(), watched_cells.end(), false);
+
+			each<settler_ai_t, position_t>([](entity_t &e, settler_ai_t &ai, position_t &pos) {
+				watch(pos);
+			});
+			if (camera_position) {
+				watch(position_t{ camera_position->region_x, camera_position->region_y, camera_position->region_z });
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../../bengine/ecs.hpp"
+#include "../../components/position.hpp"
+
+/*
+ * AI level of detail. Settlers and the camera are the only things that can notice what a creature is doing, so
+ * wildlife and peaceful sentients that are further than the full-fidelity radius from all of them get their turns
+ * less often: the initiative system stretches their next roll by the cadence. Anything with business nearby
+ * (hostile sentients, creatures that are fleeing or charging) stays at full speed wherever it is, and a stretched
+ * entity that comes within the radius is woken on the next tick.
+ *
+ * The map is split into coarse cells; only cells near a watcher need an exact distance check, so asking is cheap
+ * enough to do for every waiting entity every tick.
+ */
+namespace systems {
+	namespace ai_lod {
+
+		struct ai_lod_stats_t {
+			int watchers = 0;			// Settlers, plus the camera
+			int full_turns = 0;			// Turns handed out at full fidelity last tick
+			int reduced_turns = 0;		// Turns handed out at the reduced cadence last tick
+			int woken = 0;				// Stretched turns cut short last tick because something came near
+		};
+
+		void set_full_fidelity_radius(const int tiles);
+		void set_cadence(const int cadence);
+		void get_settings(int &tiles, int &cadence);
+		ai_lod_stats_t get_stats();
+
+		/* Forgets the watchers and stats; the radius and cadence are settings, and are kept. */
+		void reset();
+
+		/* Is a settler or the camera within the full-fidelity radius of pos? */
+		bool is_watched(const position_t &pos);
+
+		/* How many times its normal roll an entity should wait for its next turn; 1 is full fidelity. */
+		int cadence_for(bengine::entity_t &e, const position_t &pos);
+
+		/* Counts a turn handed out, and whether it was woken early, for the stats. */
+		void note_turn(const int cadence);
+		void note_woken();
+
+		/* Gathers this tick's watchers. Call before the initiative system. */
+		void run(const double &duration_ms);
+	}
+}
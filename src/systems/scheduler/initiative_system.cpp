@@ -1,4 +1,5 @@
 #include "initiative_system.hpp"
+#include "ai_lod.hpp"
 #include "../../global_assets/rng.hpp"
 #include "../../global_assets/game_ecs.hpp"
 #include <algorithm>
@@ -72,12 +73,25 @@ namespace systems {
 						i.initiative = 10;
 					}
 
+					// Creatures nobody is near to see wait longer for their next turn
+					i.lod_cadence = pos ? ai_lod::cadence_for(e, *pos) : 1;
+					i.initiative *= i.lod_cadence;
+					ai_lod::note_turn(i.lod_cadence);
+
 					// Reset modifiers
 					i.initiative_modifier = 0;
 				}
 				else {
 					auto slide = e.component<slidemove_t>();
 					auto pos = e.component<position_t>();
+
+					// Something came near a creature on a stretched turn; it gets the rest of a normal wait at most
+					if (i.lod_cadence > 1 && pos && ai_lod::is_watched(*pos)) {
+						i.initiative = std::min(i.initiative, std::max(1, i.initiative / i.lod_cadence));
+						i.lod_cadence = 1;
+						ai_lod::note_woken();
+					}
+
 					if (slide && pos && slide->lifespan > 0) {
 						pos->offset_x += slide->offsetX;
 						pos->offset_y += slide->offsetY;
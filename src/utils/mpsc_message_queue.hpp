@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+/*
+ * Lock-free multi-producer, single-consumer message queue. Producers push onto an intrusive stack with a
+ * single compare-and-swap; the consumer takes the whole stack in one exchange, puts it back in arrival order
+ * and processes it without holding anything, so handlers may safely enqueue more messages (they arrive in the
+ * next batch). Messages are moved in and out, never copied.
+ */
+template <typename MESSAGE_TYPE>
+class mpsc_message_queue {
+public:
+	mpsc_message_queue() = default;
+	mpsc_message_queue(const mpsc_message_queue &) = delete;
+	mpsc_message_queue &operator=(const mpsc_message_queue &) = delete;
+
+	~mpsc_message_queue() {
+		auto node = head.exchange(nullptr, std::memory_order_acquire);
+		while (node) {
+			const auto next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+
+	void enqueue(MESSAGE_TYPE &&msg) {
+		auto node = new node_t{ std::move(msg), head.load(std::memory_order_relaxed) };
+		while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+	}
+
+	bool empty() const noexcept {
+		return head.load(std::memory_order_acquire) == nullptr;
+	}
+
+	/*
+	 * Processes everything queued when the call starts, oldest first.
+	 */
+	template <typename F>
+	void process_all(F && func) {
+		auto node = head.exchange(nullptr, std::memory_order_acquire);
+		if (!node) return;
+
+		// The stack is newest-first; reverse it
+		node_t * ordered = nullptr;
+		while (node) {
+			const auto next = node->next;
+			node->next = ordered;
+			ordered = node;
+			node = next;
+		}
+
+		while (ordered) {
+			MESSAGE_TYPE msg = std::move(ordered->msg);
+			const auto next = ordered->next;
+			delete ordered;
+			ordered = next;
+			func(msg);
+		}
+	}
+
+private:
+	struct node_t {
+		MESSAGE_TYPE msg;
+		node_t * next;
+	};
+
+	std::atomic<node_t *> head{ nullptr };
+};
@@ -0,0 +1,103 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace profiler {
+
+	struct entry_t {
+		std::string name;
+		std::array<double, WINDOW> samples{};
+		std::size_t next = 0;		// Where the next sample goes
+		std::size_t filled = 0;		// How many of the samples are real
+		uint64_t calls = 0;
+		double last_ms = 0.0;
+		std::array<uint32_t, HISTOGRAM_BUCKETS> histogram{};
+	};
+
+	static std::vector<entry_t> entries;
+	static std::unordered_map<const char *, std::size_t> by_address;
+	static std::unordered_map<std::string, std::size_t> by_name;
+	static std::mutex profiler_lock;
+
+	static inline std::size_t bucket_of(const double ms) noexcept {
+		auto us = static_cast<uint64_t>(ms * 1000.0);
+		std::size_t bucket = 0;
+		while (us > 0 && bucket < HISTOGRAM_BUCKETS - 1) {
+			us >>= 1;
+			++bucket;
+		}
+		return bucket;
+	}
+
+	static std::size_t entry_index(const char * name) {
+		const auto finder = by_address.find(name);
+		if (finder != by_address.end()) return finder->second;
+
+		// Same text at a different address (another translation unit's copy of the literal)
+		const std::string key(name);
+		auto named = by_name.find(key);
+		if (named == by_name.end()) {
+			named = by_name.emplace(key, entries.size()).first;
+			entries.emplace_back();
+			entries.back().name = key;
+		}
+		by_address[name] = named->second;
+		return named->second;
+	}
+
+	void record(const char * name, const double ms) {
+		std::lock_guard<std::mutex> lock(profiler_lock);
+		auto &entry = entries[entry_index(name)];
+
+		if (entry.filled == WINDOW) {
+			--entry.histogram[bucket_of(entry.samples[entry.next])];
+		}
+		else {
+			++entry.filled;
+		}
+		entry.samples[entry.next] = ms;
+		entry.next = (entry.next + 1) % WINDOW;
+		++entry.histogram[bucket_of(ms)];
+		++entry.calls;
+		entry.last_ms = ms;
+	}
+
+	void get_stats(std::vector<profile_stats_t> &stats) {
+		stats.clear();
+		std::vector<double> sorted;
+
+		std::lock_guard<std::mutex> lock(profiler_lock);
+		for (const auto &entry : entries) {
+			profile_stats_t result;
+			result.name = entry.name;
+			result.calls = entry.calls;
+			result.last_ms = entry.last_ms;
+			result.histogram = entry.histogram;
+
+			if (entry.filled > 0) {
+				sorted.assign(entry.samples.begin(), entry.samples.begin() + entry.filled);
+				std::sort(sorted.begin(), sorted.end());
+				double total = 0.0;
+				for (const auto &s : sorted) total += s;
+				auto rank = [&sorted](const double p) {
+					const auto n = static_cast<std::size_t>(p * static_cast<double>(sorted.size()) + 0.999999);
+					return sorted[std::min(sorted.size(), std::max<std::size_t>(n, 1)) - 1];
+				};
+				result.mean_ms = total / static_cast<double>(sorted.size());
+				result.p50_ms = rank(0.50);
+				result.p95_ms = rank(0.95);
+				result.p99_ms = rank(0.99);
+				result.max_ms = sorted.back();
+			}
+			stats.emplace_back(std::move(result));
+		}
+	}
+
+	void reset() {
+		std::lock_guard<std::mutex> lock(profiler_lock);
+		entries.clear();
+		by_address.clear();
+		by_name.clear();
+	}
+}
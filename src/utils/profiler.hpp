@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Named timers for the expensive parts of a tick: every system, path searches, chunk meshing, saving and loading.
+ * Each name keeps its last WINDOW samples, so percentiles and the histogram describe recent behaviour rather
+ * than the whole session. Recording is thread-safe (path searches run on the worker pool).
+ */
+namespace profiler {
+
+	constexpr std::size_t WINDOW = 256;
+
+	// Bucket 0 counts samples under 1us, bucket n those under 2^n us; the last bucket takes everything slower
+	constexpr std::size_t HISTOGRAM_BUCKETS = 16;
+
+	struct profile_stats_t {
+		std::string name;
+		uint64_t calls = 0;		// Since start-up or the last reset
+		double last_ms = 0.0;
+		double mean_ms = 0.0;	// The rest are over the window
+		double p50_ms = 0.0;
+		double p95_ms = 0.0;
+		double p99_ms = 0.0;
+		double max_ms = 0.0;
+		std::array<uint32_t, HISTOGRAM_BUCKETS> histogram{};
+	};
+
+	/* Adds a sample. Names are expected to be string literals; they're looked up by address first. */
+	void record(const char * name, const double ms);
+
+	/* Every name recorded so far, in the order they first appeared. */
+	void get_stats(std::vector<profile_stats_t> &stats);
+
+	void reset();
+
+	/* Times the enclosing block. */
+	class scope_t {
+	public:
+		explicit scope_t(const char * name) noexcept : name_(name), start_(std::chrono::steady_clock::now()) {}
+		~scope_t() {
+			record(name_, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count());
+		}
+
+		scope_t(const scope_t &) = delete;
+		scope_t &operator=(const scope_t &) = delete;
+
+	private:
+		const char * name_;
+		std::chrono::steady_clock::time_point start_;
+	};
+}
@@ -0,0 +1,97 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+thread_pool_t::thread_pool_t(const std::size_t n_workers) {
+	for (std::size_t i = 0; i < n_workers; ++i) {
+		workers.emplace_back([this]() { worker_loop(); });
+	}
+}
+
+thread_pool_t::~thread_pool_t() {
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		stopping = true;
+	}
+	has_work.notify_all();
+	for (auto &w : workers) {
+		if (w.joinable()) w.join();
+	}
+}
+
+void thread_pool_t::enqueue(std::function<void()> &&task) {
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		tasks.emplace(std::move(task));
+	}
+	has_work.notify_one();
+}
+
+bool thread_pool_t::run_one() {
+	std::function<void()> task;
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		if (tasks.empty()) return false;
+		task = std::move(tasks.front());
+		tasks.pop();
+	}
+	task();
+	return true;
+}
+
+void thread_pool_t::worker_loop() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex);
+			has_work.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (stopping && tasks.empty()) return;
+			task = std::move(tasks.front());
+			tasks.pop();
+		}
+		task();
+	}
+}
+
+void thread_pool_t::parallel_for(const int begin, const int end, const std::function<void(int)> &func) {
+	if (end <= begin) return;
+
+	struct batch_state_t {
+		std::atomic<int> next;
+		std::atomic<int> remaining;
+		std::mutex done_mutex;
+		std::condition_variable done;
+	};
+
+	const int n_batches = static_cast<int>(std::min<std::size_t>(workers.size() + 1, static_cast<std::size_t>(end - begin)));
+	auto state = std::make_shared<batch_state_t>();
+	state->next = begin;
+	state->remaining = n_batches;
+
+	// Each batch pulls indices until the range is exhausted, so uneven rows balance themselves.
+	auto batch = [state, end, &func]() {
+		for (int i = state->next++; i < end; i = state->next++) {
+			func(i);
+		}
+		if (--state->remaining == 0) {
+			std::lock_guard<std::mutex> lock(state->done_mutex);
+			state->done.notify_all();
+		}
+	};
+
+	for (int i = 1; i < n_batches; ++i) {
+		enqueue(batch);
+	}
+	batch();
+
+	// Help with anything still queued, then wait for stragglers.
+	while (state->remaining > 0 && run_one()) {}
+	std::unique_lock<std::mutex> lock(state->done_mutex);
+	state->done.wait(lock, [&state]() { return state->remaining == 0; });
+}
+
+thread_pool_t &worker_pool() {
+	static thread_pool_t pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return pool;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*
+ * A fixed set of worker threads, started on first use. Tasks are plain functions; parallel_for splits a
+ * range into batches and blocks (helping out) until all of them are done.
+ */
+class thread_pool_t {
+public:
+	explicit thread_pool_t(const std::size_t n_workers);
+	~thread_pool_t();
+
+	thread_pool_t(const thread_pool_t &) = delete;
+	thread_pool_t &operator=(const thread_pool_t &) = delete;
+
+	void enqueue(std::function<void()> &&task);
+
+	/* Calls func(i) for each i in [begin, end), spread across the workers and the calling thread. */
+	void parallel_for(const int begin, const int end, const std::function<void(int)> &func);
+
+	std::size_t size() const noexcept { return workers.size(); }
+
+private:
+	bool run_one();
+	void worker_loop();
+
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex queue_mutex;
+	std::condition_variable has_work;
+	bool stopping = false;
+};
+
+/* The shared pool, sized to the hardware (less the calling thread). */
+thread_pool_t &worker_pool();
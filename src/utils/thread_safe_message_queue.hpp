@@ -1,37 +1,46 @@
 #pragma once
 
 #include <mutex>
-#include <queue>
+#include <vector>
+#include <utility>
 
+/*
+ * Mutex-guarded message queue. The lock is only held to add a message or to swap out the pending batch;
+ * handlers run outside of it, so they may enqueue to the same queue (those messages wait for the next call).
+ */
 template <typename MESSAGE_TYPE>
 class thread_safe_message_queue {
 public:
 	void enqueue(MESSAGE_TYPE &&msg) {
 		std::lock_guard<std::mutex> lock(queue_mutex);
-		queue.emplace(msg);
+		queue.emplace_back(std::move(msg));
 	}
 
 	template <typename F>
 	void process_one(F && func) {
-		std::lock_guard<std::mutex> lock(queue_mutex);
-		if (!queue.empty()) {
-			MESSAGE_TYPE msg = queue.front();
-			queue.pop();
-			func(msg);
-		}
+		std::unique_lock<std::mutex> lock(queue_mutex);
+		if (queue.empty()) return;
+		MESSAGE_TYPE msg = std::move(queue.front());
+		queue.erase(queue.begin());
+		lock.unlock();
+		func(msg);
 	}
 
 	template <typename F>
 	void process_all(F && func) {
-		std::lock_guard<std::mutex> lock(queue_mutex);
-		while (!queue.empty()) {
-			MESSAGE_TYPE msg = queue.front();
-			queue.pop();
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			if (queue.empty()) return;
+			std::swap(queue, batch);
+		}
+		for (auto &msg : batch) {
 			func(msg);
 		}
+		batch.clear();
 	}
 
 private:
 	std::mutex queue_mutex;
-	std::queue<MESSAGE_TYPE> queue;
-};
\ No newline at end of file
+	std::vector<MESSAGE_TYPE> queue;
+	std::vector<MESSAGE_TYPE> batch; // Only touched by the (single) consumer
+};